@@ -0,0 +1,499 @@
+//the autopilot, see autopilot.h
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include "autopilot.h"
+#include "profile.h"
+
+//cost of a plan that crashes, far more than any plan that doesn't
+#define APCRASHCOST  100000.0
+//how much a step of thrust costs compared to a step of time, so it doesn't burn fuel for nothing
+#define APFUELCOST   0.2
+//room left round the taxi when working out which cells it fits in
+#define APMARGIN     2.0
+
+int autopilotWorkers(void)
+{
+    //one worker for every processor but the one running the game
+    long n = sysconf(_SC_NPROCESSORS_ONLN) - 1;
+    if(n < 0)
+    {
+        n = 0;
+    }
+    if(n > APMAXWORKERS)
+    {
+        n = APMAXWORKERS;
+    }
+    return (int)n;
+}
+
+int autopilotTarget(const taxi *t, const level *lvl)
+{
+    //works out where the taxi should go next: the waiting customer's pad, their destination,
+    //or out of the top of the level (-1) once the exit customer is up
+    int pad = -1;
+
+    if(lvl->levelCustomerCurrentNumber != lvl->levelCustomerNumber)
+    {
+        if(lvl->customerWaiting == '1')
+        {
+            pad = lvl->currentCustomer.fromPlatform;
+        }
+        else if(t->custo_waiting == '1')
+        {
+            pad = lvl->currentCustomer.destPlatform;
+        }
+    }
+    if(pad >= lvl->numplatforms)
+    {
+        pad = -1;
+    }
+    return pad;
+}
+
+static int taxiFits(const taxi *t, const level *lvl, double x, double y)
+{
+    //if the taxi could be at x, y without touching any line
+    bbox b = {x + t->bb.x1 - APMARGIN, y + t->bb.y1 - APMARGIN, x + t->bb.x2 + APMARGIN, y + t->bb.y2 + APMARGIN};
+    int i;
+    for(i = 0; i < lvl->numplatforms + lvl->numbounds; i++)
+    {
+        if(intersectBBxL(b, levelSegment(lvl, i)))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void heapPush(int *heap, int *size, const float *field, int cell)
+{
+    //min-heap of cells ordered by their distance in the field
+    int i = (*size)++;
+    while(i > 0 && field[heap[(i - 1) / 2]] > field[cell])
+    {
+        heap[i] = heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap[i] = cell;
+}
+static int heapPop(int *heap, int *size, const float *field)
+{
+    int top = heap[0];
+    int last = heap[--(*size)];
+    int i = 0;
+    while(2 * i + 1 < *size)
+    {
+        int c = 2 * i + 1;
+        if(c + 1 < *size && field[heap[c + 1]] < field[heap[c]])
+        {
+            c++;
+        }
+        if(field[last] <= field[heap[c]])
+        {
+            break;
+        }
+        heap[i] = heap[c];
+        i = c;
+    }
+    heap[i] = last;
+    return top;
+}
+
+void buildDistanceField(float *field, const taxi *t, const level *lvl, int target)
+{
+    //works out the distance from every cell to the target pad (or the top of the level, for -1),
+    //going round the level's lines (Dijkstra's algorithm), into field (APFIELDROWS * APFIELDCOLS floats)
+    //the target cells are the row just above the pad, or everywhere above the top of the level
+    static const int dc[8] = {1, -1, 0, 0, 1, 1, -1, -1};
+    static const int dr[8] = {0, 0, 1, -1, 1, -1, 1, -1};
+    char fits[APFIELDROWS * APFIELDCOLS];
+    int heap[APFIELDROWS * APFIELDCOLS * 4];
+    int size = 0, r, c, k;
+    lseg p = lvl->platforms[target >= 0 ? target : 0].l;
+
+    for(r = 0; r < APFIELDROWS; r++)
+    {
+        for(c = 0; c < APFIELDCOLS; c++)
+        {
+            int cell = r * APFIELDCOLS + c;
+            double x = c * APCELL, y = APFIELDBOTTOM + r * APCELL;
+            int goal;
+            fits[cell] = taxiFits(t, lvl, x, y);
+            field[cell] = APFAR;
+            if(target >= 0)
+            {
+                goal = x >= p.x1 && x <= p.x2 && y > p.y1 + 10 && y <= p.y1 + 10 + APCELL;
+            }
+            else
+            {
+                goal = y > 620;
+            }
+            if(fits[cell] && goal)
+            {
+                field[cell] = 0;
+                heapPush(heap, &size, field, cell);
+            }
+        }
+    }
+
+    while(size > 0)
+    {
+        int cell = heapPop(heap, &size, field);
+        r = cell / APFIELDCOLS;
+        c = cell % APFIELDCOLS;
+        for(k = 0; k < 8; k++)
+        {
+            int nr = r + dr[k], nc = c + dc[k];
+            if(nr < 0 || nr >= APFIELDROWS || nc < 0 || nc >= APFIELDCOLS)
+            {
+                continue;
+            }
+            int next = nr * APFIELDCOLS + nc;
+            //diagonal moves only if both cells beside them are free too, so it doesn't cut corners of lines
+            if(!fits[next] || (k >= 4 && (!fits[r * APFIELDCOLS + nc] || !fits[nr * APFIELDCOLS + c])))
+            {
+                continue;
+            }
+            float d = field[cell] + (k >= 4 ? APCELL * 1.41421356f : APCELL);
+            //a cell can go on the heap more than once, only its first (shortest) time out counts
+            if(d < field[next] && size < APFIELDROWS * APFIELDCOLS * 4)
+            {
+                field[next] = d;
+                heapPush(heap, &size, field, next);
+            }
+        }
+    }
+}
+
+double fieldDistance(const float *field, double x, double y)
+{
+    //distance to the target from anywhere, blended from the four cells round the point
+    //cells the taxi can't be in are left out, so the distance doesn't jump up near lines
+    double fc = x / APCELL, fr = (y - APFIELDBOTTOM) / APCELL;
+    double sum = 0, weights = 0;
+    int c0, r0, i;
+
+    fc = fc < 0 ? 0 : (fc > APFIELDCOLS - 1.001 ? APFIELDCOLS - 1.001 : fc);
+    fr = fr < 0 ? 0 : (fr > APFIELDROWS - 1.001 ? APFIELDROWS - 1.001 : fr);
+    c0 = (int)fc;
+    r0 = (int)fr;
+    for(i = 0; i < 4; i++)
+    {
+        int c = c0 + (i & 1), r = r0 + (i >> 1);
+        double w = (i & 1 ? fc - c0 : 1 - (fc - c0)) * (i >> 1 ? fr - r0 : 1 - (fr - r0));
+        float d = field[r * APFIELDCOLS + c];
+        if(d < APFAR)
+        {
+            sum += d * w;
+            weights += w;
+        }
+    }
+    if(weights < 1e-6)
+    {
+        return APFAR;
+    }
+    return sum / weights;
+}
+
+static double distanceCost(const autopilot *ap, const taxi *t)
+{
+    //how far the taxi still has to go, plus a penalty for going fast near the end
+    double dist = fieldDistance(ap->field, t->x, t->y);
+    return dist * 2 + t->velocity * 100 / (dist + 100);
+}
+
+static double tryPlan(const autopilot *ap, const apPlan *plan)
+{
+    //plays a plan out on copies of the taxi and level, and scores it: lower is better
+    //landing on the target (or leaving the level) scores the steps it took, crashing scores APCRASHCOST or more,
+    //and anything else scores more than every landing by how far from the target it ended up
+    taxi t = ap->t;
+    level lvl = ap->lvl;
+    taxiInput in;
+    int s, k, n = 0, thrustSteps = 0;
+    int totalSteps = APSEGMENTS * ap->segmentSteps;
+    char flying = t.inflight;
+    int safeVel = SAFEVELOCITY;
+
+    //no customers in the copy, so landing doesn't pick anyone up or print anything
+    t.custo_waiting = '0';
+    lvl.dispatch = NULL;
+    lvl.customerWaiting = '0';
+    lvl.currentCustomer.fromPlatform = -1;
+    lvl.currentCustomer.destPlatform = -1;
+
+    for(s = 0; s < APSEGMENTS; s++)
+    {
+        in.vThrust = plan->c[s].vThrust;
+        in.hThrust = plan->c[s].hThrust;
+        in.toggleWheels = (plan->c[s].wheels == 1) != (t.wheelLandersEnabled == '1');
+        for(k = 0; k < ap->segmentSteps; k++, n++)
+        {
+            stepGame(&t, &lvl, &in, ap->stepMs);
+            in.toggleWheels = 0;
+            thrustSteps += (t.vThrust != 0) + (t.hThrust != 0);
+
+            //sat on a pad so long that gravity has built up too much speed to take off again without crashing
+            //(the game keeps adding gravity while landed), which is as bad as crashing
+            if(t.bintact == '0' || (t.inflight == '0' && t.velocity > safeVel))
+            {
+                //crashing sooner is worse, so it still tries to put off a crash it can't avoid
+                return APCRASHCOST + (totalSteps - n) * 100.0;
+            }
+            if(ap->target < 0 && t.nextLevel == '1')
+            {
+                return n + thrustSteps * APFUELCOST;
+            }
+            if(flying == '1' && t.inflight == '0')
+            {
+                //just landed, on the target pad?
+                lseg p = lvl.platforms[ap->target >= 0 ? ap->target : 0].l;
+                if(ap->target >= 0 && t.x > p.x1 - 26 && t.x < p.x2 + 25 && fabs(t.y - (p.y1 + 10)) < 2)
+                {
+                    return n + thrustSteps * APFUELCOST;
+                }
+                //landed somewhere else, stuck there for the rest of the plan
+                return totalSteps + distanceCost(ap, &t) + 1000.0;
+            }
+            flying = t.inflight;
+        }
+    }
+    return totalSteps + distanceCost(ap, &t) + thrustSteps * APFUELCOST;
+}
+
+static void tryCandidates(autopilot *ap)
+{
+    //takes candidates one at a time until they've all been tried, run by the workers and the planning thread together
+    int i;
+    while((i = atomic_fetch_add(&ap->nextCandidate, 1)) < APCANDIDATES)
+    {
+        ap->cost[i] = tryPlan(ap, &ap->candidates[i]);
+    }
+}
+
+static void *autopilotWorker(void *data)
+{
+    autopilot *ap = data;
+    int seen = 0;
+
+    profileMuteThread(1);
+    pthread_mutex_lock(&ap->lock);
+    while(1)
+    {
+        while(ap->generation == seen && ap->stop == 0)
+        {
+            pthread_cond_wait(&ap->start, &ap->lock);
+        }
+        if(ap->stop)
+        {
+            break;
+        }
+        seen = ap->generation;
+        pthread_mutex_unlock(&ap->lock);
+
+        tryCandidates(ap);
+
+        pthread_mutex_lock(&ap->lock);
+        ap->working--;
+        if(ap->working == 0)
+        {
+            pthread_cond_signal(&ap->done);
+        }
+    }
+    pthread_mutex_unlock(&ap->lock);
+    return NULL;
+}
+
+int startAutopilot(autopilot *ap, int workers, double stepMs, unsigned int seed)
+{
+    //sets up the autopilot and starts its worker threads (0 workers plans on the calling thread only)
+    //returns 0 if the threads couldn't be started
+    int i;
+
+    memset(ap, 0, sizeof(*ap));
+    ap->stepMs = stepMs;
+    ap->segmentSteps = (int)(APSEGMENTMS / stepMs + 0.5);
+    if(ap->segmentSteps < 1)
+    {
+        ap->segmentSteps = 1;
+    }
+    pcgSeed(&ap->rng, seed, 16);
+    ap->fieldLevel = -1;
+    pthread_mutex_init(&ap->lock, NULL);
+    pthread_cond_init(&ap->start, NULL);
+    pthread_cond_init(&ap->done, NULL);
+
+    if(workers > APMAXWORKERS)
+    {
+        workers = APMAXWORKERS;
+    }
+    for(i = 0; i < workers; i++)
+    {
+        if(pthread_create(&ap->workers[i], NULL, autopilotWorker, ap) != 0)
+        {
+            stopAutopilot(ap);
+            return 0;
+        }
+        ap->numWorkers++;
+    }
+    return 1;
+}
+void stopAutopilot(autopilot *ap)
+{
+    //tells the workers to finish and waits for them
+    int i;
+    pthread_mutex_lock(&ap->lock);
+    ap->stop = 1;
+    pthread_cond_broadcast(&ap->start);
+    pthread_mutex_unlock(&ap->lock);
+    for(i = 0; i < ap->numWorkers; i++)
+    {
+        pthread_join(ap->workers[i], NULL);
+    }
+    ap->numWorkers = 0;
+    pthread_mutex_destroy(&ap->lock);
+    pthread_cond_destroy(&ap->start);
+    pthread_cond_destroy(&ap->done);
+}
+
+static apControl randomControl(autopilot *ap)
+{
+    apControl c;
+    c.vThrust = pcgBelow(&ap->rng, 2);
+    c.hThrust = (signed char)pcgBelow(&ap->rng, 3) - 1;
+    c.wheels = pcgBelow(&ap->rng, 2);
+    return c;
+}
+static void makeCandidates(autopilot *ap)
+{
+    //the plan so far moved on a piece, half the candidates changed a bit from it, the rest made from scratch
+    apPlan shifted;
+    int i, s;
+
+    for(s = 0; s < APSEGMENTS - 1; s++)
+    {
+        shifted.c[s] = ap->best.c[s + 1];
+    }
+    shifted.c[APSEGMENTS - 1] = ap->best.c[APSEGMENTS - 1];
+    ap->candidates[0] = shifted;
+
+    for(i = 1; i < APCANDIDATES / 2; i++)
+    {
+        apPlan *p = &ap->candidates[i];
+        int from = pcgBelow(&ap->rng, 2) ? (int)pcgBelow(&ap->rng, APSEGMENTS) : APSEGMENTS;
+        *p = shifted;
+        for(s = 0; s < APSEGMENTS; s++)
+        {
+            if(s >= from)
+            {
+                //a new ending
+                p->c[s] = randomControl(ap);
+            }
+            else if(pcgBelow(&ap->rng, 4) == 0)
+            {
+                //one control changed
+                apControl r = randomControl(ap);
+                switch(pcgBelow(&ap->rng, 3))
+                {
+                    case 0: p->c[s].vThrust = r.vThrust; break;
+                    case 1: p->c[s].hThrust = r.hThrust; break;
+                    case 2: p->c[s].wheels = r.wheels; break;
+                }
+            }
+        }
+    }
+    for(; i < APCANDIDATES; i++)
+    {
+        //controls held for a few pieces at a time, which is how a person flies
+        apPlan *p = &ap->candidates[i];
+        s = 0;
+        while(s < APSEGMENTS)
+        {
+            apControl c = randomControl(ap);
+            int run = 1 + pcgBelow(&ap->rng, 6);
+            for(; run > 0 && s < APSEGMENTS; run--, s++)
+            {
+                p->c[s] = c;
+            }
+        }
+    }
+}
+
+static void plan(autopilot *ap, const taxi *t, const level *lvl)
+{
+    //tries all the candidates across the workers, and keeps the best as the plan to fly
+    long long start = profileNow();
+    long long stageTimer = profileStart();
+    int i, best = 0;
+
+    ap->t = *t;
+    ap->lvl = *lvl;
+    ap->target = autopilotTarget(t, lvl);
+    if(ap->target != ap->fieldTarget || lvl->bounds != ap->fieldBounds || t->levelCurrent != ap->fieldLevel)
+    {
+        buildDistanceField(ap->field, t, lvl, ap->target);
+        ap->fieldTarget = ap->target;
+        ap->fieldBounds = lvl->bounds;
+        ap->fieldLevel = t->levelCurrent;
+    }
+    makeCandidates(ap);
+    atomic_store(&ap->nextCandidate, 0);
+
+    pthread_mutex_lock(&ap->lock);
+    ap->generation++;
+    ap->working = ap->numWorkers;
+    pthread_cond_broadcast(&ap->start);
+    pthread_mutex_unlock(&ap->lock);
+
+    //the calling thread helps too, without recording every practice step in the profile
+    int wasMuted = profileMuted;
+    profileMuteThread(1);
+    tryCandidates(ap);
+    profileMuteThread(wasMuted);
+
+    pthread_mutex_lock(&ap->lock);
+    while(ap->working > 0)
+    {
+        pthread_cond_wait(&ap->done, &ap->lock);
+    }
+    pthread_mutex_unlock(&ap->lock);
+
+    //lowest cost wins, the earliest candidate if there's a tie, so the choice never depends on thread timing
+    for(i = 1; i < APCANDIDATES; i++)
+    {
+        if(ap->cost[i] < ap->cost[best])
+        {
+            best = i;
+        }
+    }
+    ap->best = ap->candidates[best];
+
+    double ms = (profileNow() - start) / 1e6;
+    ap->plans++;
+    ap->planMs += ms;
+    if(ms > ap->maxPlanMs)
+    {
+        ap->maxPlanMs = ms;
+    }
+    profileEnd(STAGEAUTOPILOT, stageTimer);
+}
+
+void autopilotInput(autopilot *ap, const taxi *t, const level *lvl, taxiInput *in)
+{
+    //fills in the controls for the next step, planning again at the start of every piece of the plan
+    if(ap->stepInSegment == 0)
+    {
+        plan(ap, t, lvl);
+    }
+    in->vThrust = ap->best.c[0].vThrust;
+    in->hThrust = ap->best.c[0].hThrust;
+    in->toggleWheels = (ap->best.c[0].wheels == 1) != (t->wheelLandersEnabled == '1');
+    ap->stepInSegment++;
+    if(ap->stepInSegment >= ap->segmentSteps)
+    {
+        ap->stepInSegment = 0;
+    }
+}
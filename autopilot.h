@@ -0,0 +1,93 @@
+#ifndef AUTOPILOT_H
+#define AUTOPILOT_H
+//a computer pilot that flies the taxi to the current customer, their destination, or out of the level
+//it plans by trying lots of thrust schedules on copies of the game (sampling model predictive control):
+//every few steps it makes a few hundred variations of its current plan, plays each one ahead with stepGame()
+//on worker threads, and keeps the one that lands soonest without crashing
+//plans that don't get there are scored by how far the taxi would still have to fly, round the level's lines,
+//which comes from a distance map worked out once each time the target changes
+//doesn't need SDL or OpenGL, so it also drives the soak tests in spacetaxi_headless
+#include <pthread.h>
+#include <stdatomic.h>
+#include "spacetaxi.h"
+
+//a plan is this many pieces, each holding the same controls for APSEGMENTMS milliseconds (so it looks 1.2 s ahead)
+#define APSEGMENTS    24
+#define APSEGMENTMS   50.0
+//plans tried every time it plans again
+#define APCANDIDATES  256
+//most worker threads it will start
+#define APMAXWORKERS  16
+
+typedef struct
+{
+    //the controls held for one piece of a plan
+    signed char vThrust; //0 or 1
+    signed char hThrust; //-1, 0 or 1
+    signed char wheels;  //landing wheels down (1) or up (0)
+}apControl;
+
+typedef struct
+{
+    apControl c[APSEGMENTS];
+}apPlan;
+
+//the distance map covers the level in cells this many pixels across, from APFIELDBOTTOM up to above the top of the screen
+#define APCELL        10.0
+#define APFIELDCOLS   81
+#define APFIELDROWS   62
+#define APFIELDBOTTOM 90.0
+
+typedef struct
+{
+    //settings
+    double stepMs;    //the game's physics step
+    int segmentSteps; //physics steps in each piece of a plan
+    int numWorkers;   //threads helping to try plans, as well as the one calling autopilotInput()
+
+    //the worker threads, woken once per plan to share out the candidates between them
+    pthread_t workers[APMAXWORKERS];
+    pthread_mutex_t lock;
+    pthread_cond_t start;   //signalled when there are candidates to try
+    pthread_cond_t done;    //signalled when the last worker has finished
+    int generation;         //goes up once per plan, so workers know there's new work
+    int working;            //workers that haven't finished this plan yet
+    int stop;               //(1) tells the workers to exit
+    atomic_int nextCandidate;
+
+    //what's being planned: copies of the game to play plans out on, and the plans to try
+    taxi t;
+    level lvl;
+    int target;  //the platform to land on, or -1 to leave through the top of the level
+    //distances in pixels from the middle of each cell to the target, going round anything the taxi would hit
+    //(a cell the taxi can't be in is APFAR)
+    float field[APFIELDROWS * APFIELDCOLS];
+    int fieldTarget;          //what the field was worked out for, so it's only done again when that changes
+    const lseg *fieldBounds;
+    int fieldLevel;
+    apPlan candidates[APCANDIDATES];
+    double cost[APCANDIDATES];
+
+    //the plan being flown, and how far into its first piece the taxi is
+    apPlan best;
+    int stepInSegment;
+    pcg32 rng; //for making the candidates, only used by the planning thread so plans are the same every run
+
+    //how long planning takes, for checking it keeps up with the game
+    int plans;
+    double planMs;    //total
+    double maxPlanMs;
+}autopilot;
+
+int startAutopilot(autopilot *ap, int workers, double stepMs, unsigned int seed);
+void stopAutopilot(autopilot *ap);
+int autopilotTarget(const taxi *t, const level *lvl);
+void autopilotInput(autopilot *ap, const taxi *t, const level *lvl, taxiInput *in);
+int autopilotWorkers(void);
+//the distance map on its own, also used by the fleet's pilots (fleet.h)
+//APFAR is the distance for a cell the taxi can't be in, or can't get to the target from
+#define APFAR         1e9f
+void buildDistanceField(float *field, const taxi *t, const level *lvl, int target);
+double fieldDistance(const float *field, double x, double y);
+
+#endif
@@ -0,0 +1,376 @@
+//stepping lots of independent taxis at once
+//batchStep() does the same movement and swept crash/landing checks as doEvents(), but for a whole batch of taxis,
+//using SSE2 (2 taxis per instruction) or AVX2 (4 taxis per instruction) when the compiler has them turned on
+#include <stdlib.h>
+#include <math.h>
+#include "batch.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define LANES 4
+typedef __m256d vdouble;
+#define vset1(a)          _mm256_set1_pd(a)
+#define vload(p)          _mm256_load_pd(p)
+#define vstore(p, a)      _mm256_store_pd(p, a)
+#define vadd(a, b)        _mm256_add_pd(a, b)
+#define vsub(a, b)        _mm256_sub_pd(a, b)
+#define vmul(a, b)        _mm256_mul_pd(a, b)
+#define vdiv(a, b)        _mm256_div_pd(a, b)
+#define vcmpge(a, b)      _mm256_cmp_pd(a, b, _CMP_GE_OQ)
+#define vcmple(a, b)      _mm256_cmp_pd(a, b, _CMP_LE_OQ)
+#define vcmpgt(a, b)      _mm256_cmp_pd(a, b, _CMP_GT_OQ)
+#define vand(a, b)        _mm256_and_pd(a, b)
+#define vor(a, b)         _mm256_or_pd(a, b)
+#define vandnot(a, b)     _mm256_andnot_pd(a, b)
+#define vblend(a, b, m)   _mm256_blendv_pd(a, b, m)
+#define vmask(a)          _mm256_movemask_pd(a)
+#define vmin(a, b)        _mm256_min_pd(a, b)
+#define vmax(a, b)        _mm256_max_pd(a, b)
+#define vcmpeq(a, b)      _mm256_cmp_pd(a, b, _CMP_EQ_OQ)
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define LANES 2
+typedef __m128d vdouble;
+#define vset1(a)          _mm_set1_pd(a)
+#define vload(p)          _mm_load_pd(p)
+#define vstore(p, a)      _mm_store_pd(p, a)
+#define vadd(a, b)        _mm_add_pd(a, b)
+#define vsub(a, b)        _mm_sub_pd(a, b)
+#define vmul(a, b)        _mm_mul_pd(a, b)
+#define vdiv(a, b)        _mm_div_pd(a, b)
+#define vcmpge(a, b)      _mm_cmpge_pd(a, b)
+#define vcmple(a, b)      _mm_cmple_pd(a, b)
+#define vcmpgt(a, b)      _mm_cmpgt_pd(a, b)
+#define vand(a, b)        _mm_and_pd(a, b)
+#define vor(a, b)         _mm_or_pd(a, b)
+#define vandnot(a, b)     _mm_andnot_pd(a, b)
+#define vblend(a, b, m)   _mm_or_pd(_mm_and_pd(m, b), _mm_andnot_pd(m, a)) /* no blendv before SSE4.1 */
+#define vmask(a)          _mm_movemask_pd(a)
+#define vmin(a, b)        _mm_min_pd(a, b)
+#define vmax(a, b)        _mm_max_pd(a, b)
+#define vcmpeq(a, b)      _mm_cmpeq_pd(a, b)
+#else
+#define LANES 1
+#endif
+
+//the lane arrays, in the order they are allocated
+#define NUMARRAYS 12
+
+int batchCreate(taxiBatch *b, int count)
+{
+    //allocates a batch of count taxis, all starting like a freshly initialised taxi at (400, 400)
+    //returns 1 if it worked, 0 if out of memory
+    int i;
+    taxi t;
+    double **arrays[NUMARRAYS] = {&b->x, &b->y, &b->vSpeed, &b->hSpeed, &b->vThrust, &b->hThrust, &b->fuel,
+                                  &b->intact, &b->inflight, &b->wheels, &b->exited, &b->pad};
+
+    b->count = count;
+    b->capacity = (count + LANES - 1) / LANES * LANES;
+    if(b->capacity == 0)
+    {
+        b->capacity = LANES;
+    }
+
+    //one block for everything, each array on its own 32 byte boundary for the aligned SIMD loads
+    size_t stride = ((size_t)b->capacity * sizeof(double) + 31) / 32 * 32;
+    double *block = aligned_alloc(32, stride * NUMARRAYS);
+    if(block == NULL)
+    {
+        return 0;
+    }
+    for(i = 0; i < NUMARRAYS; i++)
+    {
+        *arrays[i] = (double *)((char *)block + stride * i);
+    }
+
+    b->gravity = GRAVITY;
+    b->verticalStr = VERTICALSTR;
+    b->horizontStr = HORIZONTSTR;
+    b->safeVelocity = SAFEVELOCITY;
+
+    initialiseTaxi(&t, 400, 400, 3);
+    for(i = 0; i < b->capacity; i++)
+    {
+        batchLoadTaxi(b, i, &t);
+        if(i >= count)
+        {
+            //spare lanes are crashed taxis, so they never move or collide
+            b->intact[i] = 0.0;
+            b->inflight[i] = 0.0;
+        }
+    }
+    return 1;
+}
+void batchFree(taxiBatch *b)
+{
+    //frees the arrays, which were all allocated as one block starting at x
+    free(b->x);
+    b->x = NULL;
+    b->count = 0;
+    b->capacity = 0;
+}
+void batchLoadTaxi(taxiBatch *b, int i, const taxi *t)
+{
+    //copies the movement state of a taxi into lane i of the batch
+    b->x[i] = t->x;
+    b->y[i] = t->y;
+    b->vSpeed[i] = t->vSpeed;
+    b->hSpeed[i] = t->hSpeed;
+    b->vThrust[i] = t->vThrust;
+    b->hThrust[i] = t->hThrust;
+    b->fuel[i] = t->fuel;
+    b->intact[i] = (t->bintact == '1') ? 1.0 : 0.0;
+    b->inflight[i] = (t->inflight == '1') ? 1.0 : 0.0;
+    b->wheels[i] = (t->wheelLandersEnabled == '1') ? 1.0 : 0.0;
+    b->exited[i] = (t->nextLevel == '1') ? 1.0 : 0.0;
+    b->pad[i] = -1.0;
+}
+void batchStoreTaxi(const taxiBatch *b, int i, taxi *t)
+{
+    //copies lane i of the batch back into a taxi, leaving its money, customers and lives alone
+    t->x = b->x[i];
+    t->y = b->y[i];
+    t->vSpeed = b->vSpeed[i];
+    t->hSpeed = b->hSpeed[i];
+    t->vThrust = b->vThrust[i];
+    t->hThrust = b->hThrust[i];
+    t->fuel = b->fuel[i];
+    t->velocity = sqrt((t->vSpeed * t->vSpeed) + (t->hSpeed * t->hSpeed));
+    t->bintact = (b->intact[i] != 0.0) ? '1' : '0';
+    t->inflight = (b->inflight[i] != 0.0) ? '1' : '0';
+    t->wheelLandersEnabled = (b->wheels[i] != 0.0) ? '1' : '0';
+    t->nextLevel = (b->exited[i] != 0.0) ? '1' : '0';
+    if(t->bintact == '0')
+    {
+        t->justDied = '1';
+    }
+}
+void batchApplyInput(taxiBatch *b, int i, const taxiInput *in)
+{
+    //the same as applyInput(), for lane i
+    if(in->toggleWheels == 1)
+    {
+        if(b->wheels[i] != 0.0)
+        {
+            b->wheels[i] = 0.0;
+            b->inflight[i] = 1.0;
+        }
+        else
+        {
+            b->wheels[i] = 1.0;
+        }
+    }
+    if(in->vThrust > 0 && b->vThrust[i] <= 0)
+    {
+        b->inflight[i] = 1.0;
+    }
+    b->vThrust[i] = in->vThrust;
+    if(in->hThrust == 0 || b->wheels[i] == 0.0)
+    {
+        b->hThrust[i] = in->hThrust;
+    }
+}
+
+static void landOrCrash(taxiBatch *b, int i, lseg l)
+{
+    //what doEvents() does when a taxi touches a landing pad, for lane i
+    int velocity = sqrt((b->vSpeed[i] * b->vSpeed[i]) + (b->hSpeed[i] * b->hSpeed[i]));
+    int safeVel = b->safeVelocity;
+
+    if(b->wheels[i] != 0.0 && velocity <= safeVel)
+    {
+        b->inflight[i] = 0.0;
+        b->vSpeed[i] = 10.0;
+        b->hThrust[i] = 0;
+        b->hSpeed[i] = 0;
+        int y;
+        y = l.y1 + (l.y2 - l.y1)*(b->x[i]-l.x1/l.x2 - l.x1) + 10;
+        b->y[i] = y;
+    }
+    else
+    {
+        b->inflight[i] = 0.0;
+        b->intact[i] = 0.0;
+    }
+}
+
+static void sweepLane(taxiBatch *b, int i, const level *lvl, double frames)
+{
+    //moves lane i and lands or crashes it on the first thing in its way, the same as doEvents()
+    //the speeds must already be updated for this step, with x and y still where the taxi started
+    int j;
+    int n = lvl->numplatforms + lvl->numbounds;
+    taxi t;
+    initialiseTaxi(&t, b->x[i], b->y[i], 0);
+    bbox bb = getBBox(&t);
+    double dx = 0, dy = 0;
+    if(b->inflight[i] != 0.0)
+    {
+        dx = frames*b->hSpeed[i];
+        dy = frames*b->vSpeed[i];
+    }
+
+    double first = 2.0;
+    for(j = 0; j < n; j++)
+    {
+        double toi = sweepBBxL(bb, dx, dy, levelSegment(lvl, j));
+        if(toi >= 0 && toi < first)
+        {
+            first = toi;
+        }
+    }
+    if(first > 1.0)
+    {
+        b->y[i] += dy;
+        b->x[i] += dx;
+        return;
+    }
+    b->y[i] += dy*first;
+    b->x[i] += dx*first;
+    for(j = 0; j < n; j++)
+    {
+        double toi = sweepBBxL(bb, dx, dy, levelSegment(lvl, j));
+        if(toi < 0 || toi > first + 1e-9)
+        {
+            continue;
+        }
+        if(j < lvl->numplatforms)
+        {
+            landOrCrash(b, i, lvl->platforms[j].l);
+            b->pad[i] = j;
+        }
+        else
+        {
+            b->intact[i] = 0.0;
+            b->inflight[i] = 0.0;
+        }
+    }
+}
+
+#if LANES > 1
+static inline void vsweepAxis(vdouble bMin, vdouble bMax, vdouble sMin, vdouble sMax, vdouble p, vdouble *enter, vdouble *exit)
+{
+    //sweepAxis() from simulation.c for every lane, lanes that never overlap end up with enter after exit
+    vdouble zero = vset1(0.0), big = vset1(1e300), minusBig = vset1(-1e300);
+    vdouble lo = vsub(sMin, bMax), hi = vsub(sMax, bMin);
+    vdouble still = vcmpeq(p, zero);
+    vdouble ps = vblend(p, vset1(1.0), still); //no dividing by zero for lanes not moving along this axis
+    vdouble t1 = vdiv(lo, ps), t2 = vdiv(hi, ps);
+    vdouble overlap = vand(vcmple(lo, zero), vcmpge(hi, zero));
+    vdouble tMin = vblend(vmin(t1, t2), vblend(big, minusBig, overlap), still);
+    vdouble tMax = vblend(vmax(t1, t2), vblend(minusBig, big, overlap), still);
+    *enter = vmax(*enter, tMin);
+    *exit = vmin(*exit, tMax);
+}
+static inline vdouble vsweepBBxL(vdouble bx1, vdouble by1, vdouble bx2, vdouble by2, vdouble dx, vdouble dy, lseg Line)
+{
+    //sweepBBxL() for each lane's moving bounding box against the same line, giving a mask of the lanes that touch it
+    //the test is a little generous, sweepLane() makes the exact call for the lanes it picks out
+    vdouble enter = vset1(0.0), exit = vset1(1.0 + 1e-7);
+    vdouble nx = vset1(Line.y1 - Line.y2), ny = vset1(Line.x2 - Line.x1);
+    vdouble signBit = vset1(-0.0);
+    vdouble halfW = vmul(vsub(bx2, bx1), vset1(0.5)), halfH = vmul(vsub(by2, by1), vset1(0.5));
+    vdouble centre = vadd(vmul(vadd(bx1, halfW), nx), vmul(vadd(by1, halfH), ny));
+    vdouble reach = vadd(vmul(vandnot(signBit, nx), halfW), vmul(vandnot(signBit, ny), halfH));
+    vdouble s = vset1(Line.x1 * (Line.y1 - Line.y2) + Line.y1 * (Line.x2 - Line.x1));
+
+    vsweepAxis(bx1, bx2, vset1(fmin(Line.x1, Line.x2)), vset1(fmax(Line.x1, Line.x2)), dx, &enter, &exit);
+    vsweepAxis(by1, by2, vset1(fmin(Line.y1, Line.y2)), vset1(fmax(Line.y1, Line.y2)), dy, &enter, &exit);
+    vsweepAxis(vsub(centre, reach), vadd(centre, reach), s, s, vadd(vmul(dx, nx), vmul(dy, ny)), &enter, &exit);
+    return vcmple(enter, vadd(exit, vset1(1e-7)));
+}
+
+void batchStep(taxiBatch *b, const level *lvl, double frames)
+{
+    //moves every taxi in the batch on by the given number of frames, then checks them against the level
+    int i, j, k;
+    int n = lvl->numplatforms + lvl->numbounds;
+    vdouble f = vset1(frames);
+    vdouble g = vset1(b->gravity), v = vset1(b->verticalStr), h = vset1(b->horizontStr);
+    vdouble half = vset1(0.5), exitHeight = vset1(lvl->extent.y2);
+    taxi t;
+    initialiseTaxi(&t, 0, 0, 0);
+    vdouble bbx1 = vset1(t.bb.x1), bby1 = vset1(t.bb.y1), bbx2 = vset1(t.bb.x2), bby2 = vset1(t.bb.y2);
+
+    for(i = 0; i < b->capacity; i += LANES)
+    {
+        vdouble intact = vcmpgt(vload(b->intact + i), half);
+        if(vmask(intact) == 0)
+        {
+            continue;
+        }
+        vdouble x = vload(b->x + i), y = vload(b->y + i);
+        vdouble moving = vand(intact, vcmpgt(vload(b->inflight + i), half));
+
+        //bounding boxes are taken before moving, like getBBox() at the start of doEvents(), then swept along the move
+        vdouble bx1 = vadd(bbx1, x), by1 = vadd(bby1, y), bx2 = vadd(bbx2, x), by2 = vadd(bby2, y);
+
+        //movement calculations
+        vdouble vs = vload(b->vSpeed + i), hs = vload(b->hSpeed + i);
+        vdouble newVs = vsub(vs, vmul(f, g));
+        newVs = vadd(newVs, vmul(vmul(f, vload(b->vThrust + i)), v));
+        vdouble newHs = vadd(hs, vmul(vmul(f, vload(b->hThrust + i)), h));
+        vs = vblend(vs, newVs, intact);
+        hs = vblend(hs, newHs, intact);
+        vstore(b->vSpeed + i, vs);
+        vstore(b->hSpeed + i, hs);
+
+        //how far each taxi moves, only if not on a platform
+        vdouble dx = vand(moving, vmul(f, hs)), dy = vand(moving, vmul(f, vs));
+
+        //taxis whose move touches any landing pad or boundary line
+        vdouble hit = vset1(0.0);
+        for(j = 0; j < n; j++)
+        {
+            hit = vor(hit, vsweepBBxL(bx1, by1, bx2, by2, dx, dy, levelSegment(lvl, j)));
+        }
+        hit = vand(hit, intact);
+
+        //the rest move the whole way...
+        vdouble clear = vandnot(hit, moving);
+        vstore(b->y + i, vblend(y, vadd(y, dy), clear));
+        vstore(b->x + i, vblend(x, vadd(x, dx), clear));
+        //...and the rare hits are handled one taxi at a time
+        int hits = vmask(hit);
+        for(k = 0; hits != 0; k++, hits >>= 1)
+        {
+            if(hits & 1)
+            {
+                sweepLane(b, i + k, lvl, frames);
+            }
+        }
+        //exit level above
+        vdouble exits = vand(intact, vcmpgt(by1, exitHeight));
+        vstore(b->exited + i, vblend(vload(b->exited + i), vset1(1.0), exits));
+    }
+}
+#else
+void batchStep(taxiBatch *b, const level *lvl, double frames)
+{
+    //plain C version for compilers without SSE2, one taxi at a time through the same maths as doEvents()
+    int i;
+    taxi t;
+    initialiseTaxi(&t, 0, 0, 0);
+
+    for(i = 0; i < b->count; i++)
+    {
+        if(b->intact[i] == 0.0)
+        {
+            continue;
+        }
+        t.x = b->x[i];
+        t.y = b->y[i];
+        bbox bb = getBBox(&t);
+
+        b->vSpeed[i] -= frames*b->gravity;
+        b->vSpeed[i] += frames*b->vThrust[i]*b->verticalStr;
+        b->hSpeed[i] += frames*b->hThrust[i]*b->horizontStr;
+        sweepLane(b, i, lvl, frames);
+        if(bb.y1 > lvl->extent.y2)
+        {
+            b->exited[i] = 1.0;
+        }
+    }
+}
+#endif
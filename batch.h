@@ -0,0 +1,42 @@
+#ifndef BATCH_H
+#define BATCH_H
+//stepping lots of independent taxis at once, for parameter sweeps and other batch jobs
+//the taxis are stored struct-of-arrays, so the physics and collision tests can work on several taxis per instruction
+#include "spacetaxi.h"
+
+typedef struct
+{
+    int count;    //number of taxis in the batch
+    int capacity; //length of every array, count rounded up to a whole number of SIMD lanes (the spare lanes are crashed taxis)
+
+    //one entry per taxi, the same meaning as in the taxi struct
+    double *x;
+    double *y;
+    double *vSpeed;
+    double *hSpeed;
+    double *vThrust;
+    double *hThrust;
+    double *fuel;
+
+    //flags are 1.0 or 0.0 rather than chars, so they can be turned straight into SIMD lane masks
+    double *intact;   //taxi whole (1) or crashed (0)
+    double *inflight; //taxi flying (1) or landed/crashed (0)
+    double *wheels;   //landing wheels down (1) or up (0)
+    double *exited;   //taxi has left through the top of the level (1) or not (0)
+    double *pad;      //the pad the taxi last landed on, -1 if none
+
+    //physics constants shared by the whole batch, so a sweep can run one batch per setting
+    double gravity;
+    double verticalStr;
+    double horizontStr;
+    double safeVelocity;
+}taxiBatch;
+
+int batchCreate(taxiBatch *b, int count);
+void batchFree(taxiBatch *b);
+void batchLoadTaxi(taxiBatch *b, int i, const taxi *t);
+void batchStoreTaxi(const taxiBatch *b, int i, taxi *t);
+void batchApplyInput(taxiBatch *b, int i, const taxiInput *in);
+void batchStep(taxiBatch *b, const level *lvl, double frames);
+
+#endif
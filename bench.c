@@ -0,0 +1,726 @@
+//micro-benchmarks for the game's hot paths: the collision tests, a doEvents() step on every level and in a cavern,
+//making a cavern's chunks, a cavern's customers turning up and being picked up, saving and rewinding the game, a step of a fleet and of the learning environment,
+//drawing a whole frame with render() (in a level and a cavern, and with the software backend), laying out the font, and moving and drawing the rain
+//usage: $ ./spacetaxi_bench [--json] [--samples N] [--filter name] [--levels pack]
+//each benchmark is timed as many samples of a batch of operations, and reports the median and 99th percentile ns per operation
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "spacetaxi.h"
+#include "scene.h"
+#include "glrender.h"
+#include "softrender.h"
+#include "levelpack.h"
+#include "rain.h"
+#include "cavern.h"
+#include "rlenv.h"
+#include "gamestate.h"
+#include "fleet.h"
+#include "dispatch.h"
+#include "capture.h"
+
+//number of timed samples per benchmark, unless changed with --samples
+#define BENCHSAMPLES 101
+//how long each sample should take, in nanoseconds, the operations per sample are picked to fit
+#define SAMPLENS     2000000.0
+//drops in the rain benchmark, a heavy storm
+#define BENCHRAINDROPS 20000
+//number of different inputs each benchmark cycles through (a power of two)
+#define NUMINPUTS    1024
+
+typedef struct
+{
+    //the results of one benchmark
+    char name[64];
+    double median; //ns per operation
+    double p99;
+    double min;
+    long long opsPerSample;
+    int samples;
+}benchResult;
+
+//runs ops operations of a benchmark on its data
+typedef void (*benchFunction)(void *data, long long ops);
+
+typedef struct
+{
+    //random inputs for the collision tests
+    lseg lines[NUMINPUTS];
+    bbox boxes[NUMINPUTS];
+    double dx[NUMINPUTS];
+    double dy[NUMINPUTS];
+}collisionInputs;
+
+typedef struct
+{
+    //a level and taxis spread around it, for timing doEvents()
+    level *lvl;
+    taxi taxis[NUMINPUTS];
+    double frames;
+}stepInputs;
+
+typedef struct
+{
+    //a cavern, and its level, for timing streaming and its customers
+    cavern c;
+    level lvl;
+}cavernInputs;
+
+//customers kept waiting in the dispatch benchmark
+#define DISPATCHBENCHWAITING 2048
+
+//environments stepped together in the rlStep() benchmark
+#define RLBENCHENVS 64
+
+typedef struct
+{
+    //environments for timing rlStep(), random actions for them, and somewhere for what they see
+    rlEnv *env;
+    int actions[RLBENCHENVS * 64];
+    float obs[RLBENCHENVS * RLOBSSIZE];
+    float rewards[RLBENCHENVS];
+    unsigned char dones[RLBENCHENVS];
+}rlInputs;
+
+typedef struct
+{
+    //a game and the ring of states practice mode keeps, for timing saving and rewinding
+    taxi t;
+    level *lvl;
+    stateRing ring;
+}stateInputs;
+
+//taxis in the stepFleet() benchmark, a power of two so the operations it's timed over are always whole steps
+#define FLEETBENCHTAXIS 512
+
+typedef struct
+{
+    //a fleet flying round the player's taxi, for timing stepFleet()
+    fleet f;
+    taxi t;
+    level *lvl;
+}fleetInputs;
+
+typedef struct
+{
+    //what render() needs
+    renderer *rend;
+    taxi *t;
+    level *lvl;
+}renderInputs;
+
+typedef struct
+{
+    //a frame drawn and recorded to video
+    renderInputs in;
+    videoCapture *vc;
+}captureInputs;
+
+//results are added to this so the compiler can't leave out the work being timed
+static volatile long long sink;
+
+static double randomBetween(double low, double high)
+{
+    return low + (high - low) * (rand() / (double)RAND_MAX);
+}
+static double timeOps(benchFunction fn, void *data, long long ops)
+{
+    //nanoseconds taken to run ops operations
+    Uint64 start = SDL_GetPerformanceCounter();
+    fn(data, ops);
+    Uint64 end = SDL_GetPerformanceCounter();
+    return (double)(end - start) * 1e9 / SDL_GetPerformanceFrequency();
+}
+static int compareDoubles(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+static void runBench(benchResult *r, const char *name, benchFunction fn, void *data, int samples)
+{
+    //times one benchmark: finds how many operations fill a sample, warms up, then takes the samples
+    int i;
+    long long ops = 1;
+    double *nsPerOp = malloc(sizeof(double) * samples);
+
+    while(ops < (1LL << 30) && timeOps(fn, data, ops) < SAMPLENS / 2)
+    {
+        ops *= 2;
+    }
+    timeOps(fn, data, ops);
+
+    for(i = 0; i < samples; i++)
+    {
+        nsPerOp[i] = timeOps(fn, data, ops) / ops;
+    }
+    qsort(nsPerOp, samples, sizeof(double), compareDoubles);
+
+    snprintf(r->name, sizeof(r->name), "%s", name);
+    r->median = nsPerOp[samples / 2];
+    r->p99 = nsPerOp[(int)ceil(samples * 0.99) - 1];
+    r->min = nsPerOp[0];
+    r->opsPerSample = ops;
+    r->samples = samples;
+    free(nsPerOp);
+}
+
+static void benchLxL(void *data, long long ops)
+{
+    collisionInputs *in = data;
+    long long i, hits = 0;
+    for(i = 0; i < ops; i++)
+    {
+        hits += intersectLxL(in->lines[i & (NUMINPUTS - 1)], in->lines[(i * 7 + 3) & (NUMINPUTS - 1)]);
+    }
+    sink += hits;
+}
+static void benchBBxL(void *data, long long ops)
+{
+    collisionInputs *in = data;
+    long long i, hits = 0;
+    for(i = 0; i < ops; i++)
+    {
+        hits += intersectBBxL(in->boxes[i & (NUMINPUTS - 1)], in->lines[(i * 7 + 3) & (NUMINPUTS - 1)]);
+    }
+    sink += hits;
+}
+static void benchBBxBB(void *data, long long ops)
+{
+    collisionInputs *in = data;
+    long long i, hits = 0;
+    for(i = 0; i < ops; i++)
+    {
+        hits += intersectBBxBB(in->boxes[i & (NUMINPUTS - 1)], in->boxes[(i * 7 + 3) & (NUMINPUTS - 1)]);
+    }
+    sink += hits;
+}
+static void benchSweep(void *data, long long ops)
+{
+    collisionInputs *in = data;
+    long long i, hits = 0;
+    for(i = 0; i < ops; i++)
+    {
+        int k = i & (NUMINPUTS - 1);
+        hits += sweepBBxL(in->boxes[k], in->dx[k], in->dy[k], in->lines[(i * 7 + 3) & (NUMINPUTS - 1)]) >= 0;
+    }
+    sink += hits;
+}
+static void benchStep(void *data, long long ops)
+{
+    //one doEvents() step of a copy of one of the taxis
+    stepInputs *in = data;
+    long long i, intact = 0;
+    for(i = 0; i < ops; i++)
+    {
+        taxi t = in->taxis[i & (NUMINPUTS - 1)];
+        doEvents(&t, in->frames, in->lvl);
+        intact += t.bintact == '1';
+    }
+    sink += intact;
+}
+static void benchStream(void *data, long long ops)
+{
+    //makes a cavern's level lines again round a different chunk each time, as happens when the taxi flies on a chunk
+    cavernInputs *in = data;
+    long long i;
+    for(i = 0; i < ops; i++)
+    {
+        in->c.first = in->c.last = -1;
+        sink += streamCavern(&in->c, &in->lvl, (i % in->c.numChunks + 0.5) * CAVERNCHUNK);
+    }
+}
+static void benchRender(void *data, long long ops)
+{
+    //a whole frame, waiting for the GPU to finish it so the drawing is timed too
+    renderInputs *in = data;
+    long long i;
+    for(i = 0; i < ops; i++)
+    {
+        render(in->t, in->lvl, in->rend);
+        glFinish();
+    }
+}
+static void benchCapture(void *data, long long ops)
+{
+    //a whole frame with the video capture started after it, the difference from render is what recording costs the game
+    captureInputs *in = data;
+    long long i;
+    for(i = 0; i < ops; i++)
+    {
+        render(in->in.t, in->in.lvl, in->in.rend);
+        captureFrame(in->vc, 1000.0 / CAPTUREFPS);
+        glFinish();
+    }
+}
+static void benchSoftRender(void *data, long long ops)
+{
+    //a whole frame drawn into memory by the software backend
+    renderInputs *in = data;
+    long long i;
+    for(i = 0; i < ops; i++)
+    {
+        render(in->t, in->lvl, in->rend);
+    }
+    sink += ((canvas *)in->rend->backend.target)->pixels[0];
+}
+static void benchRewind(void *data, long long ops)
+{
+    //saves the game after a step and rewinds a step, which costs the same however far back it goes
+    stateInputs *in = data;
+    long long i;
+    for(i = 0; i < ops; i++)
+    {
+        pushState(&in->ring, &in->t, in->lvl);
+        sink += rewindStates(&in->ring, 1, &in->t, in->lvl);
+    }
+}
+static void benchDispatch(void *data, long long ops)
+{
+    //a customer turns up and the taxi lands on their pad and picks up the best one there, so the number waiting
+    //stays the same: a heap insert and a heap removal, both O(log n)
+    cavernInputs *in = data;
+    taxi t;
+    long long i;
+    initialiseTaxi(&t, 400, 400, 3);
+    for(i = 0; i < ops; i++)
+    {
+        int id = dispatchSpawn(&in->c.customers, &in->lvl);
+        dispatchLanded(&in->c.customers, &t, &in->lvl, in->c.customers.customers[id].c.fromPlatform);
+        t.custo_waiting = '0';
+    }
+    sink += in->c.customers.pickedUp;
+}
+static void benchFleet(void *data, long long ops)
+{
+    //steps the whole fleet, an operation is one taxi's step (flying it, and its share of the sort and sweep)
+    fleetInputs *in = data;
+    long long i;
+    for(i = 0; i < ops; i += FLEETBENCHTAXIS)
+    {
+        stepFleet(&in->f, &in->t, in->lvl, 1000.0 / 240);
+    }
+    sink += in->f.bumps;
+}
+static void benchRl(void *data, long long ops)
+{
+    //steps all the environments at once, an operation is one environment's step
+    rlInputs *in = data;
+    long long i;
+    for(i = 0; i < ops; i += RLBENCHENVS)
+    {
+        rlStep(in->env, in->actions + (i / RLBENCHENVS % 64) * RLBENCHENVS, in->obs, in->rewards, in->dones);
+        sink += in->dones[0];
+    }
+}
+static void benchFont(void *data, long long ops)
+{
+    //every character the font has, once each
+    static const char glyphSet[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ.!";
+    drawList *dl = data;
+    long long i;
+    int c;
+    for(i = 0; i < ops; i++)
+    {
+        drawListClear(dl);
+        for(c = 0; glyphSet[c] != '\0'; c++)
+        {
+            printLetter(dl, glyphSet[c], 20 + c * 14, 300);
+        }
+    }
+    sink += dl->lines.count;
+}
+
+static void benchRain(void *data, long long ops)
+{
+    //a frame of rain: moving every drop, then adding them to a draw list
+    static drawList dl;
+    static int started = 0;
+    rainSystem *rain = data;
+    long long i;
+    if(started == 0)
+    {
+        drawListInit(&dl);
+        started = 1;
+    }
+    for(i = 0; i < ops; i++)
+    {
+        drawListClear(&dl);
+        updateRain(rain, 1000.0 / 60);
+        drawRain(&dl, rain);
+    }
+    sink += dl.lines.count;
+}
+
+static void makeCollisionInputs(collisionInputs *in)
+{
+    //lines and taxi sized boxes scattered over the screen, so some tests hit and some miss
+    int i;
+    for(i = 0; i < NUMINPUTS; i++)
+    {
+        double x = randomBetween(0, 800), y = randomBetween(100, 600);
+        in->lines[i].x1 = x;
+        in->lines[i].y1 = y;
+        in->lines[i].x2 = x + randomBetween(-150, 150);
+        in->lines[i].y2 = y + randomBetween(-150, 150);
+        x = randomBetween(0, 800);
+        y = randomBetween(100, 600);
+        initialiseBBox(&in->boxes[i], x - 26, y - 9, x + 25, y + 12);
+        in->dx[i] = randomBetween(-20, 20);
+        in->dy[i] = randomBetween(-20, 20);
+    }
+}
+static void makeStepInputs(stepInputs *in, level *lvl, double stepMs)
+{
+    //taxis all over the level, flying with their wheels up so none of them lands and starts customer code
+    int i;
+    double simSpeed = SIMSPEED;
+    in->lvl = lvl;
+    in->frames = stepMs * simSpeed;
+    for(i = 0; i < NUMINPUTS; i++)
+    {
+        initialiseTaxi(&in->taxis[i], randomBetween(40, 760), randomBetween(120, 580), 3);
+        in->taxis[i].wheelLandersEnabled = '0';
+        in->taxis[i].vSpeed = randomBetween(-100, 100);
+        in->taxis[i].hSpeed = randomBetween(-100, 100);
+        in->taxis[i].vThrust = rand() % 2;
+        in->taxis[i].hThrust = rand() % 3 - 1;
+    }
+}
+
+static void makeCavernStepInputs(stepInputs *in, cavernInputs *cav, double stepMs)
+{
+    //taxis spread through the chunk the cavern's lines are made round, between its floor and ceiling
+    int i;
+    double simSpeed = SIMSPEED;
+    double left = (cav->c.first + 1) * CAVERNCHUNK;
+    in->lvl = &cav->lvl;
+    in->frames = stepMs * simSpeed;
+    for(i = 0; i < NUMINPUTS; i++)
+    {
+        double x = randomBetween(left, left + CAVERNCHUNK);
+        double floorY = cavernFloor(&cav->c, x), ceilingY = cavernCeiling(&cav->c, x);
+        initialiseTaxi(&in->taxis[i], x, randomBetween(floorY + 15, ceilingY - 20), 3);
+        in->taxis[i].wheelLandersEnabled = '0';
+        in->taxis[i].vSpeed = randomBetween(-100, 100);
+        in->taxis[i].hSpeed = randomBetween(-100, 100);
+        in->taxis[i].vThrust = rand() % 2;
+        in->taxis[i].hThrust = rand() % 3 - 1;
+    }
+}
+
+static void printResults(const benchResult *results, int count, int json)
+{
+    int i;
+    if(json)
+    {
+        printf("[\n");
+        for(i = 0; i < count; i++)
+        {
+            printf("  {\"name\": \"%s\", \"median_ns\": %.3f, \"p99_ns\": %.3f, \"min_ns\": %.3f, \"ops_per_sample\": %lld, \"samples\": %d}%s\n",
+                results[i].name, results[i].median, results[i].p99, results[i].min, results[i].opsPerSample, results[i].samples,
+                i + 1 < count ? "," : "");
+        }
+        printf("]\n");
+        return;
+    }
+    printf("%-28s %12s %12s %12s %12s\n", "benchmark", "median ns", "p99 ns", "min ns", "ops/sample");
+    for(i = 0; i < count; i++)
+    {
+        printf("%-28s %12.1f %12.1f %12.1f %12lld\n", results[i].name, results[i].median, results[i].p99, results[i].min, results[i].opsPerSample);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int json = 0;
+    int samples = BENCHSAMPLES;
+    const char *filter = NULL;
+    const char *packPath = "levels.bin";
+    int i;
+
+    for(i = 1; i < argc; i++)
+    {
+        if(strcmp(argv[i], "--json") == 0)
+        {
+            json = 1;
+        }
+        else if(strcmp(argv[i], "--samples") == 0 && i + 1 < argc)
+        {
+            samples = atoi(argv[++i]);
+            if(samples < 1)
+            {
+                samples = 1;
+            }
+        }
+        else if(strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else if(strcmp(argv[i], "--levels") == 0 && i + 1 < argc)
+        {
+            packPath = argv[++i];
+        }
+    }
+
+    levelPack pack;
+    if(openLevelPack(&pack, packPath) == 0)
+    {
+        return 1;
+    }
+    //the same inputs every run, so results can be compared between builds
+    srand(1);
+
+    int maxResults = 16 + pack.numLevels;
+    benchResult *results = malloc(sizeof(benchResult) * maxResults);
+    int numResults = 0;
+    char name[64];
+
+    //collision tests
+    collisionInputs *coll = malloc(sizeof(collisionInputs));
+    makeCollisionInputs(coll);
+    if(filter == NULL || strstr("intersectLxL", filter) != NULL)
+    {
+        runBench(&results[numResults++], "intersectLxL", benchLxL, coll, samples);
+    }
+    if(filter == NULL || strstr("intersectBBxL", filter) != NULL)
+    {
+        runBench(&results[numResults++], "intersectBBxL", benchBBxL, coll, samples);
+    }
+    if(filter == NULL || strstr("intersectBBxBB", filter) != NULL)
+    {
+        runBench(&results[numResults++], "intersectBBxBB", benchBBxBB, coll, samples);
+    }
+    if(filter == NULL || strstr("sweepBBxL", filter) != NULL)
+    {
+        runBench(&results[numResults++], "sweepBBxL", benchSweep, coll, samples);
+    }
+    free(coll);
+
+    //a physics step on every level, at the game's normal step
+    stepInputs *step = malloc(sizeof(stepInputs));
+    level lvl;
+    initialiseLevel(&lvl);
+    for(i = 0; i < pack.numLevels; i++)
+    {
+        snprintf(name, sizeof(name), "doEvents level %d", i + 1);
+        if(filter != NULL && strstr(name, filter) == NULL)
+        {
+            continue;
+        }
+        loadLevel(&lvl, &pack, i);
+        makeStepInputs(step, &lvl, 1000.0 / 240);
+        runBench(&results[numResults++], name, benchStep, step, samples);
+    }
+
+    //a cavern: a step among its lines, with hundreds of pads in the level, and making its lines round a new chunk
+    cavernInputs *cav = malloc(sizeof(cavernInputs));
+    initialiseLevel(&cav->lvl);
+    makeCavern(&cav->c, &cav->lvl, 1, CAVERNCHUNKS);
+    if(filter == NULL || strstr("doEvents cavern", filter) != NULL)
+    {
+        streamCavern(&cav->c, &cav->lvl, 10.5 * CAVERNCHUNK);
+        makeCavernStepInputs(step, cav, 1000.0 / 240);
+        runBench(&results[numResults++], "doEvents cavern", benchStep, step, samples);
+    }
+    if(filter == NULL || strstr("streamCavern chunk", filter) != NULL)
+    {
+        runBench(&results[numResults++], "streamCavern chunk", benchStream, cav, samples);
+    }
+    snprintf(name, sizeof(name), "dispatch spawn + pickup (%d waiting)", DISPATCHBENCHWAITING);
+    if((filter == NULL || strstr(name, filter) != NULL) && initDispatcher(&cav->c.customers, &cav->lvl, DISPATCHMAX, DISPATCHSPAWNMS, 1))
+    {
+        for(i = 0; i < DISPATCHBENCHWAITING; i++)
+        {
+            dispatchSpawn(&cav->c.customers, &cav->lvl);
+        }
+        runBench(&results[numResults++], name, benchDispatch, cav, samples);
+        freeDispatcher(&cav->c.customers);
+    }
+    freeLevel(&cav->lvl);
+    free(cav);
+    free(step);
+
+    //practice mode's rewinding, with a full ring
+    if(filter == NULL || strstr("pushState + rewindStates", filter) != NULL)
+    {
+        stateInputs *st = malloc(sizeof(stateInputs));
+        st->lvl = &lvl;
+        startGame(&st->t, &lvl, &pack, 1);
+        if(initStateRing(&st->ring, (int)(REWINDSECONDS * 240) + 1))
+        {
+            for(i = 0; i < st->ring.capacity; i++)
+            {
+                pushState(&st->ring, &st->t, &lvl);
+            }
+            runBench(&results[numResults++], "pushState + rewindStates", benchRewind, st, samples);
+        }
+        freeStateRing(&st->ring);
+        free(st);
+    }
+
+    //a busy fleet on the second level (the first only has one pad), taking off after they've spread out
+    snprintf(name, sizeof(name), "stepFleet per taxi (%d)", FLEETBENCHTAXIS);
+    if(filter == NULL || strstr(name, filter) != NULL)
+    {
+        fleetInputs *fl = malloc(sizeof(fleetInputs));
+        fl->lvl = &lvl;
+        startGame(&fl->t, &lvl, &pack, 1);
+        if(pack.numLevels > 1)
+        {
+            loadLevel(&lvl, &pack, 1);
+            customerMakeNext(&lvl, 999, 't');
+            fl->t.levelCurrent = 2;
+        }
+        if(initFleet(&fl->f, FLEETBENCHTAXIS, 1))
+        {
+            for(i = 0; i < 240; i++)
+            {
+                stepFleet(&fl->f, &fl->t, &lvl, 1000.0 / 240);
+            }
+            runBench(&results[numResults++], name, benchFleet, fl, samples);
+        }
+        freeFleet(&fl->f);
+        free(fl);
+    }
+
+    //the learning environment, playing random actions on every level
+    snprintf(name, sizeof(name), "rlStep per env (%d)", RLBENCHENVS);
+    if(filter == NULL || strstr(name, filter) != NULL)
+    {
+        rlInputs *rl = malloc(sizeof(rlInputs));
+        rl->env = rlCreate(packPath, RLBENCHENVS, 0, 1, 0);
+        if(rl->env != NULL)
+        {
+            for(i = 0; i < RLBENCHENVS * 64; i++)
+            {
+                rl->actions[i] = rand() % RLNUMACTIONS;
+            }
+            rlReset(rl->env, 1, rl->obs);
+            runBench(&results[numResults++], name, benchRl, rl, samples);
+            rlDestroy(rl->env);
+        }
+        free(rl);
+    }
+
+    //the font, into a plain draw list
+    if(filter == NULL || strstr("printLetter glyph set", filter) != NULL)
+    {
+        drawList dl;
+        drawListInit(&dl);
+        runBench(&results[numResults++], "printLetter glyph set", benchFont, &dl, samples);
+        drawListFree(&dl);
+    }
+
+    //a storm's worth of rain
+    snprintf(name, sizeof(name), "rain %d drops", BENCHRAINDROPS);
+    if(filter == NULL || strstr(name, filter) != NULL)
+    {
+        rainSystem rain;
+        initRain(&rain, BENCHRAINDROPS);
+        runBench(&results[numResults++], name, benchRain, &rain, samples);
+        freeRain(&rain);
+    }
+
+    //a whole frame drawn by the software backend, at the window's size, no window needed
+    if(filter == NULL || strstr("render software", filter) != NULL)
+    {
+        int width = WINWIDTH;
+        int height = WINHEIGHT;
+        renderer rend;
+        canvas pic;
+        taxi t;
+        renderInputs in = {&rend, &t, &lvl};
+        if(initCanvas(&pic, width, height, 1.0))
+        {
+            initRenderer(&rend, width, height);
+            useSoftBackend(&rend, &pic);
+            startGame(&t, &lvl, &pack, 1);
+            loadLevelRenderer(&rend, &lvl);
+            lvl.isRaining = '1';
+            runBench(&results[numResults++], "render software", benchSoftRender, &in, samples);
+            freeRenderer(&rend);
+            freeCanvas(&pic);
+        }
+    }
+
+    //a whole frame, drawn in a hidden window, only made if one of the names matches
+    if(filter == NULL || strstr("render", filter) != NULL || strstr("render + capture", filter) != NULL
+       || strstr("render cavern", filter) != NULL)
+    {
+        int width = WINWIDTH;
+        int height = WINHEIGHT;
+        SDL_Window *window = NULL;
+        SDL_GLContext context = NULL;
+        if(SDL_Init(SDL_INIT_VIDEO) == 0)
+        {
+            window = SDL_CreateWindow("Taxi D'espace bench", 0, 0, width, height, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+        }
+        if(window != NULL)
+        {
+            context = SDL_GL_CreateContext(window);
+        }
+        if(context != NULL)
+        {
+            renderer rend;
+            glTarget gl;
+            taxi t;
+            renderInputs in = {&rend, &t, &lvl};
+
+            SDL_GL_SetSwapInterval(0);
+            setupView(width, height);
+            initRenderer(&rend, width, height);
+            useGLBackend(&rend, &gl);
+            if(filter == NULL || strstr("render", filter) != NULL)
+            {
+                startGame(&t, &lvl, &pack, 1);
+                loadLevelRenderer(&rend, &lvl);
+                lvl.isRaining = '1';
+                runBench(&results[numResults++], "render", benchRender, &in, samples);
+            }
+            videoCapture vc;
+            captureInputs capIn = {in, &vc};
+            if((filter == NULL || strstr("render + capture", filter) != NULL) && startCapture(&vc, "/dev/null", width, height) == 1)
+            {
+                startGame(&t, &lvl, &pack, 1);
+                loadLevelRenderer(&rend, &lvl);
+                lvl.isRaining = '1';
+                runBench(&results[numResults++], "render + capture", benchCapture, &capIn, samples);
+                stopCapture(&vc);
+            }
+
+            //halfway along a long cavern, only the chunks on screen are drawn so it should cost about the same
+            level caveLevel;
+            cavern c;
+            renderInputs caveIn = {&rend, &t, &caveLevel};
+            if((filter == NULL || strstr("render cavern", filter) != NULL) && startCavernGame(&t, &caveLevel, &c, 1, CAVERNCHUNKS))
+            {
+                t.x = (CAVERNCHUNKS / 2 + 0.5) * CAVERNCHUNK;
+                t.y = (cavernFloor(&c, t.x) + cavernCeiling(&c, t.x)) / 2;
+                loadCavernRenderer(&rend, &caveLevel, &c);
+                runBench(&results[numResults++], "render cavern", benchRender, &caveIn, samples);
+                freeCavern(&c);
+                freeLevel(&caveLevel);
+            }
+            freeRenderer(&rend);
+            freeGLTarget(&gl);
+            SDL_GL_DeleteContext(context);
+        }
+        else
+        {
+            fprintf(stderr, "no OpenGL context for the render benchmark: %s\n", SDL_GetError());
+        }
+        if(window != NULL)
+        {
+            SDL_DestroyWindow(window);
+        }
+        SDL_Quit();
+    }
+
+    printResults(results, numResults, json);
+    free(results);
+    freeLevel(&lvl);
+    closeLevelPack(&pack);
+    return 0;
+}
@@ -0,0 +1,304 @@
+//the camera and the level's chunks, see camera.h
+#include <stdlib.h>
+#include <math.h>
+#include "camera.h"
+
+//room kept round a platform's line for its number underneath and its customer on top
+#define PADMARGIN 20.0
+
+void initCamera(camera *cam, double width, double height)
+{
+    cam->x = 0;
+    cam->y = 0;
+    cam->width = width;
+    cam->height = height;
+}
+static double keepInside(double pos, double size, double low, double high)
+{
+    //moves one side of the camera back so it doesn't show past the edges of the level
+    //a level no bigger than the screen is drawn from its bottom left corner, like levels always were
+    if(pos + size > high)
+    {
+        pos = high - size;
+    }
+    if(pos < low)
+    {
+        pos = low;
+    }
+    return pos;
+}
+void followCamera(camera *cam, const level *lvl, double x, double y)
+{
+    //moves the camera just far enough to keep the point (the taxi) away from the edges of the screen
+    double edgeX = cam->width * CAMERAEDGE;
+    double edgeY = cam->height * CAMERAEDGE;
+
+    if(x < cam->x + edgeX)
+    {
+        cam->x = x - edgeX;
+    }
+    else if(x > cam->x + cam->width - edgeX)
+    {
+        cam->x = x - cam->width + edgeX;
+    }
+    if(y < cam->y + edgeY)
+    {
+        cam->y = y - edgeY;
+    }
+    else if(y > cam->y + cam->height - edgeY)
+    {
+        cam->y = y - cam->height + edgeY;
+    }
+    cam->x = keepInside(cam->x, cam->width, lvl->extent.x1, lvl->extent.x2);
+    cam->y = keepInside(cam->y, cam->height, lvl->extent.y1, lvl->extent.y2);
+}
+bbox cameraView(const camera *cam)
+{
+    //the part of the level on screen
+    bbox view = {cam->x, cam->y, cam->x + cam->width, cam->y + cam->height};
+    return view;
+}
+
+void initLevelChunks(levelChunks *lc)
+{
+    lc->cols = 0;
+    lc->rows = 0;
+    lc->chunks = NULL;
+    lc->padCol = NULL;
+    lc->padRow = NULL;
+    lc->numPads = 0;
+    lc->fromCavern = '0';
+    lc->chunksMade = 0;
+    initialiseLevel(&lc->scratch);
+}
+void freeLevelChunks(levelChunks *lc)
+{
+    //frees the chunks, leaving it ready for another level
+    int i;
+    for(i = 0; lc->chunks != NULL && i < lc->cols * lc->rows; i++)
+    {
+        drawListFree(&lc->chunks[i].lines);
+        free(lc->chunks[i].pads);
+    }
+    free(lc->chunks);
+    free(lc->padCol);
+    free(lc->padRow);
+    freeLevel(&lc->scratch);
+    initLevelChunks(lc);
+}
+
+static int chunkCol(const levelChunks *lc, double x)
+{
+    //the column of chunks x is in, anything off the level goes in the nearest column
+    int col = (int)floor((x - lc->area.x1) / CHUNKSIZE);
+    return col < 0 ? 0 : (col >= lc->cols ? lc->cols - 1 : col);
+}
+static int chunkRow(const levelChunks *lc, double y)
+{
+    int row = (int)floor((y - lc->area.y1) / CHUNKSIZE);
+    return row < 0 ? 0 : (row >= lc->rows ? lc->rows - 1 : row);
+}
+
+static int addChunkPad(levelChunk *ch, int pad)
+{
+    //returns 0 if out of memory
+    if(ch->numPads == ch->padsCapacity)
+    {
+        int capacity = ch->padsCapacity ? ch->padsCapacity * 2 : 4;
+        int *pads = realloc(ch->pads, sizeof(int) * capacity);
+        if(pads == NULL)
+        {
+            return 0;
+        }
+        ch->pads = pads;
+        ch->padsCapacity = capacity;
+    }
+    ch->pads[ch->numPads++] = pad;
+    return 1;
+}
+static void addChunkLine(levelChunks *lc, lseg l, int onlyCol)
+{
+    //adds a boundary line to every chunk its box covers, or just those in column onlyCol if that isn't -1
+    int col, row;
+    int c1 = chunkCol(lc, fmin(l.x1, l.x2)), c2 = chunkCol(lc, fmax(l.x1, l.x2));
+    int r1 = chunkRow(lc, fmin(l.y1, l.y2)), r2 = chunkRow(lc, fmax(l.y1, l.y2));
+
+    for(row = r1; row <= r2; row++)
+    {
+        for(col = c1; col <= c2; col++)
+        {
+            if(onlyCol < 0 || col == onlyCol)
+            {
+                drawListLine(&lc->chunks[row * lc->cols + col].lines, l.x1, l.y1, l.x2, l.y2);
+            }
+        }
+    }
+}
+
+static int makeChunks(levelChunks *lc, const level *lvl)
+{
+    //splits the level's extent into chunks, with no lines in them yet, and puts each platform in the chunks it's in
+    //returns 0 if out of memory
+    int i, col, row;
+
+    freeLevelChunks(lc);
+    lc->area = lvl->extent;
+    lc->cols = (int)ceil((lc->area.x2 - lc->area.x1) / CHUNKSIZE);
+    lc->rows = (int)ceil((lc->area.y2 - lc->area.y1) / CHUNKSIZE);
+    lc->cols = lc->cols < 1 ? 1 : lc->cols;
+    lc->rows = lc->rows < 1 ? 1 : lc->rows;
+    lc->chunks = calloc((size_t)lc->cols * lc->rows, sizeof(levelChunk));
+    lc->padCol = malloc(sizeof(int) * (lvl->numplatforms + 1));
+    lc->padRow = malloc(sizeof(int) * (lvl->numplatforms + 1));
+    if(lc->chunks == NULL || lc->padCol == NULL || lc->padRow == NULL)
+    {
+        freeLevelChunks(lc);
+        return 0;
+    }
+    for(i = 0; i < lc->cols * lc->rows; i++)
+    {
+        //the boundary lines are grey
+        drawListInit(&lc->chunks[i].lines);
+        drawListColour(&lc->chunks[i].lines, 0.5, 0.5, 0.5);
+        lc->chunks[i].made = '0';
+    }
+
+    lc->numPads = lvl->numplatforms;
+    for(i = 0; i < lvl->numplatforms; i++)
+    {
+        lseg l = lvl->platforms[i].l;
+        int c2 = chunkCol(lc, fmax(l.x1, l.x2)), r2 = chunkRow(lc, fmax(l.y1, l.y2) + PADMARGIN);
+        lc->padCol[i] = chunkCol(lc, fmin(l.x1, l.x2));
+        lc->padRow[i] = chunkRow(lc, fmin(l.y1, l.y2) - PADMARGIN);
+        for(row = lc->padRow[i]; row <= r2; row++)
+        {
+            for(col = lc->padCol[i]; col <= c2; col++)
+            {
+                if(addChunkPad(&lc->chunks[row * lc->cols + col], i) == 0)
+                {
+                    freeLevelChunks(lc);
+                    return 0;
+                }
+            }
+        }
+    }
+    return 1;
+}
+int loadLevelChunks(levelChunks *lc, const level *lvl)
+{
+    //splits a level's boundary lines and platforms into chunks, returns 0 if out of memory
+    //(the level's own arrays are only read here, so it's safe to pass a copy the simulation still shares)
+    int i;
+    if(makeChunks(lc, lvl) == 0)
+    {
+        return 0;
+    }
+    for(i = 0; i < lvl->numbounds; i++)
+    {
+        addChunkLine(lc, lvl->bounds[i], -1);
+    }
+    for(i = 0; i < lc->cols * lc->rows; i++)
+    {
+        lc->chunks[i].made = '1';
+    }
+    lc->chunksMade = lc->cols * lc->rows;
+    return 1;
+}
+int loadCavernChunks(levelChunks *lc, const level *lvl, const cavern *c)
+{
+    //like loadLevelChunks(), but the lines are made from the cavern when the camera first comes to them
+    //only the level's platforms are used, they're made at the start and never change
+    if(makeChunks(lc, lvl) == 0)
+    {
+        return 0;
+    }
+    lc->fromCavern = '1';
+    lc->cave = *c;
+    return 1;
+}
+
+static void makeCavernColumn(levelChunks *lc, int col)
+{
+    //makes the lines of a column of chunks, from the chunks of the cavern it overlaps
+    double x1 = lc->area.x1 + col * CHUNKSIZE, x2 = x1 + CHUNKSIZE;
+    int first = (int)floor(x1 / CAVERNCHUNK), last = (int)floor((x2 - 1) / CAVERNCHUNK);
+    int i, k, row;
+
+    first = first < 0 ? 0 : first;
+    last = last >= lc->cave.numChunks ? lc->cave.numChunks - 1 : last;
+    lc->scratch.numbounds = 0;
+    for(k = first; k <= last; k++)
+    {
+        addCavernLines(&lc->cave, &lc->scratch, k);
+    }
+    for(i = 0; i < lc->scratch.numbounds; i++)
+    {
+        lseg l = lc->scratch.bounds[i];
+        if(fmax(l.x1, l.x2) >= x1 && fmin(l.x1, l.x2) <= x2)
+        {
+            addChunkLine(lc, l, col);
+        }
+    }
+    for(row = 0; row < lc->rows; row++)
+    {
+        lc->chunks[row * lc->cols + col].made = '1';
+    }
+    lc->chunksMade += lc->rows;
+}
+int visibleChunks(levelChunks *lc, bbox view, int *found, int maxFound)
+{
+    //finds the chunks the view overlaps, making any that haven't been made yet
+    //returns how many there are (at most maxFound), their numbers are put in found
+    int col, row, n = 0;
+    if(lc->chunks == NULL)
+    {
+        return 0;
+    }
+    int c1 = chunkCol(lc, view.x1), c2 = chunkCol(lc, view.x2);
+    int r1 = chunkRow(lc, view.y1), r2 = chunkRow(lc, view.y2);
+
+    for(col = c1; col <= c2; col++)
+    {
+        if(lc->chunks[col].made == '0' && lc->fromCavern == '1')
+        {
+            makeCavernColumn(lc, col);
+        }
+    }
+    for(row = r1; row <= r2; row++)
+    {
+        for(col = c1; col <= c2 && n < maxFound; col++)
+        {
+            found[n++] = row * lc->cols + col;
+        }
+    }
+    return n;
+}
+int visiblePads(const levelChunks *lc, bbox view, int *found, int maxFound)
+{
+    //finds the platforms in the chunks the view overlaps, each once: one crossing several chunks
+    //is only taken from the first of them on screen, returns how many (at most maxFound)
+    int col, row, i, n = 0;
+    if(lc->chunks == NULL)
+    {
+        return 0;
+    }
+    int c1 = chunkCol(lc, view.x1), c2 = chunkCol(lc, view.x2);
+    int r1 = chunkRow(lc, view.y1), r2 = chunkRow(lc, view.y2);
+
+    for(row = r1; row <= r2; row++)
+    {
+        for(col = c1; col <= c2; col++)
+        {
+            const levelChunk *ch = &lc->chunks[row * lc->cols + col];
+            for(i = 0; i < ch->numPads && n < maxFound; i++)
+            {
+                int pad = ch->pads[i];
+                if((lc->padCol[pad] > c1 ? lc->padCol[pad] : c1) == col && (lc->padRow[pad] > r1 ? lc->padRow[pad] : r1) == row)
+                {
+                    found[n++] = pad;
+                }
+            }
+        }
+    }
+    return n;
+}
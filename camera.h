@@ -0,0 +1,65 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+//the camera, and the level split into chunks for drawing
+//levels bigger than the window (caverns) are drawn through a camera that follows the taxi, and only the chunks of
+//the level the camera can see are drawn, so a frame costs the same however big the level is
+//no OpenGL in here, glrender.c uploads the chunks as the camera comes to them
+#include "spacetaxi.h"
+#include "drawlist.h"
+#include "cavern.h"
+
+//width and height of a chunk
+#define CHUNKSIZE        400.0
+//the camera only moves once the taxi gets this close to the edge of the screen (a fraction of its width or height)
+#define CAMERAEDGE       0.35
+//most chunks that can be on screen at once, enough for a 2400x1600 window
+#define MAXVISIBLECHUNKS 40
+//most platforms drawn in one frame
+#define MAXVISIBLEPADS   256
+
+typedef struct
+{
+    //the part of the level on screen
+    double x, y;          //bottom left corner, in level coordinates
+    double width, height; //size of the screen
+}camera;
+
+typedef struct
+{
+    //one square of the level
+    drawList lines; //its boundary lines, a line crossing into other chunks is in each of them
+    int *pads;      //platforms in it (with their numbers and customers), a platform crossing chunks is in each of them
+    int numPads;
+    int padsCapacity;
+    char made;      //(1) once its lines have been made
+}levelChunk;
+
+typedef struct
+{
+    //the level as a grid of chunks over its extent
+    bbox area;
+    int cols, rows;
+    levelChunk *chunks; //row by row from the bottom left
+    int *padCol;        //the first column and row of chunks each platform is in, so a platform
+    int *padRow;        //in several chunks on screen is only drawn once
+    int numPads;
+    //a cavern's lines are made here a column of chunks at a time, the first time the camera sees it,
+    //as the simulation's level only has the lines near the taxi (and changes them on its own thread)
+    char fromCavern;
+    cavern cave;
+    level scratch; //the lines of a cavern's chunks, before they're shared out
+    int chunksMade;
+}levelChunks;
+
+void initCamera(camera *cam, double width, double height);
+void followCamera(camera *cam, const level *lvl, double x, double y);
+bbox cameraView(const camera *cam);
+
+void initLevelChunks(levelChunks *lc);
+void freeLevelChunks(levelChunks *lc);
+int loadLevelChunks(levelChunks *lc, const level *lvl);
+int loadCavernChunks(levelChunks *lc, const level *lvl, const cavern *c);
+int visibleChunks(levelChunks *lc, bbox view, int *found, int maxFound);
+int visiblePads(const levelChunks *lc, bbox view, int *found, int maxFound);
+
+#endif
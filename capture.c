@@ -0,0 +1,315 @@
+//recording the game to a video file, see capture.h
+#include <stdlib.h>
+#include <string.h>
+#include "capture.h"
+
+static void initFrameQueue(frameQueue *q)
+{
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+}
+static void frameQueuePush(frameQueue *q, int frame)
+{
+    //only ever holds the CAPTUREFRAMES frames there are, so it can't fill up
+    unsigned int tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    q->frames[tail % CAPTUREFRAMES] = frame;
+    atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+}
+static int frameQueuePop(frameQueue *q)
+{
+    //takes the oldest frame, returns -1 if there were none
+    unsigned int head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    if(head == atomic_load_explicit(&q->tail, memory_order_acquire))
+    {
+        return -1;
+    }
+    int frame = q->frames[head % CAPTUREFRAMES];
+    atomic_store_explicit(&q->head, head + 1, memory_order_release);
+    return frame;
+}
+
+static void convertFrame(videoCapture *vc, const unsigned char *rgba)
+{
+    //turns a frame as read back into the file's format, top row first
+    //Y4M is full range BT.601 (C420jpeg), with each colour sample the average of a 2x2 square of pixels
+    int w = vc->width, h = vc->height, x, y;
+    unsigned char *out = vc->converted;
+
+    if(vc->format == CAPTURERAW)
+    {
+        for(y = 0; y < h; y++)
+        {
+            const unsigned char *row = rgba + (size_t)(h - 1 - y) * w * 4;
+            for(x = 0; x < w; x++, out += 3)
+            {
+                out[0] = row[x * 4];
+                out[1] = row[x * 4 + 1];
+                out[2] = row[x * 4 + 2];
+            }
+        }
+        return;
+    }
+
+    unsigned char *u = out + w * h, *v = u + (w / 2) * (h / 2);
+    for(y = 0; y < h; y++)
+    {
+        const unsigned char *row = rgba + (size_t)(h - 1 - y) * w * 4;
+        for(x = 0; x < w; x++)
+        {
+            const unsigned char *p = row + x * 4;
+            out[y * w + x] = (77 * p[0] + 150 * p[1] + 29 * p[2] + 128) >> 8;
+        }
+    }
+    for(y = 0; y < h / 2; y++)
+    {
+        //rows read back bottom first, so the pair of rows for chroma row y are these two
+        const unsigned char *top = rgba + (size_t)(h - 1 - y * 2) * w * 4, *below = top - (size_t)w * 4;
+        for(x = 0; x < w / 2; x++)
+        {
+            int k = x * 8;
+            int r = top[k] + top[k + 4] + below[k] + below[k + 4];
+            int g = top[k + 1] + top[k + 5] + below[k + 1] + below[k + 5];
+            int b = top[k + 2] + top[k + 6] + below[k + 2] + below[k + 6];
+            //the sums are 4 times the average, so the weights are a quarter of the usual ones times 256
+            //and rounding them can take pure blue or red just past 255
+            int cb = (-11 * r - 21 * g + 32 * b + 32768 + 128) >> 8;
+            int cr = (32 * r - 27 * g - 5 * b + 32768 + 128) >> 8;
+            u[y * (w / 2) + x] = cb > 255 ? 255 : cb;
+            v[y * (w / 2) + x] = cr > 255 ? 255 : cr;
+        }
+    }
+}
+static void *encoderThread(void *data)
+{
+    //writes frames as they come until told to stop, then writes whatever is left
+    videoCapture *vc = data;
+    size_t bytes = vc->format == CAPTURERAW ? (size_t)vc->width * vc->height * 3 : (size_t)vc->width * vc->height * 3 / 2;
+
+    for(;;)
+    {
+        sem_wait(&vc->ready);
+        int frame = frameQueuePop(&vc->full);
+        if(frame < 0)
+        {
+            if(atomic_load(&vc->stop))
+            {
+                break;
+            }
+            continue;
+        }
+        if(vc->failed == '0')
+        {
+            convertFrame(vc, vc->frames[frame]);
+            if((vc->format == CAPTUREY4M && fputs("FRAME\n", vc->out) == EOF) || fwrite(vc->converted, 1, bytes, vc->out) != bytes)
+            {
+                vc->failed = '1';
+            }
+            else
+            {
+                vc->written++;
+            }
+        }
+        frameQueuePush(&vc->empty, frame);
+    }
+    return NULL;
+}
+
+static int hasSyncObjects(void)
+{
+    //reading back into pixel buffers without waiting needs fences, OpenGL 3.2 or the GL_ARB_sync extension
+    //(with pixel buffer objects and glMapBufferRange, which 3.2 has anyway)
+    int major = 0, minor = 0;
+    const char *version = (const char *)glGetString(GL_VERSION);
+    const char *extensions = (const char *)glGetString(GL_EXTENSIONS);
+
+    if(version != NULL && sscanf(version, "%d.%d", &major, &minor) == 2)
+    {
+        if(major > 3 || (major == 3 && minor >= 2))
+        {
+            return 1;
+        }
+    }
+    return extensions != NULL && strstr(extensions, "GL_ARB_sync") != NULL
+        && strstr(extensions, "GL_ARB_pixel_buffer_object") != NULL && strstr(extensions, "GL_ARB_map_buffer_range") != NULL;
+}
+static void freeFrames(videoCapture *vc)
+{
+    int i;
+    for(i = 0; i < CAPTUREFRAMES; i++)
+    {
+        free(vc->frames[i]);
+        vc->frames[i] = NULL;
+    }
+    free(vc->converted);
+    vc->converted = NULL;
+}
+
+int startCapture(videoCapture *vc, const char *path, int width, int height)
+{
+    //opens the video file and starts the encoder, a .y4m file is written as Y4M and anything else as raw RGB24
+    //the width and height are rounded down to even numbers for Y4M's colour samples, needs the GL context to be current
+    //returns 0, having said why and undone everything, if the driver can't read back without waiting,
+    //the file couldn't be opened, it ran out of memory or the encoder thread couldn't start
+    size_t length = strlen(path);
+    int i;
+
+    if(hasSyncObjects() == 0)
+    {
+        printf("can't capture: the OpenGL driver has no sync objects (needs 3.2 or GL_ARB_sync)\n");
+        return 0;
+    }
+    vc->format = length > 4 && strcmp(path + length - 4, ".y4m") == 0 ? CAPTUREY4M : CAPTURERAW;
+    vc->width = vc->format == CAPTUREY4M ? width & ~1 : width;
+    vc->height = vc->format == CAPTUREY4M ? height & ~1 : height;
+    vc->frameMs = 1000.0 / CAPTUREFPS;
+    vc->untilNext = 0;
+    vc->oldest = 0;
+    vc->pending = 0;
+    vc->captured = 0;
+    vc->dropped = 0;
+    vc->written = 0;
+    vc->failed = '0';
+    vc->converted = malloc((size_t)vc->width * vc->height * 3);
+    int ok = vc->converted != NULL;
+    for(i = 0; i < CAPTUREFRAMES; i++)
+    {
+        vc->frames[i] = malloc((size_t)vc->width * vc->height * 4);
+        ok = ok && vc->frames[i] != NULL;
+    }
+    if(ok == 0)
+    {
+        printf("can't capture: out of memory for the frames\n");
+        freeFrames(vc);
+        return 0;
+    }
+    vc->out = fopen(path, "wb");
+    if(vc->out == NULL)
+    {
+        printf("can't capture: can't write %s\n", path);
+        freeFrames(vc);
+        return 0;
+    }
+    if(sem_init(&vc->ready, 0, 0) != 0)
+    {
+        printf("can't capture: no semaphore for the encoder thread\n");
+        fclose(vc->out);
+        remove(path);
+        freeFrames(vc);
+        return 0;
+    }
+    if(vc->format == CAPTUREY4M)
+    {
+        fprintf(vc->out, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", vc->width, vc->height, CAPTUREFPS);
+    }
+
+    //every frame starts free, and the pixel buffers are made once at the frame's size
+    initFrameQueue(&vc->full);
+    initFrameQueue(&vc->empty);
+    for(i = 0; i < CAPTUREFRAMES; i++)
+    {
+        frameQueuePush(&vc->empty, i);
+    }
+    glGenBuffers(CAPTUREPBOS, vc->pbos);
+    for(i = 0; i < CAPTUREPBOS; i++)
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, vc->pbos[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)vc->width * vc->height * 4, NULL, GL_STREAM_READ);
+        vc->fences[i] = 0;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    atomic_init(&vc->stop, 0);
+    if(pthread_create(&vc->encoder, NULL, encoderThread, vc) != 0)
+    {
+        printf("can't capture: the encoder thread didn't start\n");
+        glDeleteBuffers(CAPTUREPBOS, vc->pbos);
+        sem_destroy(&vc->ready);
+        fclose(vc->out);
+        remove(path);
+        freeFrames(vc);
+        return 0;
+    }
+    return 1;
+}
+static void collectFrames(videoCapture *vc, int wait)
+{
+    //copies out the read backs that have finished, oldest first, and hands them to the encoder
+    //only waits for the GPU if wait is 1, for the last frames when stopping
+    while(vc->pending > 0)
+    {
+        int p = vc->oldest;
+        GLenum state = glClientWaitSync(vc->fences[p], GL_SYNC_FLUSH_COMMANDS_BIT, wait ? 1000000000 : 0);
+        if(state != GL_ALREADY_SIGNALED && state != GL_CONDITION_SATISFIED)
+        {
+            return;
+        }
+        glDeleteSync(vc->fences[p]);
+        vc->fences[p] = 0;
+
+        //maps the pixels before taking a free frame, as only the encoder hands frames back to the free queue
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, vc->pbos[p]);
+        const void *pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)vc->width * vc->height * 4, GL_MAP_READ_BIT);
+        int frame = pixels != NULL ? frameQueuePop(&vc->empty) : -1;
+        if(frame >= 0)
+        {
+            memcpy(vc->frames[frame], pixels, (size_t)vc->width * vc->height * 4);
+            frameQueuePush(&vc->full, frame);
+            sem_post(&vc->ready);
+            vc->captured++;
+        }
+        else
+        {
+            //couldn't map it, or the encoder is behind and has every frame, so this one is skipped
+            vc->dropped++;
+        }
+        if(pixels != NULL)
+        {
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        vc->oldest = (vc->oldest + 1) % CAPTUREPBOS;
+        vc->pending--;
+    }
+}
+void captureFrame(videoCapture *vc, double ms)
+{
+    //call after render() and before the buffers are swapped, with the time since the last frame
+    //starts reading back this frame if a video frame is due, and hands any earlier ones that have arrived to the encoder
+    collectFrames(vc, 0);
+    vc->untilNext -= ms;
+    if(vc->untilNext > 0)
+    {
+        return;
+    }
+    //frames drawn slower than the video's rate leave it a bit short, rather than catching up with copies
+    vc->untilNext = vc->untilNext < -vc->frameMs ? vc->frameMs : vc->untilNext + vc->frameMs;
+    if(vc->pending == CAPTUREPBOS)
+    {
+        //every pixel buffer is still being read back into
+        vc->dropped++;
+        return;
+    }
+    int p = (vc->oldest + vc->pending) % CAPTUREPBOS;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, vc->pbos[p]);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, vc->width, vc->height, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    vc->fences[p] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    vc->pending++;
+}
+void stopCapture(videoCapture *vc)
+{
+    //hands over the frames still being read back, waits for the encoder to write everything, and closes the file
+    collectFrames(vc, 1);
+    atomic_store(&vc->stop, 1);
+    sem_post(&vc->ready);
+    pthread_join(vc->encoder, NULL);
+    sem_destroy(&vc->ready);
+
+    glDeleteBuffers(CAPTUREPBOS, vc->pbos);
+    if(fclose(vc->out) != 0)
+    {
+        vc->failed = '1';
+    }
+    freeFrames(vc);
+}
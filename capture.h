@@ -0,0 +1,70 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+//recording the game to a video file as it's played, without slowing it down
+//each frame is read back from the back buffer into one of a ring of pixel buffer objects, which the GPU fills in
+//its own time, and copied out a couple of frames later once its fence says it's done, so glReadPixels never stalls
+//the copies go to an encoder thread through a lock-free queue, and it converts and writes them to disk,
+//so the main thread never waits for the file either; if the encoder falls behind, frames are dropped, not waited for
+//writes raw RGB24 (ffmpeg -f rawvideo -pix_fmt rgb24 -s WxH -r 60 -i file) or Y4M (4:2:0, plays as it is)
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include <stdio.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+//frames being read back at once, each into its own pixel buffer object
+#define CAPTUREPBOS   3
+//frames copied out and waiting for the encoder thread (a power of two)
+#define CAPTUREFRAMES 8
+//frames a second in the video, frames drawn faster than this are skipped
+#define CAPTUREFPS    60
+
+//what the video file is
+#define CAPTURERAW 0
+#define CAPTUREY4M 1
+
+typedef struct
+{
+    //ring of frame numbers written by one thread and read by the other, like inputQueue
+    int frames[CAPTUREFRAMES];
+    atomic_uint head; //next to read
+    atomic_uint tail; //next free place to write
+}frameQueue;
+
+typedef struct
+{
+    int width, height;
+    int format;
+    FILE *out;
+
+    //the read back ring, only used by the main thread
+    GLuint pbos[CAPTUREPBOS];
+    GLsync fences[CAPTUREPBOS]; //signalled when each one's read back has finished
+    int oldest;       //the pixel buffer read into longest ago
+    int pending;      //pixel buffers read into and not copied out yet
+    double frameMs;   //time between video frames
+    double untilNext; //time until the next video frame is due
+
+    //frames copied out of the pixel buffers (RGBA, bottom row first, as read back), handed to the encoder and back
+    unsigned char *frames[CAPTUREFRAMES];
+    frameQueue full;  //waiting to be written
+    frameQueue empty; //free for another
+    sem_t ready;      //posted for each full frame and to stop, so the encoder sleeps when there's nothing to do
+    atomic_int stop;
+    pthread_t encoder;
+    unsigned char *converted; //the encoder's frame in the file's format
+
+    //counts
+    long long captured; //frames handed to the encoder
+    long long dropped;  //frames skipped as a pixel buffer or free frame wasn't ready
+    long long written;  //frames written by the encoder (read once it's stopped)
+    char failed;        //(1) if writing the file failed
+}videoCapture;
+
+int startCapture(videoCapture *vc, const char *path, int width, int height);
+void captureFrame(videoCapture *vc, double ms);
+void stopCapture(videoCapture *vc);
+
+#endif
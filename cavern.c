@@ -0,0 +1,302 @@
+//procedural caverns, see cavern.h
+#include <stdlib.h>
+#include <math.h>
+#include "cavern.h"
+
+//pads are tried at two places in each chunk, this far in from its left edge and then CAVERNPADGAP on
+#define CAVERNPADAT     200.0
+#define CAVERNPADGAP    400.0
+//least room kept between the floor and the ceiling, and between a rock and the other side
+#define CAVERNMINGAP    160.0
+//steps either side of a pad with no floor rocks and the floor kept below the pad
+#define CAVERNPADCLEAR  2
+
+//which noise each shape uses, so they're unrelated
+#define NOISEDEPTH  0
+#define NOISEWIGGLE 1
+#define NOISEHEIGHT 2
+#define NOISEPADS   3
+#define NOISEROCKS  4
+
+static double latticeValue(const cavern *c, int salt, long long i)
+{
+    //a random number from 0 to 1 for each whole number i, the same every time for the same seed
+    //each one is a fresh PCG stream, so they can be worked out in any order
+    pcg32 r;
+    pcgSeed(&r, c->seed, (unsigned long long)i * 8 + salt);
+    return pcgNext(&r) / 4294967296.0;
+}
+static double smoothNoise(const cavern *c, int salt, double x, double wavelength)
+{
+    //value noise: a random height every wavelength, joined by smooth curves
+    double f = x / wavelength;
+    long long i = (long long)floor(f);
+    double t = f - i;
+    t = t * t * (3 - 2 * t);
+    return latticeValue(c, salt, i) * (1 - t) + latticeValue(c, salt, i + 1) * t;
+}
+
+static void rawShape(const cavern *c, double x, double *floorY, double *ceilingY)
+{
+    //the cavern before pads and rocks: winding slowly down and up, with small wiggles, and wider and narrower in places
+    //the start is a plain 800x600 room round where the taxi starts, and the cavern grows out of it gradually
+    //so no slope is too steep to fly along
+    double drop = CAVERNDEPTH * smoothNoise(c, NOISEDEPTH, x, 4000) + 60 * smoothNoise(c, NOISEWIGGLE, x, 400);
+    double height = 220 + 200 * smoothNoise(c, NOISEHEIGHT, x, 900);
+    double w = (x - 400) / 2000;
+    w = w < 0 ? 0 : (w > 1 ? 1 : w);
+    w = w * w * (3 - 2 * w);
+    *ceilingY = CAVERNTOP - 10 - drop * w;
+    *floorY = *ceilingY - (390 * (1 - w) + height * w);
+}
+
+static int chunkPad(const cavern *c, int chunk, int k, double *x1, double *x2, double *y)
+{
+    //pad k (0 or 1) of a chunk, if it has one: 100 to 150 wide, lined up with the floor steps
+    if(chunk < 0 || chunk >= c->numChunks || latticeValue(c, NOISEPADS, chunk * 4LL + k * 2) < 0.25)
+    {
+        return 0;
+    }
+    double r = latticeValue(c, NOISEPADS, chunk * 4LL + k * 2 + 1);
+    double centre = chunk * CAVERNCHUNK + CAVERNPADAT + k * CAVERNPADGAP + floor((r - 0.5) * 6) * CAVERNSTEP;
+    double width = (4 + (int)(r * 1000) % 3) * CAVERNSTEP;
+    double floorY, ceilingY;
+    *x1 = centre - floor(width / 2 / CAVERNSTEP) * CAVERNSTEP;
+    *x2 = *x1 + width;
+    rawShape(c, centre, &floorY, &ceilingY);
+    *y = floor(floorY) + 4;
+    return 1;
+}
+
+static double floorVertex(const cavern *c, long long i, int *nearPad)
+{
+    //height of the floor at step i, just under any pad there (and kept below pads either side, so each sits on a mound)
+    double x = i * CAVERNSTEP, x1, x2, y;
+    double floorY, ceilingY;
+    int chunk = (int)floor(x / CAVERNCHUNK), k;
+
+    rawShape(c, x, &floorY, &ceilingY);
+    *nearPad = 0;
+    for(k = 0; k < 2; k++)
+    {
+        if(chunkPad(c, chunk, k, &x1, &x2, &y) && x >= x1 - CAVERNPADCLEAR * CAVERNSTEP && x <= x2 + CAVERNPADCLEAR * CAVERNSTEP)
+        {
+            *nearPad = 1;
+            if(x >= x1 && x <= x2)
+            {
+                floorY = y - 1;
+            }
+            else if(floorY > y - 1)
+            {
+                floorY = y - 1;
+            }
+        }
+    }
+    return floorY;
+}
+static double ceilingVertex(const cavern *c, long long i)
+{
+    //height of the ceiling at step i, kept high enough above the floor
+    double floorY, ceilingY;
+    int nearPad;
+    rawShape(c, i * CAVERNSTEP, &floorY, &ceilingY);
+    floorY = floorVertex(c, i, &nearPad);
+    if(ceilingY < floorY + CAVERNMINGAP)
+    {
+        ceilingY = floorY + CAVERNMINGAP;
+    }
+    return ceilingY > CAVERNTOP ? CAVERNTOP : ceilingY;
+}
+
+static double rockHeight(const cavern *c, long long i, int salt, double gap)
+{
+    //how far a rock sticks out halfway along step i (0 for no rock), a tenth of steps have one
+    double r = latticeValue(c, salt, i);
+    if(r > 0.1 || gap < CAVERNMINGAP + 20)
+    {
+        return 0;
+    }
+    return fmin(20 + r * 500, gap - CAVERNMINGAP);
+}
+
+static void stepShape(const cavern *c, long long i, double *floorY, double *floorMid, double *ceilingY, double *ceilingMid)
+{
+    //the floor and ceiling at the start of step i, and halfway along it (the tip of a rock if it has one)
+    int nearPad, nextNearPad;
+    double nextFloor, nextCeiling;
+
+    floorY[0] = floorVertex(c, i, &nearPad);
+    nextFloor = floorVertex(c, i + 1, &nextNearPad);
+    ceilingY[0] = ceilingVertex(c, i);
+    nextCeiling = ceilingVertex(c, i + 1);
+    *floorMid = (floorY[0] + nextFloor) / 2;
+    *ceilingMid = (ceilingY[0] + nextCeiling) / 2;
+    *ceilingMid -= rockHeight(c, i, NOISEROCKS, *ceilingMid - *floorMid);
+    if(!nearPad && !nextNearPad)
+    {
+        *floorMid += rockHeight(c, i, NOISEROCKS + 1, *ceilingMid - *floorMid);
+    }
+    floorY[1] = nextFloor;
+    ceilingY[1] = nextCeiling;
+}
+
+static double lineAt(double x, long long i, const double *ends, double mid)
+{
+    //height at x of step i's line, which goes from ends[0] to mid (halfway) to ends[1]
+    double t = (x - i * CAVERNSTEP) / (CAVERNSTEP / 2);
+    if(t < 1)
+    {
+        return ends[0] + (mid - ends[0]) * t;
+    }
+    return mid + (ends[1] - mid) * (t - 1);
+}
+double cavernFloor(const cavern *c, double x)
+{
+    //the height of the floor's line at x, rocks included
+    long long i = (long long)floor(x / CAVERNSTEP);
+    double floorY[2], ceilingY[2], floorMid, ceilingMid;
+    stepShape(c, i, floorY, &floorMid, ceilingY, &ceilingMid);
+    return lineAt(x, i, floorY, floorMid);
+}
+double cavernCeiling(const cavern *c, double x)
+{
+    long long i = (long long)floor(x / CAVERNSTEP);
+    double floorY[2], ceilingY[2], floorMid, ceilingMid;
+    stepShape(c, i, floorY, &floorMid, ceilingY, &ceilingMid);
+    return lineAt(x, i, ceilingY, ceilingMid);
+}
+
+void addCavernLines(cavern *c, level *lvl, int chunk)
+{
+    //adds a chunk's floor and ceiling as boundary lines, two per step (a straight step is still split at halfway,
+    //so a chunk always makes the same number of lines), and the end walls if it's the first or last chunk
+    int steps = (int)(CAVERNCHUNK / CAVERNSTEP);
+    long long first = (long long)chunk * steps, i;
+    int before = lvl->numbounds;
+
+    for(i = first; i < first + steps; i++)
+    {
+        double floorY[2], ceilingY[2], floorMid, ceilingMid;
+        double x = i * CAVERNSTEP, mid = x + CAVERNSTEP / 2, next = x + CAVERNSTEP;
+        stepShape(c, i, floorY, &floorMid, ceilingY, &ceilingMid);
+        addBoundary(lvl, x, floorY[0], mid, floorMid);
+        addBoundary(lvl, mid, floorMid, next, floorY[1]);
+        addBoundary(lvl, x, ceilingY[0], mid, ceilingMid);
+        addBoundary(lvl, mid, ceilingMid, next, ceilingY[1]);
+    }
+    if(chunk == 0)
+    {
+        addBoundary(lvl, 1, cavernFloor(c, 0), 1, cavernCeiling(c, 0));
+    }
+    if(chunk == c->numChunks - 1)
+    {
+        double end = c->numChunks * CAVERNCHUNK - 1;
+        addBoundary(lvl, end, cavernFloor(c, end), end, cavernCeiling(c, end));
+    }
+    c->linesMade += lvl->numbounds - before;
+}
+
+int streamCavern(cavern *c, level *lvl, double x)
+{
+    //makes sure the level has the lines of the chunks within CAVERNRADIUS of x, call before each step
+    //returns 1 if the level's lines (and collision grid) were made again, so anything drawn from them needs updating
+    int chunk = (int)floor(x / CAVERNCHUNK), k;
+    int first = chunk - CAVERNRADIUS, last = chunk + CAVERNRADIUS;
+
+    first = first < 0 ? 0 : first;
+    last = last >= c->numChunks ? c->numChunks - 1 : last;
+    if(first == c->first && last == c->last)
+    {
+        return 0;
+    }
+
+    //a few hundred lines, so it's quicker to make them all again than to keep track of which chunk is where
+    lvl->numbounds = 0;
+    for(k = first; k <= last; k++)
+    {
+        addCavernLines(c, lvl, k);
+    }
+    c->first = first;
+    c->last = last;
+    c->streams++;
+
+    //the grid only covers these chunks, the pads in the rest of the cavern are left out of it
+    bbox area = {first * CAVERNCHUNK - CAVERNSTEP, -1e9, (last + 1) * CAVERNCHUNK + CAVERNSTEP, 1e9};
+    buildLevelGridArea(lvl, &area);
+    return 1;
+}
+
+int makeCavern(cavern *c, level *lvl, unsigned int seed, int numChunks)
+{
+    //makes a cavern numChunks long as the level: all its pads, and the lines round the start
+    //the level should be empty (just initialised), returns 0 if it ran out of memory
+    int chunk, k;
+
+    c->seed = seed;
+    c->numChunks = numChunks > 1 ? numChunks : 1;
+    c->first = 0;
+    c->last = -1;
+    c->linesMade = 0;
+    c->streams = 0;
+
+    for(chunk = 0; chunk < c->numChunks; chunk++)
+    {
+        for(k = 0; k < 2; k++)
+        {
+            double x1, x2, y;
+            int before = lvl->numplatforms;
+            if(chunkPad(c, chunk, k, &x1, &x2, &y))
+            {
+                addPad(lvl, x1, y, x2, y);
+                if(lvl->numplatforms == before)
+                {
+                    return 0;
+                }
+            }
+        }
+    }
+    //the camera can go anywhere from the start to the end, and from the top of the screen down past the deepest floor
+    lvl->extent.x1 = 0;
+    lvl->extent.y1 = CAVERNTOP - CAVERNDEPTH - 600;
+    lvl->extent.x2 = c->numChunks * CAVERNCHUNK;
+    lvl->extent.y2 = 600;
+    lvl->rainChance = 0;
+    lvl->isRaining = '0';
+    lvl->levelCustomerNumber = CAVERNCUSTOMERS;
+    lvl->levelCustomerCurrentNumber = 0;
+    streamCavern(c, lvl, 400);
+    return lvl->numbounds > 0;
+}
+
+int startCavernGame(taxi *t, level *lvl, cavern *c, unsigned int seed, int numChunks)
+{
+    //like startGame(), but the level is a cavern made from the seed, with hundreds of customers waiting at once
+    //all over it rather than one at a time, call freeCavern() when done with it
+    //returns 0 if it ran out of memory making the cavern or its customers, with the level freed and nothing to free with freeCavern()
+    int i;
+    initialiseLevel(lvl);
+    seedRandom(lvl, seed);
+    if(makeCavern(c, lvl, seed, numChunks) == 0)
+    {
+        freeLevel(lvl);
+        return 0;
+    }
+    customerMakeNext(lvl, 999, 'f');
+    if(initDispatcher(&c->customers, lvl, DISPATCHMAX, DISPATCHSPAWNMS, seed) == 0)
+    {
+        freeLevel(lvl);
+        return 0;
+    }
+    for(i = 0; i < DISPATCHSTART; i++)
+    {
+        dispatchSpawn(&c->customers, lvl);
+    }
+    lvl->dispatch = &c->customers;
+    initialiseTaxi(t, 400, 400, 3);
+    return 1;
+}
+void freeCavern(cavern *c)
+{
+    //frees what startCavernGame() allocated, the level is freed with freeLevel() as usual
+    freeDispatcher(&c->customers);
+}
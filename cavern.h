@@ -0,0 +1,45 @@
+#ifndef CAVERN_H
+#define CAVERN_H
+//procedural caverns: long winding levels made from a seed, for long sessions
+//the floor, ceiling and rocks come from noise that only depends on the seed and x, so any chunk of the cavern
+//can be made on its own and always comes out the same
+//the pads for the whole cavern are made at the start (customers can ask for any of them), but boundary lines are
+//only made for the chunks near the taxi, and made again as it moves along, so a cavern can be as long as you like
+#include "spacetaxi.h"
+#include "dispatch.h"
+
+//width of a chunk, the piece of cavern made at a time
+#define CAVERNCHUNK     800.0
+//the floor and ceiling are lines this wide
+#define CAVERNSTEP      25.0
+//chunks either side of the taxi's own that have their lines made
+#define CAVERNRADIUS    1
+//length of a cavern, unless asked for another
+#define CAVERNCHUNKS    512
+//highest the ceiling goes, below the top of the screen so the taxi can't leave the level
+#define CAVERNTOP       560.0
+//how far down the cavern winds
+#define CAVERNDEPTH     1200.0
+//customers in a cavern, it's for playing as long as you like
+#define CAVERNCUSTOMERS 1000000
+
+typedef struct
+{
+    //a cavern being played, the level holds its pads and the lines of chunks first to last
+    unsigned int seed;
+    int numChunks;
+    int first, last;     //chunks whose lines are in the level now
+    long long linesMade; //lines made so far, counting chunks made again
+    int streams;         //times the level's lines have been made
+    dispatcher customers; //lots of customers waiting at once, set up by startCavernGame()
+}cavern;
+
+int makeCavern(cavern *c, level *lvl, unsigned int seed, int numChunks);
+int streamCavern(cavern *c, level *lvl, double x);
+void addCavernLines(cavern *c, level *lvl, int chunk);
+int startCavernGame(taxi *t, level *lvl, cavern *c, unsigned int seed, int numChunks);
+void freeCavern(cavern *c);
+double cavernFloor(const cavern *c, double x);
+double cavernCeiling(const cavern *c, double x);
+
+#endif
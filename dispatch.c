@@ -0,0 +1,386 @@
+//customer dispatch for big levels: lots of customers waiting at once, kept in heaps by fare (see dispatch.h)
+#include <stdlib.h>
+#include <math.h>
+#include "dispatch.h"
+
+static double heapKey(const dispatcher *d, const customerHeap *h, int id)
+{
+    //the value the heap orders by, negated for the heap with the smallest on top
+    return h->sign * d->customers[id].value;
+}
+static void heapSet(customerHeap *h, int at, int id)
+{
+    h->items[at] = id;
+    h->pos[id] = at;
+}
+static void siftUp(const dispatcher *d, customerHeap *h, int at)
+{
+    //moves the customer at position at up until its parent's key is at least its own
+    int id = h->items[at];
+    double key = heapKey(d, h, id);
+    while(at > 0)
+    {
+        int parent = (at - 1) / 2;
+        if(heapKey(d, h, h->items[parent]) >= key)
+        {
+            break;
+        }
+        heapSet(h, at, h->items[parent]);
+        at = parent;
+    }
+    heapSet(h, at, id);
+}
+static void siftDown(const dispatcher *d, customerHeap *h, int at)
+{
+    //moves the customer at position at down until both its children's keys are at most its own
+    int id = h->items[at];
+    double key = heapKey(d, h, id);
+    for(;;)
+    {
+        int child = at * 2 + 1;
+        if(child >= h->count)
+        {
+            break;
+        }
+        if(child + 1 < h->count && heapKey(d, h, h->items[child + 1]) > heapKey(d, h, h->items[child]))
+        {
+            child++;
+        }
+        if(heapKey(d, h, h->items[child]) <= key)
+        {
+            break;
+        }
+        heapSet(h, at, h->items[child]);
+        at = child;
+    }
+    heapSet(h, at, id);
+}
+static void heapPush(const dispatcher *d, customerHeap *h, int id)
+{
+    heapSet(h, h->count++, id);
+    siftUp(d, h, h->count - 1);
+}
+static void heapRemove(const dispatcher *d, customerHeap *h, int id)
+{
+    //takes a customer out from anywhere in the heap: the last one goes in its place and is moved up or down
+    int at = h->pos[id];
+    int last = h->items[--h->count];
+    h->pos[id] = -1;
+    if(at < h->count)
+    {
+        heapSet(h, at, last);
+        siftUp(d, h, at);
+        siftDown(d, h, h->pos[last]);
+    }
+}
+
+static void removeCustomer(dispatcher *d, int id)
+{
+    //takes a customer out of the heaps and off their pad, and frees their place
+    waitingCustomer *w = &d->customers[id];
+    heapRemove(d, &d->best, id);
+    heapRemove(d, &d->soonest, id);
+    if(w->prevAtPad >= 0)
+    {
+        d->customers[w->prevAtPad].nextAtPad = w->nextAtPad;
+    }
+    else
+    {
+        d->padFirst[w->c.fromPlatform] = w->nextAtPad;
+    }
+    if(w->nextAtPad >= 0)
+    {
+        d->customers[w->nextAtPad].prevAtPad = w->prevAtPad;
+    }
+    d->freeList[d->numFree++] = id;
+    if(d->offered == id)
+    {
+        d->offered = -1;
+    }
+}
+
+typedef struct
+{
+    //a pad and the middle of it along x, for sorting
+    double x;
+    int pad;
+}padPosition;
+
+static int comparePadX(const void *a, const void *b)
+{
+    //for qsort, orders pads by the middle of the pad along x, then by number so ties always come out the same
+    const padPosition *A = a, *B = b;
+    if(A->x != B->x)
+    {
+        return A->x > B->x ? 1 : -1;
+    }
+    return (A->pad > B->pad) - (A->pad < B->pad);
+}
+
+int initDispatcher(dispatcher *d, const level *lvl, int capacity, double spawnMs, unsigned int seed)
+{
+    //sets up an empty dispatcher for the level's pads, with room for capacity customers waiting at once
+    //a new customer turns up every spawnMs of game time, returns 0 if out of memory
+    int i, n = lvl->numplatforms > 0 ? lvl->numplatforms : 1;
+
+    d->capacity = capacity > 0 ? capacity : 1;
+    d->customers = malloc(sizeof(waitingCustomer) * d->capacity);
+    d->freeList = malloc(sizeof(int) * d->capacity);
+    d->best.items = malloc(sizeof(int) * d->capacity);
+    d->best.pos = malloc(sizeof(int) * d->capacity);
+    d->soonest.items = malloc(sizeof(int) * d->capacity);
+    d->soonest.pos = malloc(sizeof(int) * d->capacity);
+    d->padFirst = malloc(sizeof(int) * n);
+    d->padOrder = malloc(sizeof(int) * n);
+    d->padX = malloc(sizeof(double) * n);
+    d->best.count = 0;
+    d->best.sign = 1;
+    d->soonest.count = 0;
+    d->soonest.sign = -1;
+    d->numPads = lvl->numplatforms;
+    d->offered = -1;
+    d->spawnMs = spawnMs > 0 ? spawnMs : DISPATCHSPAWNMS;
+    d->nextSpawnMs = lvl->gameTime + d->spawnMs;
+    pcgSeed(&d->rng, seed, 18);
+    d->spawned = 0;
+    d->expired = 0;
+    d->pickedUp = 0;
+    d->delivered = 0;
+    d->dropped = 0;
+    if(d->customers == NULL || d->freeList == NULL || d->best.items == NULL || d->best.pos == NULL
+       || d->soonest.items == NULL || d->soonest.pos == NULL || d->padFirst == NULL || d->padOrder == NULL || d->padX == NULL)
+    {
+        freeDispatcher(d);
+        return 0;
+    }
+
+    //free places are taken from the end of the stack, so customer 0 is used first
+    d->numFree = d->capacity;
+    for(i = 0; i < d->capacity; i++)
+    {
+        d->freeList[i] = d->capacity - 1 - i;
+        d->best.pos[i] = -1;
+        d->soonest.pos[i] = -1;
+    }
+    padPosition *sorted = malloc(sizeof(padPosition) * n);
+    if(sorted == NULL)
+    {
+        freeDispatcher(d);
+        return 0;
+    }
+    for(i = 0; i < d->numPads; i++)
+    {
+        const lseg *l = &lvl->platforms[i].l;
+        d->padFirst[i] = -1;
+        sorted[i].x = (l->x1 + l->x2) / 2;
+        sorted[i].pad = i;
+    }
+    qsort(sorted, d->numPads, sizeof(padPosition), comparePadX);
+    for(i = 0; i < d->numPads; i++)
+    {
+        d->padOrder[i] = sorted[i].pad;
+        d->padX[i] = sorted[i].x;
+    }
+    free(sorted);
+    return 1;
+}
+void freeDispatcher(dispatcher *d)
+{
+    free(d->customers);
+    free(d->freeList);
+    free(d->best.items);
+    free(d->best.pos);
+    free(d->soonest.items);
+    free(d->soonest.pos);
+    free(d->padFirst);
+    free(d->padOrder);
+    free(d->padX);
+    d->customers = NULL;
+    d->freeList = NULL;
+    d->best.items = NULL;
+    d->best.pos = NULL;
+    d->soonest.items = NULL;
+    d->soonest.pos = NULL;
+    d->padFirst = NULL;
+    d->padOrder = NULL;
+    d->padX = NULL;
+    d->numFree = 0;
+    d->best.count = 0;
+    d->soonest.count = 0;
+    d->numPads = 0;
+}
+
+int dispatchSpawn(dispatcher *d, const level *lvl)
+{
+    //a new customer turns up on a random pad, wanting to go to one of the pads near it
+    //returns their number, or -1 if there's no room (or fewer than two pads)
+    if(d->numPads < 2)
+    {
+        return -1;
+    }
+    if(d->numFree == 0)
+    {
+        d->dropped++;
+        return -1;
+    }
+    int from = (int)pcgBelow(&d->rng, d->numPads);
+    int lo = from - DISPATCHTRIPPADS, hi = from + DISPATCHTRIPPADS;
+    lo = lo < 0 ? 0 : lo;
+    hi = hi >= d->numPads ? d->numPads - 1 : hi;
+    //picks from the pads round it and skips over its own, like customerMakeNext()
+    int to = lo + (int)pcgBelow(&d->rng, hi - lo);
+    if(to >= from)
+    {
+        to++;
+    }
+
+    int id = d->freeList[--d->numFree];
+    waitingCustomer *w = &d->customers[id];
+    w->c.fare = pcgBelow(&d->rng, 1000) + 1000;
+    w->c.timeWaiting = 0;
+    w->c.fromPlatform = d->padOrder[from];
+    w->c.destPlatform = d->padOrder[to];
+    w->value = w->c.fare + 10.0 * lvl->currentTimeSecs;
+    w->prevAtPad = -1;
+    w->nextAtPad = d->padFirst[w->c.fromPlatform];
+    if(w->nextAtPad >= 0)
+    {
+        d->customers[w->nextAtPad].prevAtPad = id;
+    }
+    d->padFirst[w->c.fromPlatform] = id;
+    heapPush(d, &d->best, id);
+    heapPush(d, &d->soonest, id);
+    d->spawned++;
+    return id;
+}
+double dispatchFare(const dispatcher *d, int id, int secs)
+{
+    //what customer id would pay if picked up at game second secs
+    return d->customers[id].value - 10.0 * secs;
+}
+int dispatchCount(const dispatcher *d)
+{
+    //customers waiting now
+    return d->best.count;
+}
+
+int dispatchOffer(const dispatcher *d, const level *lvl, double x)
+{
+    //the customer to offer a taxi at x: the best fare at pickup from the pads within DISPATCHREACH, reckoning the taxi
+    //takes a second for every DISPATCHSPEED pixels to get there, or the best fare anywhere if nobody near is worth going for
+    //returns -1 if nobody is waiting
+    int lo = 0, hi = d->numPads, i, id, best = -1;
+    double bestFare = 0;
+
+    //binary search for the first pad that's within reach on the left
+    while(lo < hi)
+    {
+        int mid = (lo + hi) / 2;
+        if(d->padX[mid] < x - DISPATCHREACH)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    for(i = lo; i < d->numPads && d->padX[i] <= x + DISPATCHREACH; i++)
+    {
+        double secs = lvl->currentTimeSecs + fabs(d->padX[i] - x) / DISPATCHSPEED;
+        for(id = d->padFirst[d->padOrder[i]]; id >= 0; id = d->customers[id].nextAtPad)
+        {
+            double fare = d->customers[id].value - 10.0 * secs;
+            if(fare > bestFare)
+            {
+                bestFare = fare;
+                best = id;
+            }
+        }
+    }
+    if(best < 0 && d->best.count > 0)
+    {
+        best = d->best.items[0];
+    }
+    return best;
+}
+
+void updateDispatch(dispatcher *d, taxi *t, level *lvl)
+{
+    //called every step after the clock moves on: customers whose fare has run out leave, new ones turn up,
+    //and the level's current customer is set to the one the taxi is carrying, or else the one it's offered
+    //(picked when the last one's gone, not every step),
+    //so everything that shows or flies to the level's customer works the same as with one customer at a time
+    while(d->soonest.count > 0 && dispatchFare(d, d->soonest.items[0], lvl->currentTimeSecs) <= 0)
+    {
+        removeCustomer(d, d->soonest.items[0]);
+        d->expired++;
+    }
+    while(lvl->gameTime >= d->nextSpawnMs)
+    {
+        dispatchSpawn(d, lvl);
+        d->nextSpawnMs += d->spawnMs;
+    }
+
+    if(t->custo_waiting == '1')
+    {
+        lvl->currentCustomer = t->custo_current;
+        lvl->customerWaiting = '0';
+        return;
+    }
+    if(d->offered < 0)
+    {
+        d->offered = dispatchOffer(d, lvl, t->x);
+    }
+    int id = d->offered;
+    if(id >= 0)
+    {
+        lvl->currentCustomer = d->customers[id].c;
+        lvl->currentCustomer.fare = dispatchFare(d, id, lvl->currentTimeSecs);
+        lvl->customerWaiting = '1';
+    }
+    else
+    {
+        lvl->currentCustomer.fromPlatform = -1;
+        lvl->currentCustomer.destPlatform = -1;
+        lvl->customerWaiting = '0';
+    }
+}
+
+void dispatchLanded(dispatcher *d, taxi *t, level *lvl, int pad)
+{
+    //the taxi is sat on pad: drops off its customer if this is where they're going, then picks up the best fare waiting here
+    //the fare is fixed when they get in and paid when they get out, the same as one customer at a time
+    int id, best = -1;
+
+    if(t->custo_waiting == '1' && t->custo_current.destPlatform == pad)
+    {
+        t->custo_waiting = '0';
+        t->money += t->custo_current.fare;
+        t->landingOnceCustoCheck = '0';
+        lvl->levelCustomerCurrentNumber++;
+        d->delivered++;
+    }
+    if(t->custo_waiting == '1' || pad < 0 || pad >= d->numPads)
+    {
+        return;
+    }
+    for(id = d->padFirst[pad]; id >= 0; id = d->customers[id].nextAtPad)
+    {
+        if(best < 0 || d->customers[id].value > d->customers[best].value)
+        {
+            best = id;
+        }
+    }
+    if(best >= 0)
+    {
+        t->custo_current = d->customers[best].c;
+        t->custo_current.fare = dispatchFare(d, best, lvl->currentTimeSecs);
+        t->custo_waiting = '1';
+        t->landingOnceCustoCheck = '1';
+        removeCustomer(d, best);
+        d->pickedUp++;
+        lvl->currentCustomer = t->custo_current;
+        lvl->customerWaiting = '0';
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef DISPATCH_H
+#define DISPATCH_H
+//customer dispatch for big levels: lots of customers waiting at once on pads all over the level, instead of one at a time
+//every waiting customer's fare goes down by 10 a second, like the single customer's, so it's kept as a value that doesn't
+//change: what their fare would be at game time 0, and their fare at second s is value - 10 * s
+//that means nothing is ticked down each second, and customers keep the same order however long they wait:
+//the highest value has the best fare at pickup (for the same pickup time), and the lowest runs out (fare 0) first
+//so the waiting customers are in two heaps over the same value, one with the best on top and one with the soonest to
+//run out, and a customer turning up, running out or being picked up costs O(log n)
+//the taxi is offered the best fare it could pick up, allowing for how far away each pad is, from the pads near it,
+//(until that customer's gone), and it takes the best customer waiting at whatever pad it lands on
+//doesn't need SDL or OpenGL
+#include "spacetaxi.h"
+
+//most customers waiting at once in a cavern, and how many are there at the start
+#define DISPATCHMAX       4096
+#define DISPATCHSTART     256
+//a new customer turns up this often (in a cavern)
+#define DISPATCHSPAWNMS   250.0
+//customers want to go to one of this many pads either side of theirs (along x), not right across the level
+#define DISPATCHTRIPPADS  8
+//how far either side of the taxi it looks for the best fare to offer, and how fast it reckons the taxi flies
+//(pixels a second) when working out what a fare will be by the time it gets there
+#define DISPATCHREACH     2400.0
+#define DISPATCHSPEED     60.0
+
+typedef struct
+{
+    //a customer waiting on a pad
+    customer c;     //fare is what it was when they turned up
+    double value;   //fare + 10 * the second they turned up, see above
+    int nextAtPad;  //the other customers waiting on the same pad, -1 at the ends
+    int prevAtPad;
+}waitingCustomer;
+
+typedef struct
+{
+    //a binary heap of customer numbers, biggest value on top for sign 1 or smallest for -1
+    int *items;
+    int *pos;  //where each customer is in items, -1 if not in the heap
+    int count;
+    double sign;
+}customerHeap;
+
+typedef struct dispatcher
+{
+    waitingCustomer *customers; //room for capacity customers, the free ones are on a stack
+    int *freeList;
+    int numFree;
+    int capacity;
+    customerHeap best;    //highest value on top
+    customerHeap soonest; //lowest value on top
+
+    int numPads;
+    int *padFirst;  //the first customer waiting on each pad, or -1
+    int *padOrder;  //pads sorted by x, for finding those near the taxi
+    double *padX;   //middle of each pad along x, in padOrder's order
+
+    int offered; //the customer the taxi is offered, kept until they're picked up or leave so it isn't sent back and forth
+
+    double spawnMs;     //time between customers turning up
+    double nextSpawnMs; //game time the next one turns up
+    pcg32 rng;
+
+    //counts, for the soak test
+    long long spawned;
+    long long expired;
+    long long pickedUp;
+    long long delivered;
+    long long dropped; //customers that didn't turn up because it was full
+}dispatcher;
+
+int initDispatcher(dispatcher *d, const level *lvl, int capacity, double spawnMs, unsigned int seed);
+void freeDispatcher(dispatcher *d);
+int dispatchSpawn(dispatcher *d, const level *lvl);
+double dispatchFare(const dispatcher *d, int id, int secs);
+int dispatchCount(const dispatcher *d);
+int dispatchOffer(const dispatcher *d, const level *lvl, double x);
+void updateDispatch(dispatcher *d, taxi *t, level *lvl);
+void dispatchLanded(dispatcher *d, taxi *t, level *lvl, int pad);
+
+#endif
@@ -0,0 +1,97 @@
+//lists of coloured 2D vertices, see drawlist.h
+#include <stdlib.h>
+#include "drawlist.h"
+
+vertex *vertexListAdd(vertexList *l, int n)
+{
+    //makes room for n more vertices at the end of the list and returns where they go, or NULL if out of memory
+    if(l->count + n > l->capacity)
+    {
+        int capacity = l->capacity ? l->capacity * 2 : 256;
+        while(capacity < l->count + n)
+        {
+            capacity *= 2;
+        }
+        vertex *v = realloc(l->v, sizeof(vertex) * capacity);
+        if(v == NULL)
+        {
+            return NULL;
+        }
+        l->v = v;
+        l->capacity = capacity;
+    }
+    l->count += n;
+    return l->v + l->count - n;
+}
+static void setVertex(drawList *dl, vertex *v, double x, double y)
+{
+    v->x = x;
+    v->y = y;
+    v->r = dl->r;
+    v->g = dl->g;
+    v->b = dl->b;
+    v->a = 255;
+}
+
+void drawListInit(drawList *dl)
+{
+    //starts both lists empty, drawing in white
+    dl->lines.v = NULL;
+    dl->lines.count = 0;
+    dl->lines.capacity = 0;
+    dl->tris = dl->lines;
+    drawListColour(dl, 1.0, 1.0, 1.0);
+}
+void drawListFree(drawList *dl)
+{
+    free(dl->lines.v);
+    free(dl->tris.v);
+    drawListInit(dl);
+}
+void drawListClear(drawList *dl)
+{
+    //empties the lists, keeping the memory for the next frame
+    dl->lines.count = 0;
+    dl->tris.count = 0;
+}
+void drawListColour(drawList *dl, double r, double g, double b)
+{
+    //sets the colour for the following vertices, from 0.0 to 1.0 like glColor3d
+    dl->r = r * 255.0 + 0.5;
+    dl->g = g * 255.0 + 0.5;
+    dl->b = b * 255.0 + 0.5;
+}
+void drawListVertex(drawList *dl, double x, double y)
+{
+    //adds one end of a line, call it twice per line like glVertex3d between glBegin(GL_LINES) and glEnd()
+    vertex *v = vertexListAdd(&dl->lines, 1);
+    if(v != NULL)
+    {
+        setVertex(dl, v, x, y);
+    }
+}
+void drawListLine(drawList *dl, double x1, double y1, double x2, double y2)
+{
+    drawListVertex(dl, x1, y1);
+    drawListVertex(dl, x2, y2);
+}
+void drawListFan(drawList *dl, const double *points, int numPoints, double xOff, double yOff)
+{
+    //adds a triangle fan, given as x,y pairs and moved by xOff,yOff, split up into separate triangles
+    int i;
+    if(numPoints < 3)
+    {
+        return;
+    }
+    vertex *v = vertexListAdd(&dl->tris, (numPoints - 2) * 3);
+    if(v == NULL)
+    {
+        return;
+    }
+    for(i = 1; i < numPoints - 1; i++)
+    {
+        setVertex(dl, v++, points[0] + xOff, points[1] + yOff);
+        setVertex(dl, v++, points[i * 2] + xOff, points[i * 2 + 1] + yOff);
+        setVertex(dl, v++, points[i * 2 + 2] + xOff, points[i * 2 + 3] + yOff);
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef DRAWLIST_H
+#define DRAWLIST_H
+//lists of coloured 2D vertices, filled in on the CPU and then drawn all at once
+//the scene code only ever adds to these lists, so it does not need OpenGL itself
+
+typedef struct
+{
+    float x;
+    float y;
+    unsigned char r, g, b, a; //colour, 0 to 255
+}vertex;
+
+typedef struct
+{
+    vertex *v;    //the vertices
+    int count;    //number of vertices in use
+    int capacity; //number of vertices allocated
+}vertexList;
+
+typedef struct
+{
+    vertexList lines; //every two vertices make a line, like GL_LINES
+    vertexList tris;  //every three vertices make a triangle, like GL_TRIANGLES
+    unsigned char r, g, b; //colour given to new vertices, like glColor3d
+}drawList;
+
+vertex *vertexListAdd(vertexList *l, int n);
+void drawListInit(drawList *dl);
+void drawListFree(drawList *dl);
+void drawListClear(drawList *dl);
+void drawListColour(drawList *dl, double r, double g, double b);
+void drawListVertex(drawList *dl, double x, double y);
+void drawListLine(drawList *dl, double x1, double y1, double x2, double y2);
+void drawListFan(drawList *dl, const double *points, int numPoints, double xOff, double yOff);
+
+#endif
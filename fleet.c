@@ -0,0 +1,401 @@
+//the fleet, see fleet.h
+#include <stdlib.h>
+#include <math.h>
+#include "fleet.h"
+#include "autopilot.h"
+
+//floats in each pad's distance map
+#define FLEETFIELDSIZE (APFIELDROWS * APFIELDCOLS)
+
+int initFleet(fleet *f, int numTaxis, unsigned int seed)
+{
+    //room for numTaxis taxis (at most FLEETMAX), which take off the first time stepFleet() is called
+    //returns 0 if out of memory
+    int i;
+    numTaxis = numTaxis < 0 ? 0 : (numTaxis > FLEETMAX ? FLEETMAX : numTaxis);
+    f->numTaxis = numTaxis;
+    f->taxis = malloc(sizeof(taxi) * (numTaxis + 1));
+    f->pilots = malloc(sizeof(fleetPilot) * (numTaxis + 1));
+    f->order = malloc(sizeof(int) * (numTaxis + 1));
+    f->left = malloc(sizeof(double) * (numTaxis + 1));
+    f->fields = NULL;
+    f->numFields = 0;
+    f->fieldsCapacity = 0;
+    f->levelBounds = NULL;
+    f->levelNumber = -1;
+    initialiseLevel(&f->traffic);
+    pcgSeed(&f->rng, seed, 17);
+    f->pairsTested = 0;
+    f->bumps = 0;
+    f->collisions = 0;
+    f->crashes = 0;
+    f->playerCrashes = 0;
+    f->landings = 0;
+    if(f->taxis == NULL || f->pilots == NULL || f->order == NULL || f->left == NULL)
+    {
+        freeFleet(f);
+        return 0;
+    }
+    //the player's taxi goes on the end of the sweep list
+    for(i = 0; i <= numTaxis; i++)
+    {
+        f->order[i] = i;
+    }
+    return 1;
+}
+void freeFleet(fleet *f)
+{
+    //the level copy's arrays are the player's level's, so only the fleet's own memory is freed
+    free(f->taxis);
+    free(f->pilots);
+    free(f->order);
+    free(f->left);
+    free(f->fields);
+    f->taxis = NULL;
+    f->pilots = NULL;
+    f->order = NULL;
+    f->left = NULL;
+    f->fields = NULL;
+    f->numTaxis = 0;
+    f->numFields = 0;
+    f->fieldsCapacity = 0;
+}
+
+static int otherPad(fleet *f, int pad)
+{
+    //a random pad that isn't the one given, unless there's only one
+    if(f->numFields < 2)
+    {
+        return 0;
+    }
+    int k = pcgBelow(&f->rng, f->numFields - 1);
+    return k >= pad ? k + 1 : k;
+}
+static void respawnFleetTaxi(fleet *f, int i)
+{
+    //puts a taxi down on a random pad, with its wheels down, to take off for another one after a short wait
+    taxi *t = &f->taxis[i];
+    fleetPilot *p = &f->pilots[i];
+    int pad = pcgBelow(&f->rng, f->numFields);
+    lseg l = f->traffic.platforms[pad].l;
+    double room = fabs(l.x2 - l.x1) - 51;
+    double x = fmin(l.x1, l.x2) + 26 + (room > 0 ? room * pcgBelow(&f->rng, 1000) / 1000.0 : room / 2);
+
+    initialiseTaxi(t, x, l.y1 + 10, 3);
+    t->levelCurrent = f->levelNumber;
+    t->inflight = '0';
+    t->vSpeed = 10.0;
+    p->target = otherPad(f, pad);
+    p->waitMs = FLEETWAITMS * pcgBelow(&f->rng, 1000) / 1000.0;
+    p->takeoffY = t->y;
+    p->avoidH = 0;
+    p->avoidV = 0;
+}
+static void loadFleetLevel(fleet *f, const level *lvl, int levelNumber)
+{
+    //a new level: works out the distance map to each of its pads and respawns every taxi
+    taxi shape;
+    int k;
+
+    f->levelBounds = lvl->bounds;
+    f->levelNumber = levelNumber;
+
+    f->numFields = 0;
+    if(lvl->numplatforms > f->fieldsCapacity)
+    {
+        float *fields = realloc(f->fields, sizeof(float) * FLEETFIELDSIZE * lvl->numplatforms);
+        if(fields == NULL)
+        {
+            return;
+        }
+        f->fields = fields;
+        f->fieldsCapacity = lvl->numplatforms;
+    }
+    initialiseTaxi(&shape, 0, 0, 3);
+    for(k = 0; k < lvl->numplatforms; k++)
+    {
+        buildDistanceField(f->fields + (size_t)k * FLEETFIELDSIZE, &shape, lvl, k);
+    }
+    f->numFields = lvl->numplatforms;
+    for(k = 0; k < f->numTaxis && f->numFields > 0; k++)
+    {
+        respawnFleetTaxi(f, k);
+    }
+}
+
+static void flyFleetTaxi(fleet *f, int i, double ms, taxiInput *in)
+{
+    //one of the fleet's pilots: waits a moment on a pad, climbs off it with the wheels down, then follows the
+    //distance map to its target downhill, slows down over it and drops onto it with the wheels down
+    taxi *t = &f->taxis[i];
+    fleetPilot *p = &f->pilots[i];
+    lseg pad = f->traffic.platforms[p->target].l;
+    const float *field = f->fields + (size_t)p->target * FLEETFIELDSIZE;
+    double wantH = 0, wantV = 0;
+    double avoidH = p->avoidH, avoidV = p->avoidV;
+    char wheels = '0';
+
+    p->avoidH = 0;
+    p->avoidV = 0;
+    in->vThrust = 0;
+    in->hThrust = 0;
+    in->toggleWheels = 0;
+    if(t->inflight == '0')
+    {
+        //the thrust has to be let go of and pressed again to take off, see applyInput()
+        if(t->vThrust > 0)
+        {
+            return;
+        }
+        if(p->waitMs > 0)
+        {
+            p->waitMs -= ms;
+            return;
+        }
+        in->vThrust = 1;
+        p->takeoffY = t->y;
+        return;
+    }
+
+    //the map has nothing right down by the pad (the taxi doesn't fit there with room to spare), so the last
+    //bit of the way down onto it is worked out from where the pad is
+    double d = fieldDistance(field, t->x, t->y);
+    double step = APCELL / 2;
+    double height = t->y - (pad.y1 + 10);
+    char overPad = t->x > fmin(pad.x1, pad.x2) + 8 && t->x < fmax(pad.x1, pad.x2) - 8 && height > -2 && height < 3 * APCELL;
+    if(t->wheelLandersEnabled == '1' && t->y < p->takeoffY + FLEETCLIMB && overPad == 0)
+    {
+        //still climbing off the pad it took off from
+        wantV = FLEETCRUISE;
+        wheels = '1';
+    }
+    else if(overPad)
+    {
+        //over the target: stop going sideways, then put the wheels down and drop onto it
+        if(fabs(t->hSpeed) < 8 || t->wheelLandersEnabled == '1')
+        {
+            wheels = '1';
+            wantV = -30;
+        }
+    }
+    else if(d < APFAR)
+    {
+        //downhill in the distance map, slowing down near the end
+        double gx = fieldDistance(field, t->x + step, t->y) - fieldDistance(field, t->x - step, t->y);
+        double gy = fieldDistance(field, t->x, t->y + step) - fieldDistance(field, t->x, t->y - step);
+        double length = sqrt(gx * gx + gy * gy);
+        double speed = fmin(FLEETCRUISE, 20 + d);
+        if(length > 1e-6 && length < APFAR)
+        {
+            wantH = -gx / length * speed;
+            wantV = -gy / length * speed;
+        }
+        if(d < 3 * APCELL)
+        {
+            //nearly there, so line up with the middle of the pad
+            wantH = fmax(-30, fmin(30, ((pad.x1 + pad.x2) / 2 - t->x)));
+        }
+        wantH += avoidH * FLEETAVOID;
+        wantV += avoidV * FLEETAVOID;
+    }
+    else
+    {
+        //somewhere the map doesn't reach, so go up until it does
+        wantV = FLEETCRUISE / 2;
+    }
+
+    in->vThrust = t->vSpeed < wantV ? 1 : 0;
+    in->hThrust = t->hSpeed < wantH - 4 ? 1 : (t->hSpeed > wantH + 4 ? -1 : 0);
+    in->toggleWheels = (t->wheelLandersEnabled == '1') != (wheels == '1');
+}
+
+static void touchTaxis(fleet *f, taxi *a, taxi *b, bbox ba, bbox bb, const taxi *player)
+{
+    //two taxis' boxes overlap: if they came together fast enough both crash, otherwise they're pushed apart
+    //along whichever way they overlap least, and stop coming together that way
+    //a landed taxi isn't moving whatever its speeds say (gravity keeps adding to them), so it stays put if it can
+    double ah = a->inflight == '1' ? a->hSpeed : 0, av = a->inflight == '1' ? a->vSpeed : 0;
+    double bh = b->inflight == '1' ? b->hSpeed : 0, bv = b->inflight == '1' ? b->vSpeed : 0;
+    double speed = sqrt((ah - bh) * (ah - bh) + (av - bv) * (av - bv));
+
+    if(speed > FLEETBUMPSPEED)
+    {
+        a->justDied = '1';
+        a->bintact = '0';
+        a->inflight = '0';
+        b->justDied = '1';
+        b->bintact = '0';
+        b->inflight = '0';
+        f->collisions++;
+        f->playerCrashes += a == player || b == player;
+        return;
+    }
+
+    double overlapX = fmin(ba.x2, bb.x2) - fmax(ba.x1, bb.x1);
+    double overlapY = fmin(ba.y2, bb.y2) - fmax(ba.y1, bb.y1);
+    double shareA = 0.5;
+    if(a->inflight != b->inflight)
+    {
+        shareA = a->inflight == '1' ? 1.0 : 0.0;
+    }
+    if(overlapX < overlapY || (a->inflight == '0' && b->inflight == '0'))
+    {
+        //sideways
+        double side = a->x > b->x ? 1.0 : -1.0;
+        a->x += side * overlapX * shareA;
+        b->x -= side * overlapX * (1 - shareA);
+        if((ah - bh) * side < 0)
+        {
+            a->hSpeed = shareA > 0 ? bh : a->hSpeed;
+            b->hSpeed = shareA < 1 ? ah : b->hSpeed;
+        }
+    }
+    else
+    {
+        double side = a->y > b->y ? 1.0 : -1.0;
+        a->y += side * overlapY * shareA;
+        b->y -= side * overlapY * (1 - shareA);
+        if((av - bv) * side < 0)
+        {
+            a->vSpeed = shareA > 0 ? bv : a->vSpeed;
+            b->vSpeed = shareA < 1 ? av : b->vSpeed;
+        }
+    }
+    f->bumps++;
+}
+static void sweepTaxis(fleet *f, taxi *player)
+{
+    //finds every pair of taxis touching, by sort and sweep along x (see fleet.h)
+    int n = f->numTaxis + 1;
+    int i, k;
+
+    for(i = 0; i < n; i++)
+    {
+        taxi *t = i < f->numTaxis ? &f->taxis[i] : player;
+        f->left[i] = t->x + t->bb.x1;
+    }
+    //insertion sort of last step's order, which is nearly sorted already
+    for(i = 1; i < n; i++)
+    {
+        int id = f->order[i];
+        double left = f->left[id];
+        for(k = i - 1; k >= 0 && f->left[f->order[k]] > left; k--)
+        {
+            f->order[k + 1] = f->order[k];
+        }
+        f->order[k + 1] = id;
+    }
+    //each taxi against the ones after it in the list, until they start right of where it ends
+    for(i = 0; i < n; i++)
+    {
+        taxi *a = f->order[i] < f->numTaxis ? &f->taxis[f->order[i]] : player;
+        if(a->bintact == '0')
+        {
+            continue;
+        }
+        bbox ba = getBBox(a);
+        for(k = i + 1; k < n && f->left[f->order[k]] < ba.x2 + FLEETNEAR; k++)
+        {
+            taxi *b = f->order[k] < f->numTaxis ? &f->taxis[f->order[k]] : player;
+            if(b->bintact == '0')
+            {
+                continue;
+            }
+            f->pairsTested++;
+            bbox bb = getBBox(b);
+            bbox nearby = {bb.x1 - FLEETNEAR, bb.y1 - FLEETNEAR, bb.x2 + FLEETNEAR, bb.y2 + FLEETNEAR};
+            if(intersectBBxBB(ba, nearby) == 0)
+            {
+                continue;
+            }
+            if(intersectBBxBB(ba, bb) == 0)
+            {
+                //close, but not touching: the fleet's pilots steer away from each other next step
+                double dx = a->x - b->x, dy = a->y - b->y;
+                double length = sqrt(dx * dx + dy * dy) + 1e-9;
+                if(f->order[i] < f->numTaxis)
+                {
+                    f->pilots[f->order[i]].avoidH += dx / length;
+                    f->pilots[f->order[i]].avoidV += dy / length;
+                }
+                if(f->order[k] < f->numTaxis)
+                {
+                    f->pilots[f->order[k]].avoidH -= dx / length;
+                    f->pilots[f->order[k]].avoidV -= dy / length;
+                }
+            }
+            else
+            {
+                touchTaxis(f, a, b, ba, bb, player);
+                if(a->bintact == '0')
+                {
+                    break;
+                }
+                ba = getBBox(a);
+            }
+        }
+    }
+}
+
+void stepFleet(fleet *f, taxi *player, const level *lvl, double ms)
+{
+    //moves the fleet on by ms milliseconds, then finds taxis touching each other, the player's included
+    //call it before the player's step, so a crash it causes is dealt with by that step's updateGame()
+    double simSpeed = SIMSPEED;
+    taxiInput in;
+    int i;
+
+    //the level copy is taken again every step, as the player's level can have its grid built again
+    //(or its lines changed) between steps, but the maps only change with the level
+    f->traffic = *lvl;
+    f->traffic.dispatch = NULL;
+    f->traffic.customerWaiting = '0';
+    f->traffic.currentCustomer.fromPlatform = -1;
+    f->traffic.currentCustomer.destPlatform = -1;
+    if(lvl->bounds != f->levelBounds || player->levelCurrent != f->levelNumber || lvl->numplatforms != f->numFields)
+    {
+        loadFleetLevel(f, lvl, player->levelCurrent);
+    }
+    if(f->numFields == 0)
+    {
+        return;
+    }
+    for(i = 0; i < f->numTaxis; i++)
+    {
+        taxi *t = &f->taxis[i];
+        fleetPilot *p = &f->pilots[i];
+        if(t->bintact == '0')
+        {
+            //a wreck, for a while
+            if(t->justDied == '1')
+            {
+                t->justDied = '0';
+                p->waitMs = FLEETWRECKMS;
+                f->crashes++;
+            }
+            p->waitMs -= ms;
+            if(p->waitMs <= 0)
+            {
+                respawnFleetTaxi(f, i);
+            }
+            continue;
+        }
+        char flying = t->inflight;
+        //the same as stepGame(), without the clock and the bonus life
+        flyFleetTaxi(f, i, ms, &in);
+        applyInput(t, &in);
+        doEvents(t, ms * simSpeed, &f->traffic);
+        if(t->nextLevel == '1')
+        {
+            respawnFleetTaxi(f, i);
+        }
+        else if(flying == '1' && t->inflight == '0' && t->bintact == '1')
+        {
+            //landed, off to another pad after a moment
+            f->landings++;
+            p->waitMs = FLEETWAITMS;
+            p->target = otherPad(f, p->target);
+        }
+    }
+    sweepTaxis(f, player);
+}
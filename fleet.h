@@ -0,0 +1,73 @@
+#ifndef FLEET_H
+#define FLEET_H
+//fleet mode: lots of computer flown taxis sharing the level with the player's, for a busy airspace
+//the fleet's taxis fly from pad to pad without customers, steering down the autopilot's distance maps
+//(one per pad, worked out once per level and shared by every taxi), and hit the level's lines just like the
+//player's taxi, through a copy of the level that shares its arrays and collision grid
+//taxis are found touching (or nearly touching, to steer the fleet apart) by sort and sweep: a list of every taxi (the player's too) kept sorted
+//by the left edge of its bounding box, so only taxis that overlap along x get their boxes compared
+//taxis hardly move between steps, so the list from the last step is nearly sorted already and an
+//insertion sort puts it right in about one pass, so a step costs about the number of taxis rather than its square
+//doesn't need SDL or OpenGL, spacetaxi_headless fleet soak tests it
+#include "spacetaxi.h"
+
+//most taxis in a fleet
+#define FLEETMAX        4096
+//taxis touching slower than this bump apart, faster and both crash (the same as landing too fast)
+#define FLEETBUMPSPEED  100.0
+//how long a fleet taxi waits on a pad before taking off for the next one (the game keeps adding gravity
+//to a landed taxi, so much longer and it couldn't take off again), and how long a wreck stays before it respawns
+#define FLEETWAITMS     120.0
+#define FLEETWRECKMS    1000.0
+//fastest the fleet's pilots fly, and how far above the pad they took off from they climb before raising the wheels
+#define FLEETCRUISE     100.0
+#define FLEETCLIMB      15.0
+//taxis closer than this to each other (between their boxes) are steered apart, this fast for each one nearby
+#define FLEETNEAR       20.0
+#define FLEETAVOID      30.0
+
+typedef struct
+{
+    //what one of the fleet's pilots is doing
+    int target;      //the pad it's flying to
+    double waitMs;   //time left sat on a pad, or as a wreck
+    double takeoffY; //where it took off from, it keeps its wheels down until it's FLEETCLIMB above it
+    double avoidH;   //which way is away from the taxis nearby, added up by the last sweep
+    double avoidV;
+}fleetPilot;
+
+typedef struct
+{
+    taxi *taxis;         //the computer flown taxis
+    fleetPilot *pilots;
+    int numTaxis;
+
+    //the level the fleet flies in: a copy of the player's without customers, sharing its arrays and collision grid
+    //(taken every step, so it never holds on to a grid the player's level has freed)
+    level traffic;
+    const lseg *levelBounds; //what the maps were made from, so they're made again for a new level
+    int levelNumber;
+    //distance maps to each pad (APFIELDROWS * APFIELDCOLS floats each), from buildDistanceField()
+    float *fields;
+    int numFields;
+    int fieldsCapacity;
+
+    //sort and sweep: every taxi, numTaxis being the player's, sorted by the left of its bounding box
+    int *order;
+    double *left;
+    pcg32 rng; //picks pads, so a seeded fleet always flies the same
+
+    //counts, for the soak test
+    long long pairsTested;   //boxes compared by the sweep
+    long long bumps;         //touching taxis pushed apart
+    long long collisions;    //pairs of taxis that hit each other too fast, and both crashed
+    long long crashes;       //fleet taxis crashed, into lines or each other
+    long long playerCrashes; //times another taxi crashed the player's
+    long long landings;
+}fleet;
+
+int initFleet(fleet *f, int numTaxis, unsigned int seed);
+void freeFleet(fleet *f);
+void stepFleet(fleet *f, taxi *player, const level *lvl, double ms);
+
+#endif
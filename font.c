@@ -0,0 +1,168 @@
+//the game's line font, see font.h
+#include <stdlib.h>
+#include <string.h>
+#include "font.h"
+
+//every character the game can print, indexed by its upper case ASCII code
+//(this used to be a switch in printLetter() with a glBegin/glEnd per character)
+static const glyph glyphs[128] = {
+    ['0'] = {6, {{10,1,10,8}, {10,9,10,16}, {0,1,0,8}, {0,9,0,16}, {1,0,9,0}, {1,17,9,17}}},
+    ['1'] = {2, {{10,1,10,8}, {10,9,10,16}}},
+    ['2'] = {5, {{10,1,10,8}, {0,9,0,16}, {1,0,9,0}, {1,9,9,9}, {1,17,9,17}}},
+    ['3'] = {5, {{10,1,10,8}, {10,9,10,16}, {1,0,9,0}, {1,9,9,9}, {1,17,9,17}}},
+    ['4'] = {4, {{10,1,10,8}, {10,9,10,16}, {0,1,0,8}, {1,9,9,9}}},
+    ['5'] = {5, {{10,9,10,16}, {0,1,0,8}, {1,0,9,0}, {1,9,9,9}, {1,17,9,17}}},
+    ['6'] = {6, {{10,9,10,16}, {0,1,0,8}, {0,9,0,16}, {1,0,9,0}, {1,9,9,9}, {1,17,9,17}}},
+    ['7'] = {3, {{10,1,10,8}, {10,9,10,16}, {1,0,9,0}}},
+    ['8'] = {7, {{10,1,10,8}, {10,9,10,16}, {0,1,0,8}, {0,9,0,16}, {1,0,9,0}, {1,9,9,9}, {1,17,9,17}}},
+    ['9'] = {6, {{10,1,10,8}, {10,9,10,16}, {0,1,0,8}, {1,0,9,0}, {1,9,9,9}, {1,17,9,17}}},
+    ['A'] = {4, {{10,0,10,17}, {0,0,0,17}, {1,0,9,0}, {1,9,9,9}}},
+    ['B'] = {6, {{10,1,10,8}, {10,9,10,16}, {0,0,0,17}, {0,0,9,0}, {1,9,9,9}, {1,17,10,17}}},
+    ['C'] = {3, {{0,0,0,16}, {1,0,9,0}, {1,17,9,17}}},
+    ['D'] = {4, {{10,0,10,16}, {0,0,0,17}, {1,0,9,0}, {1,17,9,17}}},
+    ['E'] = {4, {{0,0,0,17}, {1,0,9,0}, {1,9,9,9}, {1,17,9,17}}},
+    ['F'] = {3, {{0,0,0,17}, {1,0,9,0}, {1,9,9,9}}},
+    ['G'] = {5, {{10,9,10,16}, {0,0,0,16}, {1,0,9,0}, {7,9,9,9}, {1,17,9,17}}},
+    ['H'] = {3, {{10,0,10,17}, {0,0,0,17}, {1,9,9,9}}},
+    ['I'] = {3, {{5,0,5,17}, {1,0,9,0}, {1,17,9,17}}},
+    ['J'] = {9, {{10,1,10,8}, {10,9,10,16}, {10,0,10,17}, {0,1,0,8}, {0,9,0,16}, {0,0,0,17}, {1,0,9,0}, {1,9,9,9}, {1,17,9,17}}},
+    ['K'] = {3, {{1,8,10,1}, {1,9,10,16}, {0,0,0,17}}},
+    ['L'] = {2, {{0,0,0,17}, {1,17,9,17}}},
+    ['M'] = {4, {{0,17,3,0}, {3,0,5,17}, {5,17,8,0}, {8,0,10,17}}},
+    ['N'] = {3, {{10,0,10,17}, {0,0,0,17}, {0,0,10,17}}},
+    ['O'] = {4, {{10,0,10,17}, {0,0,0,17}, {1,0,9,0}, {1,17,9,17}}},
+    ['P'] = {4, {{10,1,10,8}, {0,0,0,17}, {1,0,9,0}, {1,9,9,9}}},
+    ['Q'] = {5, {{10,0,10,17}, {0,0,0,16}, {1,0,9,0}, {1,17,9,17}, {5,9,11,18}}},
+    ['R'] = {5, {{10,1,10,8}, {10,9,10,17}, {0,0,0,17}, {1,0,9,0}, {1,9,9,9}}},
+    ['S'] = {5, {{10,9,10,16}, {0,1,0,8}, {1,0,9,0}, {1,9,9,9}, {1,17,9,17}}},
+    ['T'] = {2, {{5,0,5,17}, {0,0,10,0}}},
+    ['U'] = {3, {{10,0,10,17}, {0,0,0,16}, {1,17,9,17}}},
+    ['V'] = {2, {{0,0,5,17}, {5,17,10,0}}},
+    ['W'] = {4, {{0,0,3,17}, {3,17,5,0}, {5,0,8,17}, {8,17,10,0}}},
+    ['X'] = {2, {{0,0,10,17}, {0,17,10,0}}},
+    ['Y'] = {3, {{0,0,5,8}, {5,8,10,0}, {5,9,5,16}}},
+    ['Z'] = {3, {{0,17,10,0}, {1,0,9,0}, {1,17,9,17}}},
+    ['.'] = {1, {{0,15,0,17}}},
+    ['!'] = {2, {{5,1,5,12}, {5,15,5,17}}},
+};
+
+const glyph *findGlyph(char ltr)
+{
+    //returns the lines for a character, or NULL if it has none (like a space)
+    //the numbers 0 to 9 (not just '0' to '9') are accepted too, as the HUD used to print digits that way
+    if(ltr >= 0 && ltr <= 9)
+    {
+        ltr += '0';
+    }
+    else if(ltr >= 'a' && ltr <= 'z')
+    {
+        ltr += 'A' - 'a';
+    }
+    if(ltr < 0 || glyphs[(int)ltr].count == 0)
+    {
+        return NULL;
+    }
+    return &glyphs[(int)ltr];
+}
+
+static int countText(const char *text, int length)
+{
+    //number of line vertices a string needs
+    int i, n = 0;
+    for(i = 0; i < length; i++)
+    {
+        const glyph *gl = findGlyph(text[i]);
+        if(gl != NULL)
+        {
+            n += gl->count * 2;
+        }
+    }
+    return n;
+}
+static void writeText(vertex *v, const char *text, int length, double xPos, double yPos, double spacing,
+                      unsigned char r, unsigned char g, unsigned char b)
+{
+    //fills in the line vertices for a string, one character every spacing pixels to the right
+    int i, j;
+    for(i = 0; i < length; i++)
+    {
+        const glyph *gl = findGlyph(text[i]);
+        if(gl == NULL)
+        {
+            continue;
+        }
+        for(j = 0; j < gl->count * 2; j++, v++)
+        {
+            v->x = xPos + i * spacing + gl->seg[j / 2][(j % 2) * 2];
+            v->y = yPos - gl->seg[j / 2][(j % 2) * 2 + 1];
+            v->r = r;
+            v->g = g;
+            v->b = b;
+            v->a = 255;
+        }
+    }
+}
+
+void printLetter(drawList *dl, char ltr, double xPos, double yPos)
+{
+    //function to print a letter to screen, as lines added to the draw list, based on letter, and possition perameters
+    printText(dl, &ltr, 1, xPos, yPos, 0);
+}
+void printText(drawList *dl, const char *text, int length, double xPos, double yPos, double spacing)
+{
+    //lays out a whole string into the draw list in the current colour
+    vertex *v = vertexListAdd(&dl->lines, countText(text, length));
+    if(v != NULL)
+    {
+        writeText(v, text, length, xPos, yPos, spacing, dl->r, dl->g, dl->b);
+    }
+}
+
+void initHudText(hudText *h)
+{
+    h->length = -1; //nothing cached yet
+    h->verts.v = NULL;
+    h->verts.count = 0;
+    h->verts.capacity = 0;
+}
+void freeHudText(hudText *h)
+{
+    free(h->verts.v);
+    initHudText(h);
+}
+void printHudText(drawList *dl, hudText *h, const char *text, int length, double xPos, double yPos, double spacing)
+{
+    //like printText(), but only lays the string out again if it, its position or its colour has changed
+    //otherwise the cached vertices are just copied into the draw list
+    if(length > HUDTEXTMAX)
+    {
+        length = HUDTEXTMAX;
+    }
+    if(length != h->length || memcmp(text, h->text, length) != 0 || xPos != h->x || yPos != h->y ||
+       spacing != h->spacing || dl->r != h->r || dl->g != h->g || dl->b != h->b)
+    {
+        memcpy(h->text, text, length);
+        h->length = length;
+        h->x = xPos;
+        h->y = yPos;
+        h->spacing = spacing;
+        h->r = dl->r;
+        h->g = dl->g;
+        h->b = dl->b;
+        h->verts.count = 0;
+
+        vertex *v = vertexListAdd(&h->verts, countText(text, length));
+        if(v == NULL)
+        {
+            h->length = -1;
+            return;
+        }
+        writeText(v, text, length, xPos, yPos, spacing, h->r, h->g, h->b);
+    }
+
+    vertex *v = vertexListAdd(&dl->lines, h->verts.count);
+    if(v != NULL)
+    {
+        memcpy(v, h->verts.v, sizeof(vertex) * h->verts.count);
+    }
+}
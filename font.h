@@ -0,0 +1,38 @@
+#ifndef FONT_H
+#define FONT_H
+//the game's line font: every character is a few straight lines inside a 10x17 box
+//whole strings are laid out into a draw list in one go, and HUD strings are cached until they change
+#include "drawlist.h"
+
+//the most lines any character needs (J)
+#define MAXGLYPHSEGS 9
+//longest string a hudText can cache
+#define HUDTEXTMAX 32
+
+typedef struct
+{
+    //the lines making up one character
+    //each line is x1, down1, x2, down2, measured right and down from the character's top left corner
+    unsigned char count;
+    unsigned char seg[MAXGLYPHSEGS][4];
+}glyph;
+
+typedef struct
+{
+    //a HUD string and the vertices it was last laid out into, reused while nothing about it changes
+    char text[HUDTEXTMAX];
+    int length;
+    double x, y, spacing;
+    unsigned char r, g, b;
+    vertexList verts;
+}hudText;
+
+const glyph *findGlyph(char ltr);
+void printLetter(drawList *dl, char ltr, double xPos, double yPos);
+void printText(drawList *dl, const char *text, int length, double xPos, double yPos, double spacing);
+
+void initHudText(hudText *h);
+void freeHudText(hudText *h);
+void printHudText(drawList *dl, hudText *h, const char *text, int length, double xPos, double yPos, double spacing);
+
+#endif
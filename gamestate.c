@@ -0,0 +1,92 @@
+//saving and restoring games, see gamestate.h
+#include <stdlib.h>
+#include "gamestate.h"
+
+void saveGameState(gameState *s, const taxi *t, const level *lvl)
+{
+    s->t = *t;
+    s->rng = lvl->rng;
+    s->gameTime = lvl->gameTime;
+    s->currentTimeSecs = lvl->currentTimeSecs;
+    s->isRaining = lvl->isRaining;
+    s->customerWaiting = lvl->customerWaiting;
+    s->levelCustomerCurrentNumber = lvl->levelCustomerCurrentNumber;
+    s->currentCustomer = lvl->currentCustomer;
+}
+int loadGameState(const gameState *s, taxi *t, level *lvl)
+{
+    //puts the game back how it was when the state was saved, the level has to be the one it was saved on
+    //returns 0 (and changes nothing) if the taxi has moved on to another level since
+    if(s->t.levelCurrent != t->levelCurrent)
+    {
+        return 0;
+    }
+    *t = s->t;
+    lvl->rng = s->rng;
+    lvl->gameTime = s->gameTime;
+    lvl->currentTimeSecs = s->currentTimeSecs;
+    lvl->isRaining = s->isRaining;
+    lvl->customerWaiting = s->customerWaiting;
+    lvl->levelCustomerCurrentNumber = s->levelCustomerCurrentNumber;
+    lvl->currentCustomer = s->currentCustomer;
+    return 1;
+}
+
+int initStateRing(stateRing *r, int capacity)
+{
+    //room for capacity states, returns 0 if out of memory
+    r->capacity = capacity > 1 ? capacity : 1;
+    r->states = malloc(sizeof(gameState) * r->capacity);
+    clearStateRing(r);
+    return r->states != NULL;
+}
+void freeStateRing(stateRing *r)
+{
+    free(r->states);
+    r->states = NULL;
+    r->capacity = 0;
+    clearStateRing(r);
+}
+void clearStateRing(stateRing *r)
+{
+    //forgets every state, for a new level (rewinding can't go back past one)
+    r->count = 0;
+    r->newest = -1;
+}
+void pushState(stateRing *r, const taxi *t, const level *lvl)
+{
+    //saves the game as the newest state, in place of the oldest if the ring is full
+    if(r->states == NULL)
+    {
+        return;
+    }
+    r->newest = (r->newest + 1) % r->capacity;
+    saveGameState(&r->states[r->newest], t, lvl);
+    if(r->count < r->capacity)
+    {
+        r->count++;
+    }
+}
+int rewindStates(stateRing *r, int steps, taxi *t, level *lvl)
+{
+    //puts the game back to the state saved steps pushes ago (or the oldest, if there aren't that many),
+    //which becomes the newest, returns how many steps it went back
+    //(the states after it are dropped, playing on from there pushes new ones in their place)
+    if(r->count == 0)
+    {
+        return 0;
+    }
+    if(steps > r->count - 1)
+    {
+        steps = r->count - 1;
+    }
+    int index = (r->newest - steps + r->capacity) % r->capacity;
+    if(loadGameState(&r->states[index], t, lvl) == 0)
+    {
+        clearStateRing(r);
+        return 0;
+    }
+    r->newest = index;
+    r->count -= steps;
+    return steps;
+}
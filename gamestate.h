@@ -0,0 +1,46 @@
+#ifndef GAMESTATE_H
+#define GAMESTATE_H
+//saving and restoring the state of a game, for rewinding and restarting instantly in practice mode
+//a level's lines, pads and collision grid never change while it's played, so a saved state is only
+//the parts that do: the taxi, the random number generator, the clock and the customer
+//(not the hundreds of customers waiting in a cavern, see dispatch.h, so practice mode is only for the level pack's levels)
+//it's a plain struct a few hundred bytes big, so saving and restoring one is a copy, and a ring of them
+//(one per step) is allocated once so rewinding never allocates
+#include "spacetaxi.h"
+
+//how far back the rewind key can go
+#define REWINDSECONDS 10.0
+//how far back one press of it goes
+#define REWINDSTEP    1.0
+
+typedef struct
+{
+    //everything in a game that changes as it's played
+    taxi t;
+    pcg32 rng;
+    double gameTime;
+    int currentTimeSecs;
+    char isRaining;
+    char customerWaiting;
+    int levelCustomerCurrentNumber;
+    customer currentCustomer;
+}gameState;
+
+typedef struct
+{
+    //the states after the last few steps, overwriting the oldest once it's full
+    gameState *states;
+    int capacity;
+    int count;  //states held
+    int newest; //where the newest one is
+}stateRing;
+
+void saveGameState(gameState *s, const taxi *t, const level *lvl);
+int loadGameState(const gameState *s, taxi *t, level *lvl);
+int initStateRing(stateRing *r, int capacity);
+void freeStateRing(stateRing *r);
+void clearStateRing(stateRing *r);
+void pushState(stateRing *r, const taxi *t, const level *lvl);
+int rewindStates(stateRing *r, int steps, taxi *t, level *lvl);
+
+#endif
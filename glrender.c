@@ -0,0 +1,327 @@
+//the OpenGL backend: drawing draw lists with vertex buffers
+//the level's boundary lines are uploaded a chunk at a time as the camera comes to them,
+//everything else is streamed through one buffer per frame
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include "glrender.h"
+#include <GL/glu.h>
+
+static void setVertexPointers(void)
+{
+    //points the fixed function vertex and colour arrays at the vertex layout in the bound buffer
+    glVertexPointer(2, GL_FLOAT, sizeof(vertex), (void *)offsetof(vertex, x));
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(vertex), (void *)offsetof(vertex, r));
+}
+static int hasBufferStorage(void)
+{
+    //persistent mapping needs OpenGL 4.4, or the GL_ARB_buffer_storage extension
+    int major = 0, minor = 0;
+    const char *version = (const char *)glGetString(GL_VERSION);
+    const char *extensions = (const char *)glGetString(GL_EXTENSIONS);
+
+    if(version != NULL && sscanf(version, "%d.%d", &major, &minor) == 2)
+    {
+        if(major > 4 || (major == 4 && minor >= 4))
+        {
+            return 1;
+        }
+    }
+    return extensions != NULL && strstr(extensions, "GL_ARB_buffer_storage") != NULL;
+}
+
+void uploadMesh(staticMesh *m, const drawList *dl)
+{
+    //copies the draw list into the mesh's vertex buffer, lines first then triangles
+    GLsizeiptr lineBytes = sizeof(vertex) * dl->lines.count;
+    GLsizeiptr triBytes = sizeof(vertex) * dl->tris.count;
+
+    if(m->vbo == 0)
+    {
+        glGenBuffers(1, &m->vbo);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, m->vbo);
+    glBufferData(GL_ARRAY_BUFFER, lineBytes + triBytes, NULL, GL_STATIC_DRAW);
+    if(lineBytes > 0)
+    {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, lineBytes, dl->lines.v);
+    }
+    if(triBytes > 0)
+    {
+        glBufferSubData(GL_ARRAY_BUFFER, lineBytes, triBytes, dl->tris.v);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    m->numLines = dl->lines.count;
+    m->numTris = dl->tris.count;
+}
+void drawMesh(const staticMesh *m)
+{
+    //one draw call for the lines and one for the triangles
+    if(m->vbo == 0 || m->numLines + m->numTris == 0)
+    {
+        return;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, m->vbo);
+    setVertexPointers();
+    if(m->numLines > 0)
+    {
+        glDrawArrays(GL_LINES, 0, m->numLines);
+    }
+    if(m->numTris > 0)
+    {
+        glDrawArrays(GL_TRIANGLES, m->numLines, m->numTris);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+void freeMesh(staticMesh *m)
+{
+    if(m->vbo != 0)
+    {
+        glDeleteBuffers(1, &m->vbo);
+    }
+    m->vbo = 0;
+    m->numLines = 0;
+    m->numTris = 0;
+}
+
+int initStream(streamBuffer *s, int regionSize)
+{
+    //creates the streaming buffer, persistently mapped if the driver supports it
+    //returns 1 if persistently mapped, 0 if it falls back to glBufferSubData
+    int i;
+    GLsizeiptr bytes = (GLsizeiptr)sizeof(vertex) * regionSize * STREAMREGIONS;
+
+    s->regionSize = regionSize;
+    s->region = 0;
+    s->mapped = NULL;
+    for(i = 0; i < STREAMREGIONS; i++)
+    {
+        s->fences[i] = 0;
+    }
+
+    glGenBuffers(1, &s->vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, s->vbo);
+    if(hasBufferStorage())
+    {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, bytes, NULL, flags);
+        s->mapped = glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes, flags);
+    }
+    if(s->mapped == NULL)
+    {
+        //older drivers: a normal buffer, refilled with glBufferSubData each frame
+        glDeleteBuffers(1, &s->vbo);
+        glGenBuffers(1, &s->vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, s->vbo);
+        glBufferData(GL_ARRAY_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return s->mapped != NULL;
+}
+void drawStream(streamBuffer *s, const drawList *dl)
+{
+    //copies the draw list into the next region of the buffer and draws it with two draw calls
+    int numLines = dl->lines.count;
+    int numTris = dl->tris.count;
+    int total = numLines + numTris;
+
+    if(total == 0)
+    {
+        return;
+    }
+    if(total > s->regionSize)
+    {
+        //a frame bigger than a region: start again with regions twice as big as needed
+        freeStream(s);
+        initStream(s, total * 2);
+    }
+
+    int first = s->region * s->regionSize;
+    glBindBuffer(GL_ARRAY_BUFFER, s->vbo);
+    if(s->mapped != NULL)
+    {
+        //waits (normally not at all) for the GPU to finish with this region from STREAMFRAMES frames ago
+        if(s->fences[s->region] != 0)
+        {
+            glClientWaitSync(s->fences[s->region], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+            glDeleteSync(s->fences[s->region]);
+            s->fences[s->region] = 0;
+        }
+        memcpy(s->mapped + first, dl->lines.v, sizeof(vertex) * numLines);
+        memcpy(s->mapped + first + numLines, dl->tris.v, sizeof(vertex) * numTris);
+    }
+    else
+    {
+        glBufferSubData(GL_ARRAY_BUFFER, sizeof(vertex) * first, sizeof(vertex) * numLines, dl->lines.v);
+        glBufferSubData(GL_ARRAY_BUFFER, sizeof(vertex) * (first + numLines), sizeof(vertex) * numTris, dl->tris.v);
+    }
+
+    setVertexPointers();
+    if(numLines > 0)
+    {
+        glDrawArrays(GL_LINES, first, numLines);
+    }
+    if(numTris > 0)
+    {
+        glDrawArrays(GL_TRIANGLES, first + numLines, numTris);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if(s->mapped != NULL)
+    {
+        s->fences[s->region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    s->region = (s->region + 1) % STREAMREGIONS;
+}
+void freeStream(streamBuffer *s)
+{
+    int i;
+    for(i = 0; i < STREAMREGIONS; i++)
+    {
+        if(s->fences[i] != 0)
+        {
+            glDeleteSync(s->fences[i]);
+            s->fences[i] = 0;
+        }
+    }
+    if(s->mapped != NULL)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, s->vbo);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        s->mapped = NULL;
+    }
+    glDeleteBuffers(1, &s->vbo);
+    s->vbo = 0;
+}
+
+void setupView(int windowWidth, int windowHeight)
+{
+    //sets up the GL state that stays the same for every frame, and a camera showing the whole window
+    /*//////////////////////////////////////////////////*/
+    /* Set up the parts of the scene that will stay the same for every frame. */
+    glFrontFace(GL_CCW);     /* Enforce counter clockwise face ordering (to determine front and back side) */
+    glEnable(GL_NORMALIZE);
+	glShadeModel(GL_FLAT); /* enable flat shading - Gouraud shading would be GL_SMOOTH */
+
+
+    glEnable(GL_DEPTH_TEST);
+
+    /* Set the clear (background) colour */
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+
+    /* Set up the camera/viewing volume (projection matrix) and the timer */
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    gluOrtho2D(0.0, (GLdouble)(windowWidth-1),0.0,(GLdouble)(windowHeight-1));
+    glViewport(0,0,windowWidth,windowHeight);
+    /*//////////////////////////////////////////////////*/
+}
+static void beginGLFrame(void *target)
+{
+    glTarget *g = target;
+    glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+    glMatrixMode(GL_MODELVIEW);
+    g->frameNumber++;
+}
+static void drawGLScreen(void *target, const drawList *dl)
+{
+    glTarget *g = target;
+    glLoadIdentity();
+    drawStream(&g->stream, dl);
+}
+static void drawGLChunk(void *target, int chunk, const drawList *lines, double camX, double camY)
+{
+    //draws a chunk's boundary lines from its vertex buffer, uploading them first if they aren't uploaded already
+    //in place of whichever chunk was drawn longest ago
+    glTarget *g = target;
+    chunkMesh *m = NULL;
+    chunkMesh *oldest = &g->meshes[0];
+    int j;
+
+    for(j = 0; j < CHUNKMESHES && m == NULL; j++)
+    {
+        if(g->meshes[j].chunk == chunk)
+        {
+            m = &g->meshes[j];
+        }
+        else if(g->meshes[j].lastDrawn < oldest->lastDrawn)
+        {
+            oldest = &g->meshes[j];
+        }
+    }
+    if(m == NULL)
+    {
+        m = oldest;
+        m->chunk = chunk;
+        uploadMesh(&m->mesh, lines);
+        g->uploads++;
+    }
+    m->lastDrawn = g->frameNumber;
+    glLoadIdentity();
+    glTranslated(-camX, -camY, 0.0);
+    drawMesh(&m->mesh);
+}
+static void drawGLLevel(void *target, const drawList *dl, double camX, double camY)
+{
+    glTarget *g = target;
+    glLoadIdentity();
+    glTranslated(-camX, -camY, 0.0);
+    drawStream(&g->stream, dl);
+}
+static void endGLFrame(void *target)
+{
+    //print it to screen
+    (void)target;
+    glFlush();
+}
+static void newGLLevel(void *target)
+{
+    //none of the uploaded chunks are any use
+    glTarget *g = target;
+    int i;
+    for(i = 0; i < CHUNKMESHES; i++)
+    {
+        g->meshes[i].chunk = -1;
+        g->meshes[i].lastDrawn = -1;
+    }
+}
+void useGLBackend(renderer *r, glTarget *g)
+{
+    //sets up the vertex buffers and draws the renderer's frames with them, needs the GL context to be current
+    //(with the depth test on from setupView(), whatever is drawn first at a pixel stays on top, as render() expects)
+    int i;
+    for(i = 0; i < CHUNKMESHES; i++)
+    {
+        g->meshes[i].chunk = -1;
+        g->meshes[i].lastDrawn = -1;
+        g->meshes[i].mesh.vbo = 0;
+        g->meshes[i].mesh.numLines = 0;
+        g->meshes[i].mesh.numTris = 0;
+    }
+    g->frameNumber = 0;
+    g->uploads = 0;
+    initStream(&g->stream, STREAMREGIONSIZE);
+
+    //every draw uses vertex and colour arrays
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+
+    r->backend.target = g;
+    r->backend.begin = beginGLFrame;
+    r->backend.drawScreen = drawGLScreen;
+    r->backend.drawChunk = drawGLChunk;
+    r->backend.drawLevel = drawGLLevel;
+    r->backend.end = endGLFrame;
+    r->backend.newLevel = newGLLevel;
+}
+void freeGLTarget(glTarget *g)
+{
+    int i;
+    freeStream(&g->stream);
+    for(i = 0; i < CHUNKMESHES; i++)
+    {
+        freeMesh(&g->meshes[i].mesh);
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef GLRENDER_H
+#define GLRENDER_H
+//the OpenGL backend for render.h: drawing draw lists with vertex buffers instead of one glBegin/glEnd per line
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include "spacetaxi.h"
+#include "drawlist.h"
+#include "render.h"
+
+//draw lists streamed each frame (the screen list and the frame list, see render())
+#define STREAMLISTS 2
+//frames the GPU can be behind the CPU before filling a region waits for it
+#define STREAMFRAMES 3
+//number of regions the streaming buffer is split into, one per list per frame in flight,
+//so the CPU can fill one while the GPU draws the others
+#define STREAMREGIONS (STREAMLISTS * STREAMFRAMES)
+//starting size of each region, in vertices (it grows if a frame needs more)
+#define STREAMREGIONSIZE 16384
+
+typedef struct
+{
+    //vertices uploaded once into a vertex buffer object, for geometry that doesn't change
+    GLuint vbo;
+    int numLines; //number of line vertices, stored first
+    int numTris;  //number of triangle vertices, stored after the lines
+}staticMesh;
+
+//chunks of the level kept uploaded, when another is needed it replaces the one drawn longest ago
+#define CHUNKMESHES 64
+
+typedef struct
+{
+    //a chunk of the level (see camera.h) uploaded into a vertex buffer
+    int chunk;     //which chunk, or -1 if none
+    int lastDrawn; //the frame it was last drawn in
+    staticMesh mesh;
+}chunkMesh;
+
+typedef struct
+{
+    //one vertex buffer that each frame's draw list is copied into, a region at a time
+    GLuint vbo;
+    vertex *mapped;   //the whole buffer, persistently mapped, or NULL if the driver can't do that
+    int regionSize;   //number of vertices in each region
+    int region;       //the region to fill next
+    GLsync fences[STREAMREGIONS]; //set when the GPU has finished drawing from each region
+}streamBuffer;
+
+typedef struct
+{
+    //what the OpenGL backend keeps between frames
+    chunkMesh meshes[CHUNKMESHES];
+    int frameNumber;
+    int uploads;         //chunks uploaded so far
+    streamBuffer stream;
+}glTarget;
+
+void uploadMesh(staticMesh *m, const drawList *dl);
+void drawMesh(const staticMesh *m);
+void freeMesh(staticMesh *m);
+
+int initStream(streamBuffer *s, int regionSize);
+void drawStream(streamBuffer *s, const drawList *dl);
+void freeStream(streamBuffer *s);
+
+void setupView(int windowWidth, int windowHeight);
+void useGLBackend(renderer *r, glTarget *g);
+void freeGLTarget(glTarget *g);
+
+#endif
@@ -0,0 +1,241 @@
+//uniform grid over a level's line segments, the broadphase for the taxi's collision checks
+//doEvents asks the grid for the segments near the box swept along the taxi's move, and only sweeps those with sweepBBxL()
+#include <stdlib.h>
+#include <math.h>
+#include "spacetaxi.h"
+
+lseg levelSegment(const level *lvl, int id)
+{
+    //the level's line segments by grid id: the platforms first, then the boundary lines
+    if(id < lvl->numplatforms)
+    {
+        return lvl->platforms[id].l;
+    }
+    return lvl->bounds[id - lvl->numplatforms];
+}
+static int cellCol(const segGrid *g, double x)
+{
+    //the column a coordinate falls in, kept inside the grid
+    int c = (int)floor((x - g->x) / g->cellSize);
+    if(c < 0)
+    {
+        return 0;
+    }
+    if(c >= g->cols)
+    {
+        return g->cols - 1;
+    }
+    return c;
+}
+static int cellRow(const segGrid *g, double y)
+{
+    int r = (int)floor((y - g->y) / g->cellSize);
+    if(r < 0)
+    {
+        return 0;
+    }
+    if(r >= g->rows)
+    {
+        return g->rows - 1;
+    }
+    return r;
+}
+
+void initialiseGrid(segGrid *g)
+{
+    //an empty grid, with nothing allocated
+    g->x = 0;
+    g->y = 0;
+    g->cellSize = GRIDCELLSIZE;
+    g->cols = 0;
+    g->rows = 0;
+    g->cellStart = NULL;
+    g->items = NULL;
+    g->segCol = NULL;
+    g->segRow = NULL;
+    g->numPads = 0;
+    g->numBounds = 0;
+}
+void freeGrid(segGrid *g)
+{
+    free(g->cellStart);
+    free(g->items);
+    free(g->segCol); //segRow is the second half of the same block
+    initialiseGrid(g);
+}
+static int segmentInArea(lseg l, const bbox *area)
+{
+    //if a segment's bounding box overlaps the area (everything is in no area)
+    return area == NULL || (fmax(l.x1, l.x2) >= area->x1 && fmin(l.x1, l.x2) <= area->x2
+        && fmax(l.y1, l.y2) >= area->y1 && fmin(l.y1, l.y2) <= area->y2);
+}
+void buildLevelGrid(level *lvl)
+{
+    //(re)builds the level's collision grid, call once the level's platforms and boundary lines are all added
+    buildLevelGridArea(lvl, NULL);
+}
+void buildLevelGridArea(level *lvl, const bbox *area)
+{
+    //builds the grid over only the segments in an area, for huge levels where the taxi can't leave the area
+    //before the grid is built again (segments outside it are never found by a query)
+    //if memory runs out the grid is left empty, and doEvents goes back to checking every segment
+    segGrid *g = &lvl->grid;
+    int n = lvl->numplatforms + lvl->numbounds;
+    int i, c, r, inArea = 0;
+    double minX = 0, minY = 0, maxX = 0, maxY = 0;
+    lseg l;
+
+    freeGrid(g);
+
+    //the grid covers the area all the segments are in
+    for(i = 0; i < n; i++)
+    {
+        l = levelSegment(lvl, i);
+        if(!segmentInArea(l, area))
+        {
+            continue;
+        }
+        if(inArea == 0)
+        {
+            minX = maxX = l.x1;
+            minY = maxY = l.y1;
+        }
+        inArea++;
+        minX = fmin(minX, fmin(l.x1, l.x2));
+        maxX = fmax(maxX, fmax(l.x1, l.x2));
+        minY = fmin(minY, fmin(l.y1, l.y2));
+        maxY = fmax(maxY, fmax(l.y1, l.y2));
+    }
+    if(inArea == 0)
+    {
+        //nothing to collide with
+        g->numPads = lvl->numplatforms;
+        g->numBounds = lvl->numbounds;
+        return;
+    }
+
+    //bigger cells for huge sparse levels, so the grid stays about the size of the segment list
+    g->x = minX;
+    g->y = minY;
+    g->cellSize = GRIDCELLSIZE;
+    while(((maxX - minX) / g->cellSize + 1) * ((maxY - minY) / g->cellSize + 1) > 4.0 * inArea + 1024)
+    {
+        g->cellSize *= 2;
+    }
+    g->cols = (int)((maxX - minX) / g->cellSize) + 1;
+    g->rows = (int)((maxY - minY) / g->cellSize) + 1;
+
+    int cells = g->cols * g->rows;
+    g->cellStart = calloc(cells + 1, sizeof(int));
+    g->segCol = malloc(sizeof(int) * n * 2);
+    int *fill = malloc(sizeof(int) * cells);
+    if(g->cellStart == NULL || g->segCol == NULL || fill == NULL)
+    {
+        free(fill);
+        freeGrid(g);
+        return;
+    }
+    g->segRow = g->segCol + n;
+
+    //first count how many segments overlap each cell (using the segment's bounding box)...
+    for(i = 0; i < n; i++)
+    {
+        l = levelSegment(lvl, i);
+        if(!segmentInArea(l, area))
+        {
+            continue;
+        }
+        g->segCol[i] = cellCol(g, fmin(l.x1, l.x2));
+        g->segRow[i] = cellRow(g, fmin(l.y1, l.y2));
+        int lastCol = cellCol(g, fmax(l.x1, l.x2));
+        int lastRow = cellRow(g, fmax(l.y1, l.y2));
+        for(r = g->segRow[i]; r <= lastRow; r++)
+        {
+            for(c = g->segCol[i]; c <= lastCol; c++)
+            {
+                g->cellStart[r * g->cols + c + 1]++;
+            }
+        }
+    }
+    //...then turn the counts into offsets and put each segment id in its cells
+    for(c = 0; c < cells; c++)
+    {
+        g->cellStart[c + 1] += g->cellStart[c];
+        fill[c] = g->cellStart[c];
+    }
+    g->items = malloc(sizeof(int) * (g->cellStart[cells] > 0 ? g->cellStart[cells] : 1));
+    if(g->items == NULL)
+    {
+        free(fill);
+        freeGrid(g);
+        return;
+    }
+    for(i = 0; i < n; i++)
+    {
+        l = levelSegment(lvl, i);
+        if(!segmentInArea(l, area))
+        {
+            continue;
+        }
+        int lastCol = cellCol(g, fmax(l.x1, l.x2));
+        int lastRow = cellRow(g, fmax(l.y1, l.y2));
+        for(r = g->segRow[i]; r <= lastRow; r++)
+        {
+            for(c = g->segCol[i]; c <= lastCol; c++)
+            {
+                g->items[fill[r * g->cols + c]++] = i;
+            }
+        }
+    }
+    free(fill);
+
+    g->numPads = lvl->numplatforms;
+    g->numBounds = lvl->numbounds;
+}
+int gridQuery(const segGrid *g, bbox b, int *found, int maxFound)
+{
+    //fills found with the ids of the segments whose cells overlap the bounding box, in increasing order
+    //returns how many were found, or -1 if there were more than maxFound
+    int numFound = 0;
+    int c, r, k;
+
+    if(g->cellStart == NULL || b.x2 < g->x || b.y2 < g->y
+        || b.x1 > g->x + g->cols * g->cellSize || b.y1 > g->y + g->rows * g->cellSize)
+    {
+        return 0;
+    }
+    int firstCol = cellCol(g, b.x1), lastCol = cellCol(g, b.x2);
+    int firstRow = cellRow(g, b.y1), lastRow = cellRow(g, b.y2);
+
+    for(r = firstRow; r <= lastRow; r++)
+    {
+        for(c = firstCol; c <= lastCol; c++)
+        {
+            int cell = r * g->cols + c;
+            for(k = g->cellStart[cell]; k < g->cellStart[cell + 1]; k++)
+            {
+                int id = g->items[k];
+                //a segment in several of these cells is only taken from the first one both cover
+                int ownCol = g->segCol[id] > firstCol ? g->segCol[id] : firstCol;
+                int ownRow = g->segRow[id] > firstRow ? g->segRow[id] : firstRow;
+                if(ownCol != c || ownRow != r)
+                {
+                    continue;
+                }
+                if(numFound == maxFound)
+                {
+                    return -1;
+                }
+                //insertion sort, there are only ever a few
+                int j = numFound++;
+                while(j > 0 && found[j - 1] > id)
+                {
+                    found[j] = found[j - 1];
+                    j--;
+                }
+                found[j] = id;
+            }
+        }
+    }
+    return numFound;
+}
@@ -0,0 +1,60 @@
+//the triple buffer and input queue, see handoff.h
+#include "handoff.h"
+
+void initTripleBuffer(tripleBuffer *tb)
+{
+    //the reader starts with slot 0, so fill that in before any thread starts
+    tb->front = 0;
+    tb->back = 1;
+    atomic_init(&tb->middle, 2);
+}
+int tripleBufferPublish(tripleBuffer *tb)
+{
+    //hands the writer's filled slot to the reader by swapping it with the spare one
+    //returns the slot the writer should fill next
+    int old = atomic_exchange_explicit(&tb->middle, tb->back | TRIPLENEW, memory_order_acq_rel);
+    tb->back = old & ~TRIPLENEW;
+    return tb->back;
+}
+int tripleBufferLatest(tripleBuffer *tb)
+{
+    //returns the reader's slot, swapped for the newest published one if there is one
+    //the slot stays the reader's, unchanged, until the next call
+    if(atomic_load_explicit(&tb->middle, memory_order_relaxed) & TRIPLENEW)
+    {
+        int old = atomic_exchange_explicit(&tb->middle, tb->front, memory_order_acq_rel);
+        tb->front = old & ~TRIPLENEW;
+    }
+    return tb->front;
+}
+
+void initInputQueue(inputQueue *q)
+{
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+}
+int inputQueuePush(inputQueue *q, int type, int value)
+{
+    //adds an event, returns 0 if the queue was full and the event was dropped
+    unsigned int tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    if(tail - atomic_load_explicit(&q->head, memory_order_acquire) >= INPUTQUEUESIZE)
+    {
+        return 0;
+    }
+    q->events[tail % INPUTQUEUESIZE].type = type;
+    q->events[tail % INPUTQUEUESIZE].value = value;
+    atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+    return 1;
+}
+int inputQueuePop(inputQueue *q, inputEvent *e)
+{
+    //takes the oldest event, returns 0 if there were none
+    unsigned int head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    if(head == atomic_load_explicit(&q->tail, memory_order_acquire))
+    {
+        return 0;
+    }
+    *e = q->events[head % INPUTQUEUESIZE];
+    atomic_store_explicit(&q->head, head + 1, memory_order_release);
+    return 1;
+}
@@ -0,0 +1,54 @@
+#ifndef HANDOFF_H
+#define HANDOFF_H
+//passing data between the simulation thread and the main (render) thread without locks
+//a triple buffer for the latest game state, and a single producer/single consumer queue for key presses
+#include <stdatomic.h>
+
+typedef struct
+{
+    //three slots for a writer and a reader that each hold one, plus a spare one to swap through
+    //the slots themselves are an array kept by the caller, this only hands out which index each side uses
+    //the writer fills its slot and publishes it, the reader always gets the newest published slot,
+    //and neither ever waits for the other
+    int back;           //the writer's slot
+    int front;          //the reader's slot
+    atomic_int middle;  //the spare slot, with TRIPLENEW set if it holds something the reader hasn't seen
+}tripleBuffer;
+
+#define TRIPLENEW 4
+
+void initTripleBuffer(tripleBuffer *tb);
+int tripleBufferPublish(tripleBuffer *tb);
+int tripleBufferLatest(tripleBuffer *tb);
+
+//what an inputEvent is for
+#define INPUTVTHRUST 0 //value is the vertical thrust wanted, 0 or 1
+#define INPUTHTHRUST 1 //value is the horizontal thrust wanted, -1, 0 or 1
+#define INPUTWHEELS  2 //raise or lower the landing wheels
+#define INPUTPAUSE   3 //pause or unpause the game
+#define INPUTREWIND  4 //go back REWINDSTEP seconds, in practice mode
+
+typedef struct
+{
+    //a change to the controls, from the main thread's key events
+    int type;
+    int value;
+}inputEvent;
+
+//the most events waiting at once (a power of two), more than this are dropped
+#define INPUTQUEUESIZE 256
+
+typedef struct
+{
+    //ring of events written by one thread and read by one other
+    //head is only changed by the reader and tail only by the writer, so neither needs a lock
+    inputEvent events[INPUTQUEUESIZE];
+    atomic_uint head; //next event to read
+    atomic_uint tail; //next free place to write
+}inputQueue;
+
+void initInputQueue(inputQueue *q);
+int inputQueuePush(inputQueue *q, int type, int value);
+int inputQueuePop(inputQueue *q, inputEvent *e);
+
+#endif
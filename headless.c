@@ -0,0 +1,925 @@
+//runs simulated flights without a window, as fast as the computer can step them
+//usage: $ ./spacetaxi_headless [flights] [seconds per flight] [step ms] [seed] [level pack]
+//   or: $ ./spacetaxi_headless batch [taxis] [seconds] [step ms] [seed] [level pack]   to sweep gravity over a batch of hovering taxis
+//   or: $ ./spacetaxi_headless replay [--levels pack] <recordings...>   to check recorded games still play out the same
+//   or: $ ./spacetaxi_headless autopilot [games] [seconds] [step ms] [seed] [workers] [level pack]   to soak test the levels with the autopilot
+//   or: $ ./spacetaxi_headless validate [workers] [step ms] [level pack]   to check every journey the customers can ask for can be flown
+//   or: $ ./spacetaxi_headless cavern [seconds] [chunks] [seed] [step ms]   to fly along a procedural cavern, making it as it goes
+//   or: $ ./spacetaxi_headless fleet [taxis] [seconds] [step ms] [seed] [level pack]   to fly a fleet of taxis round each level with the simple pilot
+//   or: $ ./spacetaxi_headless shots [dir] [scale] [png|ppm] [seed] [level pack]   to save a picture of each level, drawn by the software renderer
+//   or: $ ./spacetaxi_headless shotdiff <before dir> <after dir>   to compare two sets of ppm shots, saving a picture of where they differ
+//the level pack defaults to levels.bin
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <dirent.h>
+#include "spacetaxi.h"
+#include "batch.h"
+#include "levelpack.h"
+#include "replay.h"
+#include "autopilot.h"
+#include "profile.h"
+#include "validate.h"
+#include "cavern.h"
+#include "fleet.h"
+#include "softrender.h"
+
+void simplePilot(taxi *t, level *lvl, taxiInput *in)
+{
+    //a very basic computer pilot: flies level with the wheels up above the pad it wants,
+    //then lowers the wheels and drops straight down onto it
+    double targetX = 400.0;
+    double targetY = 650.0; //above the top of the screen, for the exit
+    double wantV, wantH;
+    int pad = -1;
+
+    in->toggleWheels = 0;
+
+    //works out which pad to go to
+    if(lvl->levelCustomerCurrentNumber != lvl->levelCustomerNumber)
+    {
+        if(t->custo_waiting == '1')
+        {
+            pad = lvl->currentCustomer.destPlatform;
+        }
+        else
+        {
+            pad = lvl->currentCustomer.fromPlatform;
+        }
+        if(pad < 0 || pad >= lvl->numplatforms)
+        {
+            pad = 0;
+        }
+        targetX = (lvl->platforms[pad].l.x1 + lvl->platforms[pad].l.x2) / 2;
+        targetY = lvl->platforms[pad].l.y1 + 45;
+    }
+
+    double dx = targetX - t->x;
+    double dy = targetY - t->y;
+    //over the pad, slow enough sideways, and no higher than the cruising height
+    char overPad = (pad >= 0 && dx < 6 && dx > -6 && t->hSpeed < 5 && t->hSpeed > -5 && dy > -15);
+
+    //wheels only come down once the taxi is over the pad
+    if((t->wheelLandersEnabled == '1') != overPad)
+    {
+        in->toggleWheels = 1;
+    }
+
+    //height control, aiming for the cruising height, or slowly down once the wheels are out over the pad
+    if(overPad)
+    {
+        wantV = -40;
+    }
+    else
+    {
+        wantV = dy * 2;
+        if(wantV > 80) wantV = 80;
+        if(wantV < -80) wantV = -80;
+    }
+    in->vThrust = (t->vSpeed < wantV) ? 1 : 0;
+
+    //sideways control, only once at the cruising height
+    wantH = 0;
+    if(dy < 30 && dy > -30)
+    {
+        wantH = dx * 1.5;
+        if(wantH > 120) wantH = 120;
+        if(wantH < -120) wantH = -120;
+    }
+    if(t->hSpeed < wantH - 3)
+    {
+        in->hThrust = 1;
+    }
+    else if(t->hSpeed > wantH + 3)
+    {
+        in->hThrust = -1;
+    }
+    else
+    {
+        in->hThrust = 0;
+    }
+}
+
+void cavePilot(const cavern *c, taxi *t, taxiInput *in)
+{
+    //flies slowly right along the middle of a cavern, keeping between the highest floor and lowest ceiling just ahead
+    double lowest = 1e9, highest = -1e9, x;
+    for(x = t->x + t->bb.x1 - 10; x <= t->x + t->bb.x2 + 100; x += 5)
+    {
+        highest = fmax(highest, cavernFloor(c, x));
+        lowest = fmin(lowest, cavernCeiling(c, x));
+    }
+    double wantY = (highest + lowest) / 2 - (t->bb.y1 + t->bb.y2) / 2;
+    double wantV = (wantY - t->y) * 3;
+    if(wantV > 60) wantV = 60;
+    if(wantV < -60) wantV = -60;
+
+    in->toggleWheels = t->wheelLandersEnabled == '1';
+    in->vThrust = (t->vSpeed < wantV) ? 1 : 0;
+    in->hThrust = t->hSpeed < 60 ? 1 : (t->hSpeed > 70 ? -1 : 0);
+}
+
+//hops between pads at the end of a cavern run, to check customers get picked up and delivered
+#define CAVERNHOPS 200
+
+static int hopToPad(cavern *c, level *lvl, taxi *t, int pad, double stepMs)
+{
+    //puts the taxi, wheels down and still, just above a pad and lets it settle onto it through the normal collision,
+    //the same landing a pilot makes, only without flying there; returns 1 if it landed
+    taxiInput none = {0.0, 0.0, 0};
+    const lseg *l = &lvl->platforms[pad].l;
+    int i;
+
+    t->x = (l->x1 + l->x2) / 2;
+    t->y = fmax(l->y1, l->y2) - t->bb.y1 + 2;
+    t->vSpeed = 0;
+    t->hSpeed = 0;
+    t->vThrust = 0;
+    t->hThrust = 0;
+    t->inflight = '1';
+    t->wheelLandersEnabled = '1';
+    streamCavern(c, lvl, t->x);
+    for(i = 0; i < 1000; i++)
+    {
+        int result = updateGame(t, lvl, NULL, &none, stepMs);
+        if(result == GAMERESPAWNED || result == GAMEOVER)
+        {
+            return 0;
+        }
+        if(t->inflight == '0')
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int runCavern(double seconds, int chunks, unsigned int seed, double stepMs)
+{
+    //flies along a cavern, making its lines around the taxi as it goes, and reports how far it got and what streaming cost,
+    //then hops the taxi from pad to pad after the customers it's offered, and returns 1 if any pickup or delivery went wrong
+    cavern c;
+    level lvl;
+    taxi t;
+    taxiInput input = {0.0, 0.0, 0};
+    int result = GAMEPLAYING, crashes = 0;
+    long long steps = 0;
+    double flown = 0, furthest = 0, streamMs = 0, maxStreamMs = 0;
+    if(startCavernGame(&t, &lvl, &c, seed, chunks) == 0)
+    {
+        printf("out of memory for a cavern of %d chunks\n", chunks);
+        return 1;
+    }
+    int mostLines = lvl.numbounds;
+    printf("cavern of %d chunks (%.0f wide), %d pads\n", c.numChunks, c.numChunks * CAVERNCHUNK, lvl.numplatforms);
+    long long start = profileNow();
+    while(flown < seconds * 1000.0 && result != GAMEOVER && t.x < (c.numChunks - 1) * CAVERNCHUNK)
+    {
+        long long streamStart = profileNow();
+        if(streamCavern(&c, &lvl, t.x))
+        {
+            double ms = (profileNow() - streamStart) / 1e6;
+            streamMs += ms;
+            maxStreamMs = fmax(maxStreamMs, ms);
+            mostLines = lvl.numbounds > mostLines ? lvl.numbounds : mostLines;
+        }
+        cavePilot(&c, &t, &input);
+        result = updateGame(&t, &lvl, NULL, &input, stepMs);
+        flown += stepMs;
+        steps++;
+        furthest = fmax(furthest, t.x);
+        if(result == GAMERESPAWNED || result == GAMEOVER)
+        {
+            printf("crashed at x %.0f y %.0f\n", t.x, t.y);
+            crashes++;
+        }
+    }
+    double secs = (profileNow() - start) / 1e9;
+    long long linesMade = c.linesMade, spawned = c.customers.spawned, expired = c.customers.expired;
+    int streams = c.streams, waiting = dispatchCount(&c.customers);
+
+    //the pilot above only flies along the middle, so hops to the offered customer's pad and then to where they're going
+    int hops = 0, landed = 0, deliveries = 0, fails = 0;
+    initialiseTaxi(&t, t.x, t.y, 3);
+    long long pickedUp = c.customers.pickedUp, delivered = c.customers.delivered;
+    int customersBefore = lvl.levelCustomerCurrentNumber;
+    while(hops < CAVERNHOPS)
+    {
+        char carrying = t.custo_waiting;
+        int pad = carrying == '1' ? t.custo_current.destPlatform : lvl.currentCustomer.fromPlatform;
+        double money = t.money;
+        if(carrying == '0' && lvl.customerWaiting == '0')
+        {
+            //no one is waiting yet, so waits a step for someone to turn up
+            updateGame(&t, &lvl, NULL, &input, stepMs);
+            continue;
+        }
+        hops++;
+        if(hopToPad(&c, &lvl, &t, pad, stepMs) == 0)
+        {
+            printf("hop %d to pad %d didn't land, at x %.0f y %.0f\n", hops, pad, t.x, t.y);
+            fails++;
+            initialiseTaxi(&t, t.x, t.y, 3);
+            continue;
+        }
+        landed++;
+        if(carrying == '1')
+        {
+            //dropped off and paid
+            deliveries++;
+            if(t.money <= money)
+            {
+                printf("hop %d: delivery to pad %d paid nothing\n", hops, pad);
+                fails++;
+            }
+        }
+        else if(t.custo_waiting == '0')
+        {
+            printf("hop %d: no customer picked up at pad %d\n", hops, pad);
+            fails++;
+        }
+    }
+    pickedUp = c.customers.pickedUp - pickedUp;
+    delivered = c.customers.delivered - delivered;
+    if(delivered != deliveries || lvl.levelCustomerCurrentNumber - customersBefore != deliveries)
+    {
+        printf("deliveries don't add up: %d made, %lld counted by the dispatcher, %d by the level\n",
+            deliveries, delivered, lvl.levelCustomerCurrentNumber - customersBefore);
+        fails++;
+    }
+
+    printf("\n%.1f s flown, furthest x %.0f (chunk %d of %d), %d crashes, %lld steps in %.3f s\n",
+        flown / 1000, furthest, (int)(furthest / CAVERNCHUNK) + 1, c.numChunks, crashes, steps, secs);
+    printf("lines made %lld over %d streams, at most %d in the level at once\n", linesMade, streams, mostLines);
+    printf("streaming: %.3f ms on average, %.3f ms at most\n", streams > 0 ? streamMs / streams : 0.0, maxStreamMs);
+    printf("customers while flying: %lld turned up, %lld gave up waiting, %lld turned away, %d waiting\n",
+        spawned, expired, c.customers.dropped, waiting);
+    printf("hops: %d of %d landed, %lld picked up, %lld delivered, %.0f earned, %d problems\n",
+        landed, hops, pickedUp, delivered, t.money, fails);
+    freeCavern(&c);
+    freeLevel(&lvl);
+    return fails > 0;
+}
+
+static void startFleetLevel(taxi *t, level *lvl, const levelPack *pack, int n, unsigned int seed)
+{
+    //a new game, starting on level n of the pack
+    startGame(t, lvl, pack, seed);
+    if(n > 0)
+    {
+        loadLevel(lvl, pack, n);
+        customerMakeNext(lvl, 999, 't');
+        t->levelCurrent = n + 1;
+    }
+}
+void runFleet(const levelPack *pack, int numTaxis, double seconds, double stepMs, unsigned int seed)
+{
+    //plays each level of the pack for a while with a fleet flying round the simple pilot, and reports how
+    //the fleet got on and how many pairs of taxis the sort and sweep compared, against comparing every pair
+    fleet f;
+    level lvl;
+    taxi t;
+    taxiInput input = {0.0, 0.0, 0};
+    int n, playerCrashes = 0;
+    long long steps = 0;
+    double fleetMs = 0, maxFleetMs = 0;
+
+    if(initFleet(&f, numTaxis, seed) == 0)
+    {
+        printf("couldn't make a fleet of %d taxis\n", numTaxis);
+        return;
+    }
+    long long start = profileNow();
+    for(n = 0; n < pack->numLevels; n++)
+    {
+        double flown = 0;
+        startFleetLevel(&t, &lvl, pack, n, seed + n);
+        long long crashes = f.crashes, landings = f.landings;
+        while(flown < seconds * 1000.0)
+        {
+            int fleetLevel = f.levelNumber;
+            long long stepStart = profileNow();
+            stepFleet(&f, &t, &lvl, stepMs);
+            double ms = (profileNow() - stepStart) / 1e6;
+            fleetMs += ms;
+            //the first step on a level works out the distance maps, so isn't counted in the slowest
+            maxFleetMs = f.levelNumber == fleetLevel ? fmax(maxFleetMs, ms) : maxFleetMs;
+
+            simplePilot(&t, &lvl, &input);
+            int result = updateGame(&t, &lvl, pack, &input, stepMs);
+            flown += stepMs;
+            steps++;
+            if(result == GAMERESPAWNED || result == GAMEOVER)
+            {
+                playerCrashes++;
+                t.lives = 3;
+            }
+            if(result != GAMEPLAYING && result != GAMERESPAWNED)
+            {
+                //stay on this level
+                freeLevel(&lvl);
+                startFleetLevel(&t, &lvl, pack, n, seed + n);
+            }
+        }
+        printf("level %d: %lld landings, %lld crashes\n", n + 1, f.landings - landings, f.crashes - crashes);
+        freeLevel(&lvl);
+    }
+    double secs = (profileNow() - start) / 1e9;
+    long long allPairs = steps * (long long)(f.numTaxis + 1) * f.numTaxis / 2;
+
+    printf("\n%d taxis, %lld steps in %.3f s (%.0f taxi steps per second)\n", f.numTaxis, steps, secs,
+        secs > 0 ? steps * (f.numTaxis + 1.0) / secs : 0.0);
+    printf("fleet steps: %.3f ms on average, %.3f ms at most\n", steps > 0 ? fleetMs / steps : 0.0, maxFleetMs);
+    printf("landings: %lld  crashes: %lld  bumps: %lld  player crashes: %d (%lld from the fleet)\n",
+        f.landings, f.crashes, f.bumps, playerCrashes, f.playerCrashes);
+    printf("pairs compared: %.1f per step, against %.0f for every pair\n",
+        steps > 0 ? (double)f.pairsTested / steps : 0.0, steps > 0 ? (double)allPairs / steps : 0.0);
+    freeFleet(&f);
+}
+
+void runBatchSweep(const levelPack *pack, int count, double seconds, double stepMs, unsigned int seed)
+{
+    //every taxi tries to hover at its own random height, once for each gravity setting
+    //reports how many survive, and how many taxi steps per second the batch managed
+    double gravities[3] = {150.0, 200.0, 250.0};
+    double simSpeed = SIMSPEED;
+    int i, k;
+    double *wantY = malloc(sizeof(double) * count);
+    //each gravity setting gets its own generator split from this one
+    pcg32 rng;
+    pcgSeed(&rng, seed, 0);
+
+    for(k = 0; k < 3; k++)
+    {
+        taxiBatch b;
+        if(wantY == NULL || batchCreate(&b, count) == 0)
+        {
+            printf("out of memory for %d taxis\n", count);
+            free(wantY);
+            return;
+        }
+        b.gravity = gravities[k];
+
+        level lvl;
+        initialiseLevel(&lvl);
+        lvl.rng = pcgSplit(&rng);
+        loadLevel(&lvl, pack, 0);
+        for(i = 0; i < count; i++)
+        {
+            wantY[i] = 300 + gameRandBelow(&lvl, 250);
+            b.wheels[i] = 0.0;
+        }
+
+        long long steps = 0;
+        double flown = 0;
+        clock_t start = clock();
+        while(flown < seconds * 1000.0)
+        {
+            for(i = 0; i < count; i++)
+            {
+                double wantV = (wantY[i] - b.y[i]) * 2;
+                b.vThrust[i] = (b.vSpeed[i] < wantV) ? 1 : 0;
+            }
+            batchStep(&b, &lvl, stepMs * simSpeed);
+            flown += stepMs;
+            steps += count;
+        }
+        double secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        int alive = 0;
+        for(i = 0; i < count; i++)
+        {
+            alive += (b.intact[i] != 0.0);
+        }
+        printf("gravity %.0f: %d of %d taxis still flying, %lld taxi steps in %.3f s (%.0f per second)\n",
+               b.gravity, alive, count, steps, secs, secs > 0 ? steps / secs : 0.0);
+        batchFree(&b);
+        freeLevel(&lvl);
+    }
+    free(wantY);
+}
+
+int runReplays(const levelPack *pack, char **paths, int count)
+{
+    //plays each recording at full speed and checks it ends the same way it did when it was recorded
+    //returns the number that didn't
+    int i, different = 0;
+    long long steps = 0;
+    clock_t start = clock();
+
+    for(i = 0; i < count; i++)
+    {
+        replay rp;
+        level lvl;
+        taxi t;
+        int result;
+        uint64_t checksum;
+        if(loadReplay(&rp, paths[i]) == 0)
+        {
+            different++;
+            continue;
+        }
+        unsigned int ticks = playReplay(&rp, pack, &t, &lvl, &result, &checksum);
+        steps += ticks;
+        if(replayMatches(&rp, ticks, result, &t, checksum) == 0)
+        {
+            printf("%s: DIFFERENT, recorded %u steps, money %.2f, level %d; played %u steps, money %.2f, level %d\n",
+                paths[i], rp.h.numTicks, rp.h.money, rp.h.levelCurrent, ticks, t.money, t.levelCurrent);
+            different++;
+        }
+        freeLevel(&lvl);
+        freeReplay(&rp);
+    }
+    double secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("\n%d recordings, %d different, %lld steps in %.3f s (%.0f steps per second)\n",
+        count, different, steps, secs, secs > 0 ? steps / secs : 0.0);
+    return different;
+}
+
+void runAutopilotGames(const levelPack *pack, int games, double seconds, double stepMs, unsigned int seed, int workers)
+{
+    //plays whole games with the autopilot flying, and reports how they went and how long planning took
+    autopilot ap;
+    long long steps = 0;
+    int crashes = 0, gameOvers = 0, wins = 0, levels = 0;
+    double money = 0;
+    int g;
+
+    if(startAutopilot(&ap, workers, stepMs, seed) == 0)
+    {
+        printf("couldn't start the autopilot's threads\n");
+        return;
+    }
+    long long start = profileNow();
+    for(g = 0; g < games; g++)
+    {
+        level lvl;
+        taxi t;
+        taxiInput input = {0.0, 0.0, 0};
+        int result = GAMEPLAYING;
+        double flown = 0;
+
+        startGame(&t, &lvl, pack, seed + g);
+        while(flown < seconds * 1000.0 && result != GAMEOVER && result != GAMEWON)
+        {
+            autopilotInput(&ap, &t, &lvl, &input);
+            result = updateGame(&t, &lvl, pack, &input, stepMs);
+            flown += stepMs;
+            steps++;
+            if(result == GAMERESPAWNED || result == GAMEOVER)
+            {
+                crashes++;
+            }
+        }
+        gameOvers += (result == GAMEOVER);
+        wins += (result == GAMEWON);
+        levels += t.levelCurrent - 1;
+        money += t.money;
+        printf("game %d: %s, level %d, money %.2f, %.1f s\n", g + 1,
+            result == GAMEWON ? "won" : result == GAMEOVER ? "game over" : "out of time", t.levelCurrent, t.money, flown / 1000);
+        freeLevel(&lvl);
+    }
+    double secs = (profileNow() - start) / 1e9;
+
+    printf("\n%d games, %lld steps in %.3f s, %d workers\n", games, steps, secs, ap.numWorkers);
+    printf("crashes: %d  game overs: %d  games won: %d  levels finished: %d  average money: %.2f\n",
+        crashes, gameOvers, wins, levels, games > 0 ? money / games : 0.0);
+    printf("%d plans, %.3f ms on average, %.3f ms at most\n", ap.plans, ap.plans > 0 ? ap.planMs / ap.plans : 0.0, ap.maxPlanMs);
+    stopAutopilot(&ap);
+}
+
+int runValidator(const levelPack *pack, int workers, double stepMs)
+{
+    //prints the least fuel for every journey on every level, and the journeys customers can ask for that can't be flown
+    //returns the number of those
+    levelReport *reports;
+    long long start = profileNow();
+    int numLevels = validateLevels(pack, workers, stepMs, &reports);
+    int impossible = 0;
+    int i, a, b;
+
+    if(numLevels == 0)
+    {
+        printf("couldn't validate the levels\n");
+        return 1;
+    }
+    for(i = 0; i < numLevels; i++)
+    {
+        levelReport *r = &reports[i];
+        int n = r->numPads + 1;
+        printf("\nlevel %d: %d pads, %lld states searched\n", i + 1, r->numPads, r->explored);
+        printf("fuel (s)  ");
+        for(b = 0; b < n; b++)
+        {
+            if(b < r->numPads)
+            {
+                printf(" to pad%-2d", b);
+            }
+            else
+            {
+                printf("   to exit");
+            }
+        }
+        printf("\n");
+        for(a = 0; a < n; a++)
+        {
+            if(a < r->numPads)
+            {
+                printf("from pad%-2d", a);
+            }
+            else
+            {
+                printf("from start");
+            }
+            for(b = 0; b < n; b++)
+            {
+                if(r->fuel[a * n + b] >= VALNOROUTE)
+                {
+                    printf("%9s", "-");
+                }
+                else
+                {
+                    printf("%9.2f", r->fuel[a * n + b]);
+                }
+            }
+            printf("\n");
+        }
+        for(a = 0; a < n; a++)
+        {
+            for(b = 0; b < n; b++)
+            {
+                if(journeyNeeded(r->numPads, a, b) && r->fuel[a * n + b] >= VALNOROUTE)
+                {
+                    printf("can't fly from ");
+                    printf(a < r->numPads ? "pad %d" : "the start", a);
+                    printf(" to ");
+                    printf(b < r->numPads ? "pad %d\n" : "the exit\n", b);
+                    impossible++;
+                }
+            }
+        }
+    }
+    printf("\n%d levels in %.3f s, %d journeys customers can ask for can't be flown\n", numLevels, (profileNow() - start) / 1e9, impossible);
+    freeLevelReports(reports, numLevels);
+    return impossible;
+}
+
+int runShots(const levelPack *pack, const char *dir, double scale, const char *format, unsigned int seed)
+{
+    //draws the start of each level with the software renderer, scale times the window's size, and saves it in dir
+    //as levelNNN.png or .ppm (numbered from 0), for thumbnails, or for comparing with shotdiff after a change
+    //returns the number of levels saved
+    int width = WINWIDTH;
+    int height = WINHEIGHT;
+    int n, saved = 0;
+    char path[4096];
+    renderer rend;
+    canvas pic;
+    level lvl;
+    taxi t;
+
+    if(initCanvas(&pic, (int)(width * scale + 0.5), (int)(height * scale + 0.5), scale) == 0)
+    {
+        printf("out of memory for a %gx picture\n", scale);
+        return 0;
+    }
+    initRenderer(&rend, width, height);
+    useSoftBackend(&rend, &pic);
+    long long start = profileNow();
+    for(n = 0; n < pack->numLevels; n++)
+    {
+        startFleetLevel(&t, &lvl, pack, n, seed);
+        loadLevelRenderer(&rend, &lvl);
+        render(&t, &lvl, &rend);
+        snprintf(path, sizeof(path), "%s/level%03d.%s", dir, n, format);
+        if(strcmp(format, "ppm") == 0 ? writePPM(&pic, path) : writePNG(&pic, path))
+        {
+            saved++;
+        }
+        else
+        {
+            printf("couldn't write %s\n", path);
+        }
+        freeLevel(&lvl);
+    }
+    printf("%d of %d levels saved as %dx%d %s in %.3f s\n", saved, pack->numLevels, pic.width, pic.height, format,
+        (profileNow() - start) / 1e9);
+    freeRenderer(&rend);
+    freeCanvas(&pic);
+    return saved;
+}
+static int lastShot(const char *dir)
+{
+    //the highest NNN of the levelNNN.ppm files in a directory, -1 if there are none, or -2 if it can't be opened
+    DIR *d = opendir(dir);
+    struct dirent *e;
+    const char *name;
+    int n, last = -1;
+    if(d == NULL)
+    {
+        return -2;
+    }
+    while((e = readdir(d)) != NULL)
+    {
+        name = e->d_name;
+        if(strlen(name) == 12 && strncmp(name, "level", 5) == 0 && strcmp(name + 8, ".ppm") == 0
+           && name[5] >= '0' && name[5] <= '9' && name[6] >= '0' && name[6] <= '9' && name[7] >= '0' && name[7] <= '9')
+        {
+            n = atoi(name + 5);
+            if(n > last)
+            {
+                last = n;
+            }
+        }
+    }
+    closedir(d);
+    return last;
+}
+static int shotExists(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if(f == NULL)
+    {
+        return 0;
+    }
+    fclose(f);
+    return 1;
+}
+int runShotDiff(const char *before, const char *after)
+{
+    //compares the levelNNN.ppm shots in two directories, saving diffNNN.png in the second where they differ
+    //returns the number of shots that differ, are missing from either or can't be read,
+    //or -1 if a directory can't be opened or neither has any shots
+    char path[4096];
+    int n, compared = 0, different = 0;
+    int lastBefore = lastShot(before), lastAfter = lastShot(after);
+    if(lastBefore == -2 || lastAfter == -2)
+    {
+        printf("couldn't open %s\n", lastBefore == -2 ? before : after);
+        return -1;
+    }
+    int last = lastBefore > lastAfter ? lastBefore : lastAfter;
+    for(n = 0; n <= last; n++)
+    {
+        canvas a, b, diff;
+        char pathB[4096];
+        snprintf(path, sizeof(path), "%s/level%03d.ppm", before, n);
+        snprintf(pathB, sizeof(pathB), "%s/level%03d.ppm", after, n);
+        int inBefore = shotExists(path), inAfter = shotExists(pathB);
+        if(!inBefore && !inAfter)
+        {
+            continue;
+        }
+        compared++;
+        if(!inBefore || !inAfter)
+        {
+            printf("level %d: no shot in %s\n", n, inBefore ? after : before);
+            different++;
+            continue;
+        }
+        if(readPPM(&a, path) == 0)
+        {
+            printf("level %d: couldn't read %s\n", n, path);
+            different++;
+            continue;
+        }
+        if(readPPM(&b, pathB) == 0)
+        {
+            printf("level %d: couldn't read %s\n", n, pathB);
+            different++;
+            freeCanvas(&a);
+            continue;
+        }
+        long long pixels = diffCanvas(&diff, &a, &b);
+        if(pixels == -2)
+        {
+            printf("level %d: out of memory comparing the shots\n", n);
+            different++;
+        }
+        else if(pixels < 0)
+        {
+            printf("level %d: different sizes\n", n);
+            different++;
+        }
+        else if(pixels > 0)
+        {
+            snprintf(path, sizeof(path), "%s/diff%03d.png", after, n);
+            printf("level %d: %lld pixels differ, see %s\n", n, pixels, path);
+            writePNG(&diff, path);
+            different++;
+        }
+        if(pixels >= 0)
+        {
+            freeCanvas(&diff);
+        }
+        freeCanvas(&a);
+        freeCanvas(&b);
+    }
+    if(compared == 0)
+    {
+        printf("no levelNNN.ppm shots in %s or %s\n", before, after);
+        return -1;
+    }
+    printf("%d shots compared, %d differ\n", compared, different);
+    return different;
+}
+
+int main(int argc, char **argv)
+{
+    int flights = 1000;
+    double seconds = 120.0;
+    double stepMs = 20.0;
+    unsigned int seed = 1;
+    const char *packPath = "levels.bin";
+    levelPack pack;
+
+    if(argc > 1 && strcmp(argv[1], "replay") == 0)
+    {
+        int first = 2;
+        if(argc > 3 && strcmp(argv[2], "--levels") == 0)
+        {
+            packPath = argv[3];
+            first = 4;
+        }
+        if(openLevelPack(&pack, packPath) == 0)
+        {
+            return 1;
+        }
+        int different = runReplays(&pack, argv + first, argc - first);
+        closeLevelPack(&pack);
+        return different > 0;
+    }
+
+    if(argc > 1 && strcmp(argv[1], "autopilot") == 0)
+    {
+        int games = 5;
+        int workers = autopilotWorkers();
+        seconds = 300.0;
+        stepMs = 1000.0 / 240;
+        if(argc > 2) games = atoi(argv[2]);
+        if(argc > 3) seconds = atof(argv[3]);
+        if(argc > 4) stepMs = atof(argv[4]);
+        if(argc > 5) seed = atoi(argv[5]);
+        if(argc > 6) workers = atoi(argv[6]);
+        if(argc > 7) packPath = argv[7];
+        if(openLevelPack(&pack, packPath) == 0)
+        {
+            return 1;
+        }
+        runAutopilotGames(&pack, games, seconds, stepMs, seed, workers);
+        closeLevelPack(&pack);
+        return 0;
+    }
+
+    if(argc > 1 && strcmp(argv[1], "cavern") == 0)
+    {
+        int chunks = CAVERNCHUNKS;
+        seconds = 600.0;
+        stepMs = 1000.0 / 240;
+        if(argc > 2) seconds = atof(argv[2]);
+        if(argc > 3) chunks = atoi(argv[3]);
+        if(argc > 4) seed = atoi(argv[4]);
+        if(argc > 5) stepMs = atof(argv[5]);
+        return runCavern(seconds, chunks, seed, stepMs);
+    }
+
+    if(argc > 1 && strcmp(argv[1], "fleet") == 0)
+    {
+        int numTaxis = 200;
+        seconds = 60.0;
+        stepMs = 1000.0 / 240;
+        if(argc > 2) numTaxis = atoi(argv[2]);
+        if(argc > 3) seconds = atof(argv[3]);
+        if(argc > 4) stepMs = atof(argv[4]);
+        if(argc > 5) seed = atoi(argv[5]);
+        if(argc > 6) packPath = argv[6];
+        if(openLevelPack(&pack, packPath) == 0)
+        {
+            return 1;
+        }
+        runFleet(&pack, numTaxis, seconds, stepMs, seed);
+        closeLevelPack(&pack);
+        return 0;
+    }
+
+    if(argc > 1 && strcmp(argv[1], "validate") == 0)
+    {
+        int workers = autopilotWorkers() + 1; //every processor, this thread searches too
+        stepMs = 1000.0 / 240;
+        if(argc > 2) workers = atoi(argv[2]);
+        if(argc > 3) stepMs = atof(argv[3]);
+        if(argc > 4) packPath = argv[4];
+        if(openLevelPack(&pack, packPath) == 0)
+        {
+            return 1;
+        }
+        int impossible = runValidator(&pack, workers, stepMs);
+        closeLevelPack(&pack);
+        return impossible > 0;
+    }
+
+    if(argc > 1 && strcmp(argv[1], "shots") == 0)
+    {
+        const char *dir = ".";
+        const char *format = "png";
+        double scale = 0.25;
+        if(argc > 2) dir = argv[2];
+        if(argc > 3) scale = atof(argv[3]);
+        if(argc > 4) format = argv[4];
+        if(argc > 5) seed = atoi(argv[5]);
+        if(argc > 6) packPath = argv[6];
+        if(openLevelPack(&pack, packPath) == 0)
+        {
+            return 1;
+        }
+        int saved = runShots(&pack, dir, scale, format, seed);
+        int numLevels = pack.numLevels;
+        closeLevelPack(&pack);
+        return saved < numLevels;
+    }
+
+    if(argc > 3 && strcmp(argv[1], "shotdiff") == 0)
+    {
+        return runShotDiff(argv[2], argv[3]) != 0;
+    }
+
+    if(argc > 1 && strcmp(argv[1], "batch") == 0)
+    {
+        int count = 10000;
+        seconds = 10.0;
+        if(argc > 2) count = atoi(argv[2]);
+        if(argc > 3) seconds = atof(argv[3]);
+        if(argc > 4) stepMs = atof(argv[4]);
+        if(argc > 5) seed = atoi(argv[5]);
+        if(argc > 6) packPath = argv[6];
+        if(openLevelPack(&pack, packPath) == 0)
+        {
+            return 1;
+        }
+        runBatchSweep(&pack, count, seconds, stepMs, seed);
+        closeLevelPack(&pack);
+        return 0;
+    }
+
+    if(argc > 1) flights = atoi(argv[1]);
+    if(argc > 2) seconds = atof(argv[2]);
+    if(argc > 3) stepMs = atof(argv[3]);
+    if(argc > 4) seed = atoi(argv[4]);
+    if(argc > 5) packPath = argv[5];
+    if(openLevelPack(&pack, packPath) == 0)
+    {
+        return 1;
+    }
+
+    long long steps = 0;
+    int crashes = 0, gameOvers = 0, wins = 0;
+    double money = 0;
+
+    clock_t start = clock();
+    int f;
+    for(f = 0; f < flights; f++)
+    {
+        level lvl;
+        taxi t;
+        taxiInput input = {0.0, 0.0, 0};
+
+        //each flight is its own seeded game
+        startGame(&t, &lvl, &pack, seed + f);
+
+        int go = 1;
+        double flown = 0;
+        while(go && flown < seconds * 1000.0)
+        {
+            simplePilot(&t, &lvl, &input);
+            int result = updateGame(&t, &lvl, &pack, &input, stepMs);
+            flown += stepMs;
+            steps++;
+
+            if(result == GAMERESPAWNED || result == GAMEOVER)
+            {
+                crashes++;
+            }
+            if(result == GAMEOVER)
+            {
+                gameOvers++;
+                go = 0;
+            }
+            else if(result == GAMEWON)
+            {
+                wins++;
+                go = 0;
+            }
+        }
+        money += t.money;
+        freeLevel(&lvl);
+    }
+    double secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("\n%d flights, %lld steps in %.3f s (%.0f steps per second)\n", flights, steps, secs, secs > 0 ? steps / secs : 0.0);
+    printf("crashes: %d  game overs: %d  games won: %d  average money: %.2f\n", crashes, gameOvers, wins, flights > 0 ? money / flights : 0.0);
+    closeLevelPack(&pack);
+
+    return 0;
+}
@@ -0,0 +1,140 @@
+//the level compiler: turns level text files into one level pack for the game to map
+//usage: $ ./levelc <pack to write> <level text files...>
+//
+//a text file holds one or more levels, each one like this (# starts a comment):
+//    level
+//    rain 40                   chance of rain, 0 to 100
+//    customers 3 1             customers in the level, and the customer number it starts on
+//    bound x1 y1 x2 y2         a boundary line, any number of them
+//    pad xStart xEnd yStart yEnd   a landing pad, its undersides are added automatically like createPlatform()
+//    end
+//levels go into the pack in the order they are given, the game plays them from the first
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "spacetaxi.h"
+#include "levelpack.h"
+
+static int compileFile(const char *path, level **levels, int *numLevels, int *capacity)
+{
+    //adds the levels in one text file to the list, returns 0 (with a message) on a mistake in the file
+    char line[256];
+    char word[32];
+    int lineNumber = 0;
+    level *lvl = NULL; //the level being read, NULL between levels
+
+    FILE *f = fopen(path, "r");
+    if(f == NULL)
+    {
+        printf("can't open %s\n", path);
+        return 0;
+    }
+    while(fgets(line, sizeof(line), f) != NULL)
+    {
+        double a, b, c, d;
+        int extra;
+        lineNumber++;
+
+        char *comment = strchr(line, '#');
+        if(comment != NULL)
+        {
+            *comment = '\0';
+        }
+        if(sscanf(line, "%31s", word) != 1)
+        {
+            continue; //blank line
+        }
+
+        if(strcmp(word, "level") == 0 && lvl == NULL)
+        {
+            if(*numLevels == *capacity)
+            {
+                *capacity = *capacity ? *capacity * 2 : 16;
+                level *grown = realloc(*levels, sizeof(level) * *capacity);
+                if(grown == NULL)
+                {
+                    printf("out of memory\n");
+                    fclose(f);
+                    return 0;
+                }
+                *levels = grown;
+            }
+            lvl = &(*levels)[(*numLevels)++];
+            initialiseLevel(lvl);
+            lvl->rainChance = 0;
+            lvl->levelCustomerNumber = 1;
+            lvl->levelCustomerCurrentNumber = 0;
+        }
+        else if(lvl == NULL)
+        {
+            printf("%s:%d: expected 'level'\n", path, lineNumber);
+            fclose(f);
+            return 0;
+        }
+        else if(strcmp(word, "end") == 0)
+        {
+            lvl = NULL;
+        }
+        else if(strcmp(word, "rain") == 0 && sscanf(line, "%*s %lf %n", &a, &extra) == 1 && line[extra] == '\0')
+        {
+            lvl->rainChance = a;
+        }
+        else if(strcmp(word, "customers") == 0 && sscanf(line, "%*s %lf %lf %n", &a, &b, &extra) == 2 && line[extra] == '\0')
+        {
+            lvl->levelCustomerNumber = a;
+            lvl->levelCustomerCurrentNumber = b;
+        }
+        else if(strcmp(word, "bound") == 0 && sscanf(line, "%*s %lf %lf %lf %lf %n", &a, &b, &c, &d, &extra) == 4 && line[extra] == '\0')
+        {
+            addBoundary(lvl, a, b, c, d);
+        }
+        else if(strcmp(word, "pad") == 0 && sscanf(line, "%*s %lf %lf %lf %lf %n", &a, &b, &c, &d, &extra) == 4 && line[extra] == '\0')
+        {
+            createPlatform(lvl, a, b, c, d, lvl->numplatforms + 1);
+        }
+        else
+        {
+            printf("%s:%d: can't read '%s'\n", path, lineNumber, word);
+            fclose(f);
+            return 0;
+        }
+    }
+    fclose(f);
+    if(lvl != NULL)
+    {
+        printf("%s: missing 'end' after the last level\n", path);
+        return 0;
+    }
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    level *levels = NULL;
+    int numLevels = 0, capacity = 0;
+    int i, ok = 1;
+
+    if(argc < 3)
+    {
+        printf("usage: %s <pack to write> <level text files...>\n", argv[0]);
+        return 1;
+    }
+    for(i = 2; i < argc && ok; i++)
+    {
+        ok = compileFile(argv[i], &levels, &numLevels, &capacity);
+    }
+    if(ok)
+    {
+        ok = writeLevelPack(argv[1], levels, numLevels);
+    }
+    if(ok)
+    {
+        printf("%d levels written to %s\n", numLevels, argv[1]);
+    }
+    for(i = 0; i < numLevels; i++)
+    {
+        freeLevel(&levels[i]);
+    }
+    free(levels);
+    return ok ? 0 : 1;
+}
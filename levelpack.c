@@ -0,0 +1,164 @@
+//level pack files, see levelpack.h
+//a pack is laid out as: header, table of levelRecords, then each level's segments (pads then boundary lines) as lseg structs
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "levelpack.h"
+
+int openLevelPack(levelPack *pack, const char *path)
+{
+    //maps the pack file into memory and checks its table
+    //returns 1 if it worked, 0 (with a message) if the file is missing or not a level pack for this machine
+    struct stat st;
+    int i;
+
+    pack->data = NULL;
+    pack->size = 0;
+    pack->numLevels = 0;
+    pack->records = NULL;
+
+    int fd = open(path, O_RDONLY);
+    if(fd < 0)
+    {
+        printf("can't open level pack %s (make builds levels.bin from levels/)\n", path);
+        return 0;
+    }
+    if(fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(levelPackHeader))
+    {
+        printf("%s is too small to be a level pack\n", path);
+        close(fd);
+        return 0;
+    }
+    //private and writable, so a level can be changed in memory (copy on write) without touching the file
+    void *data = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED)
+    {
+        printf("can't map level pack %s\n", path);
+        return 0;
+    }
+    pack->data = data;
+    pack->size = st.st_size;
+
+    const levelPackHeader *h = data;
+    if(memcmp(h->magic, "STXL", 4) != 0 || h->version != LEVELPACKVERSION || h->segmentSize != (int32_t)sizeof(lseg)
+        || h->numLevels < 0 || sizeof(levelPackHeader) + (size_t)h->numLevels * sizeof(levelRecord) > pack->size)
+    {
+        printf("%s is not a version %d level pack for this computer\n", path, LEVELPACKVERSION);
+        closeLevelPack(pack);
+        return 0;
+    }
+    pack->numLevels = h->numLevels;
+    pack->records = (const levelRecord *)(pack->data + sizeof(levelPackHeader));
+
+    //checks every level's segments are inside the file once, so switching levels doesn't need to
+    for(i = 0; i < pack->numLevels; i++)
+    {
+        const levelRecord *r = &pack->records[i];
+        if(r->offset < 0 || r->offset % sizeof(double) != 0 || r->numplatforms < 0 || r->numbounds < 0
+            || (size_t)r->offset + ((size_t)r->numplatforms + r->numbounds) * sizeof(lseg) > pack->size)
+        {
+            printf("level %d in %s is broken\n", i + 1, path);
+            closeLevelPack(pack);
+            return 0;
+        }
+    }
+    return 1;
+}
+void closeLevelPack(levelPack *pack)
+{
+    //unmaps the file, any level loaded from it must not be used after this
+    if(pack->data != NULL)
+    {
+        munmap(pack->data, pack->size);
+    }
+    pack->data = NULL;
+    pack->size = 0;
+    pack->numLevels = 0;
+    pack->records = NULL;
+}
+int loadLevel(level *lvl, const levelPack *pack, int n)
+{
+    //makes level n (counting from 0) of the pack the current level, returns 0 if the pack has no level n
+    //the segment arrays point into the mapped file, so this is only as slow as building the collision grid
+    if(n < 0 || n >= pack->numLevels)
+    {
+        return 0;
+    }
+    const levelRecord *r = &pack->records[n];
+
+    freeLevel(lvl);
+    lvl->platforms = (lpad *)(pack->data + r->offset);
+    lvl->bounds = (lseg *)(lvl->platforms + r->numplatforms);
+    lvl->numplatforms = r->numplatforms;
+    lvl->numbounds = r->numbounds;
+
+    // check for rain
+    lvl->rainChance = r->rainChance;
+    if(gameRandBelow(lvl, 100) > lvl->rainChance)
+    {
+        lvl->isRaining = '1';
+    }
+    else
+    {
+        lvl->isRaining = '0';
+    }
+
+    //set level cutomer numbers
+    lvl->levelCustomerNumber = r->customerNumber;
+    lvl->levelCustomerCurrentNumber = r->firstCustomer;
+
+    //collision grid for the new layout
+    buildLevelGrid(lvl);
+    return 1;
+}
+int writeLevelPack(const char *path, const level *levels, int numLevels)
+{
+    //writes the levels out as a pack, returns 1 if it worked
+    int i;
+    levelPackHeader h;
+    int64_t offset = sizeof(levelPackHeader) + (int64_t)numLevels * sizeof(levelRecord);
+
+    FILE *f = fopen(path, "wb");
+    if(f == NULL)
+    {
+        printf("can't write %s\n", path);
+        return 0;
+    }
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, "STXL", 4);
+    h.version = LEVELPACKVERSION;
+    h.numLevels = numLevels;
+    h.segmentSize = sizeof(lseg);
+    int ok = fwrite(&h, sizeof(h), 1, f) == 1;
+
+    for(i = 0; i < numLevels && ok; i++)
+    {
+        levelRecord r;
+        memset(&r, 0, sizeof(r));
+        r.offset = offset;
+        r.numplatforms = levels[i].numplatforms;
+        r.numbounds = levels[i].numbounds;
+        r.rainChance = levels[i].rainChance;
+        r.customerNumber = levels[i].levelCustomerNumber;
+        r.firstCustomer = levels[i].levelCustomerCurrentNumber;
+        ok = fwrite(&r, sizeof(r), 1, f) == 1;
+        offset += ((int64_t)r.numplatforms + r.numbounds) * sizeof(lseg);
+    }
+    for(i = 0; i < numLevels && ok; i++)
+    {
+        //lpad is just a line segment, so pads and boundary lines are written the same way
+        ok = fwrite(levels[i].platforms, sizeof(lpad), levels[i].numplatforms, f) == (size_t)levels[i].numplatforms
+            && fwrite(levels[i].bounds, sizeof(lseg), levels[i].numbounds, f) == (size_t)levels[i].numbounds;
+    }
+    if(fclose(f) != 0 || !ok)
+    {
+        printf("error writing %s\n", path);
+        return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,46 @@
+#ifndef LEVELPACK_H
+#define LEVELPACK_H
+//level pack files: many levels compiled into one binary file (by levelc, from the text files in levels/)
+//the file is memory mapped and a level's segment arrays are used straight from the mapping, with nothing to parse
+#include <stddef.h>
+#include <stdint.h>
+#include "spacetaxi.h"
+
+#define LEVELPACKVERSION 1
+
+typedef struct
+{
+    //the start of a level pack file, followed by numLevels levelRecords
+    char magic[4];       //"STXL"
+    int32_t version;     //LEVELPACKVERSION
+    int32_t numLevels;
+    int32_t segmentSize; //sizeof(lseg) on the machine that wrote it, files with different doubles are refused
+}levelPackHeader;
+
+typedef struct
+{
+    //one level in the pack's table
+    int64_t offset;         //where the level's segments start in the file: the landing pads, then the boundary lines
+    int32_t numplatforms;
+    int32_t numbounds;
+    int32_t rainChance;     //the same as in the level struct
+    int32_t customerNumber; //levelCustomerNumber
+    int32_t firstCustomer;  //levelCustomerCurrentNumber at the start of the level
+    int32_t reserved;
+}levelRecord;
+
+typedef struct levelPack
+{
+    //an open level pack
+    char *data;  //the mapped file
+    size_t size;
+    int numLevels;
+    const levelRecord *records;
+}levelPack;
+
+int openLevelPack(levelPack *pack, const char *path);
+void closeLevelPack(levelPack *pack);
+int loadLevel(level *lvl, const levelPack *pack, int n);
+int writeLevelPack(const char *path, const level *levels, int numLevels);
+
+#endif
@@ -0,0 +1,173 @@
+//stage timers and the event ring buffer, see profile.h
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <time.h>
+#include "profile.h"
+
+typedef struct
+{
+    //an event in the ring, with the number of the write that filled it
+    //seq is set last, so a reader can tell a finished event from one still being written (or overwritten)
+    //the fields are atomic too, so a reader racing a writer gets a torn event it throws away rather than undefined behaviour
+    atomic_int stage;
+    atomic_int thread;
+    atomic_llong start;
+    atomic_llong end;
+    atomic_ullong seq;
+}profileSlot;
+
+atomic_int profileEnabled = 0;
+_Thread_local int profileMuted = 0;
+const char *const profileStageNames[NUMSTAGES] = {"frame", "input", "physics", "collision", "customer", "render", "swap", "autopilot"};
+
+static profileSlot ring[PROFILERING];
+static atomic_ullong writes;     //events ever recorded, the next one goes in ring[writes % PROFILERING]
+static atomic_int threadCount;
+static _Thread_local int threadId = -1;
+
+void profileEnable(int on)
+{
+    atomic_store(&profileEnabled, on);
+}
+void profileMuteThread(int muted)
+{
+    //stops (1) or restarts (0) timing on the calling thread only
+    profileMuted = muted;
+}
+long long profileNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+void profileRecord(int stage, long long start, long long end)
+{
+    //claims the next slot, so threads never write the same one, then fills it in
+    if(threadId < 0)
+    {
+        threadId = atomic_fetch_add(&threadCount, 1);
+    }
+    unsigned long long n = atomic_fetch_add_explicit(&writes, 1, memory_order_relaxed);
+    profileSlot *s = &ring[n % PROFILERING];
+    atomic_store_explicit(&s->seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&s->stage, stage, memory_order_relaxed);
+    atomic_store_explicit(&s->thread, threadId, memory_order_relaxed);
+    atomic_store_explicit(&s->start, start, memory_order_relaxed);
+    atomic_store_explicit(&s->end, end, memory_order_relaxed);
+    atomic_store_explicit(&s->seq, n + 1, memory_order_release);
+}
+int profileLatest(profileEvent *events, int maxEvents)
+{
+    //copies up to maxEvents of the newest events, oldest first, and returns how many there were
+    //events being written while this runs are left out
+    unsigned long long end = atomic_load_explicit(&writes, memory_order_acquire);
+    unsigned long long n;
+    int count = 0;
+
+    if(maxEvents > PROFILERING)
+    {
+        maxEvents = PROFILERING;
+    }
+    n = end > (unsigned long long)maxEvents ? end - maxEvents : 0;
+    for(; n < end; n++)
+    {
+        profileSlot *s = &ring[n % PROFILERING];
+        if(atomic_load_explicit(&s->seq, memory_order_acquire) != n + 1)
+        {
+            continue;
+        }
+        events[count].stage = atomic_load_explicit(&s->stage, memory_order_relaxed);
+        events[count].thread = atomic_load_explicit(&s->thread, memory_order_relaxed);
+        events[count].start = atomic_load_explicit(&s->start, memory_order_relaxed);
+        events[count].end = atomic_load_explicit(&s->end, memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        if(atomic_load_explicit(&s->seq, memory_order_relaxed) == n + 1)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+void profileStageAverages(double *ms, int frames)
+{
+    //fills ms[NUMSTAGES] with the milliseconds each stage took per frame, averaged over the last few whole frames
+    static profileEvent events[PROFILERING];
+    int count = profileLatest(events, PROFILERING);
+    int i, seen = 0;
+    long long since = 0;
+
+    for(i = 0; i < NUMSTAGES; i++)
+    {
+        ms[i] = 0;
+    }
+    //finds when the oldest of the frames started, going back from the newest event
+    for(i = count - 1; i >= 0 && seen < frames; i--)
+    {
+        if(events[i].stage == STAGEFRAME)
+        {
+            since = events[i].start;
+            seen++;
+        }
+    }
+    if(seen == 0)
+    {
+        return;
+    }
+    for(i = 0; i < count; i++)
+    {
+        if(events[i].start >= since && events[i].stage >= 0 && events[i].stage < NUMSTAGES)
+        {
+            ms[events[i].stage] += (events[i].end - events[i].start) / 1e6;
+        }
+    }
+    for(i = 0; i < NUMSTAGES; i++)
+    {
+        ms[i] /= seen;
+    }
+}
+int profileWriteTrace(const char *path)
+{
+    //saves the events in the ring as Chrome trace-event JSON, one complete ("X") event per stage, in microseconds
+    //returns 1 if it was saved
+    FILE *f = fopen(path, "w");
+    profileEvent *events;
+    int count, i;
+
+    if(f == NULL)
+    {
+        printf("can't write trace %s\n", path);
+        return 0;
+    }
+    events = malloc(sizeof(profileEvent) * PROFILERING);
+    if(events == NULL)
+    {
+        printf("out of memory for trace %s\n", path);
+        fclose(f);
+        return 0;
+    }
+    count = profileLatest(events, PROFILERING);
+    long long base = count > 0 ? events[0].start : 0;
+    for(i = 1; i < count; i++)
+    {
+        if(events[i].start < base)
+        {
+            base = events[i].start;
+        }
+    }
+
+    fprintf(f, "{\"traceEvents\":[\n");
+    for(i = 0; i < count; i++)
+    {
+        fprintf(f, "{\"name\":\"%s\",\"cat\":\"spacetaxi\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}%s\n",
+            profileStageNames[events[i].stage], events[i].thread,
+            (events[i].start - base) / 1e3, (events[i].end - events[i].start) / 1e3,
+            i + 1 < count ? "," : "");
+    }
+    fprintf(f, "],\"displayTimeUnit\":\"ms\"}\n");
+    fclose(f);
+    free(events);
+    printf("saved %d profile events to %s\n", count, path);
+    return 1;
+}
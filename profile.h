@@ -0,0 +1,63 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+//timing how long each stage of a frame takes, for finding where stutters come from
+//each timed stage is one event in a ring buffer that any thread can add to without locking,
+//read back for the on-screen overlay (scene.c) or saved as a Chrome trace (open it in chrome://tracing or ui.perfetto.dev)
+//doesn't need SDL or OpenGL, so the simulation can time itself too
+#include <stdatomic.h>
+
+//the stages that can be timed
+#define STAGEFRAME     0 //a whole pass of the main loop
+#define STAGEINPUT     1 //polling SDL events
+#define STAGEPHYSICS   2 //one updateGame() step
+#define STAGECOLLISION 3 //the swept collision tests in doEvents()
+#define STAGECUSTOMER  4 //landing on pads, picking up and dropping off customers
+#define STAGERENDER    5 //building and drawing the frame
+#define STAGESWAP      6 //SDL_GL_SwapWindow(), which includes waiting for vsync
+#define STAGEAUTOPILOT 7 //the autopilot planning a new route
+#define NUMSTAGES      8
+
+//number of events kept, the oldest are overwritten (a power of two)
+#define PROFILERING  16384
+
+typedef struct
+{
+    //one timed stage, times are nanoseconds on the monotonic clock
+    int stage;
+    int thread; //small number for the thread that recorded it, in the order threads first recorded something
+    long long start;
+    long long end;
+}profileEvent;
+
+//set by profileEnable(), checked before every timer so they cost almost nothing when off
+extern atomic_int profileEnabled;
+//set for threads that shouldn't record anything, like the autopilot's workers running thousands of practice steps
+extern _Thread_local int profileMuted;
+
+void profileEnable(int on);
+void profileMuteThread(int muted);
+long long profileNow(void);
+void profileRecord(int stage, long long start, long long end);
+int profileLatest(profileEvent *events, int maxEvents);
+void profileStageAverages(double *ms, int frames);
+int profileWriteTrace(const char *path);
+extern const char *const profileStageNames[NUMSTAGES];
+
+//put profileStart() before a stage and profileEnd() after it:
+//    long long p = profileStart();
+//    doEvents(...);
+//    profileEnd(STAGECOLLISION, p);
+static inline long long profileStart(void)
+{
+    return (atomic_load_explicit(&profileEnabled, memory_order_relaxed) && profileMuted == 0) ? profileNow() : 0;
+}
+static inline void profileEnd(int stage, long long start)
+{
+    //start is 0 if profiling was off when the stage began
+    if(start != 0)
+    {
+        profileRecord(stage, start, profileNow());
+    }
+}
+
+#endif
@@ -0,0 +1,100 @@
+//the rain particles, see rain.h
+#include <stdlib.h>
+#include "rain.h"
+
+//length of each drop's streak, in milliseconds of its movement
+#define STREAKMS 12.0f
+
+static float randomFloat(unsigned int *state, float low, float high)
+{
+    //small xorshift generator, so starting the rain doesn't use up the game's rand() numbers
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return low + (high - low) * (*state / 4294967296.0f);
+}
+
+void initRain(rainSystem *rain, int drops)
+{
+    //makes the drops, spread over the whole area so the rain is already falling when it starts
+    //all four arrays are one allocation
+    unsigned int state = 2463534242u;
+    int i;
+
+    if(drops < 0)
+    {
+        drops = 0;
+    }
+    if(drops > RAINMAXDROPS)
+    {
+        drops = RAINMAXDROPS;
+    }
+    rain->count = drops;
+    rain->x = malloc(sizeof(float) * 4 * (drops > 0 ? drops : 1));
+    if(rain->x == NULL)
+    {
+        //out of memory, so no rain
+        rain->y = rain->vx = rain->vy = NULL;
+        rain->count = 0;
+        return;
+    }
+    rain->y = rain->x + drops;
+    rain->vx = rain->y + drops;
+    rain->vy = rain->vx + drops;
+    for(i = 0; i < drops; i++)
+    {
+        rain->x[i] = randomFloat(&state, RAINLEFT, RAINRIGHT);
+        rain->y[i] = randomFloat(&state, RAINBOTTOM, RAINTOP);
+        //a little wind, and different speeds so the drops don't fall in rows
+        rain->vx[i] = randomFloat(&state, 0.05f, 0.1f);
+        rain->vy[i] = -randomFloat(&state, 0.35f, 0.6f);
+    }
+}
+void freeRain(rainSystem *rain)
+{
+    free(rain->x);
+    rain->x = rain->y = rain->vx = rain->vy = NULL;
+    rain->count = 0;
+}
+void updateRain(rainSystem *rain, double ms)
+{
+    //moves every drop, wrapping drops that leave the area back round to the other side
+    //no branches or function calls in the loop, so it runs several drops per instruction
+    float *restrict x = rain->x;
+    float *restrict y = rain->y;
+    const float *restrict vx = rain->vx;
+    const float *restrict vy = rain->vy;
+    float dt = ms;
+    int count = rain->count;
+    int i;
+
+    for(i = 0; i < count; i++)
+    {
+        float nx = x[i] + vx[i] * dt;
+        float ny = y[i] + vy[i] * dt;
+        x[i] = nx - (nx > RAINRIGHT) * (RAINRIGHT - RAINLEFT);
+        y[i] = ny + (ny < RAINBOTTOM) * (RAINTOP - RAINBOTTOM);
+    }
+}
+void drawRain(drawList *dl, const rainSystem *rain)
+{
+    //adds a short blue streak behind each drop, all in one go into the draw list's lines
+    vertex *v = vertexListAdd(&dl->lines, rain->count * 2);
+    int i;
+
+    if(v == NULL)
+    {
+        return;
+    }
+    for(i = 0; i < rain->count; i++, v += 2)
+    {
+        v[0].x = rain->x[i];
+        v[0].y = rain->y[i];
+        v[1].x = rain->x[i] - rain->vx[i] * STREAKMS;
+        v[1].y = rain->y[i] - rain->vy[i] * STREAKMS;
+        v[0].r = v[1].r = 0;
+        v[0].g = v[1].g = 255;
+        v[0].b = v[1].b = 255;
+        v[0].a = v[1].a = 255;
+    }
+}
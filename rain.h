@@ -0,0 +1,33 @@
+#ifndef RAIN_H
+#define RAIN_H
+//rain as falling particles, instead of random lines flickering each frame
+//the drops are kept struct-of-arrays, so moving them all is one simple loop the compiler can vectorise
+//only for drawing, the rain never touches the simulation
+#include "drawlist.h"
+
+//drops made when the renderer starts, unless changed with --rain
+#define RAINDROPS    2000
+//most drops allowed
+#define RAINMAXDROPS 65536
+//the area the rain falls in, drops leaving the bottom come back in at the top
+#define RAINLEFT     0.0f
+#define RAINRIGHT    800.0f
+#define RAINBOTTOM   100.0f
+#define RAINTOP      600.0f
+
+typedef struct
+{
+    //the rain drops, one entry per drop in each array
+    int count;
+    float *x;
+    float *y;
+    float *vx; //speed in pixels per millisecond
+    float *vy;
+}rainSystem;
+
+void initRain(rainSystem *rain, int drops);
+void freeRain(rainSystem *rain);
+void updateRain(rainSystem *rain, double ms);
+void drawRain(drawList *dl, const rainSystem *rain);
+
+#endif
@@ -0,0 +1,98 @@
+//drawing a frame of the game through whichever backend the renderer has
+//the level's boundary lines are handed over a chunk at a time, only for the chunks on screen,
+//everything else is rebuilt each frame
+#include <stddef.h>
+#include "render.h"
+
+//until a backend is given, render() has nothing to draw with
+static const renderBackend noBackend = {NULL, NULL, NULL, NULL, NULL, NULL, NULL};
+
+void initRenderer(renderer *r, int windowWidth, int windowHeight)
+{
+    //sets up the draw lists, then give it a backend with useGLBackend() or useSoftBackend() before drawing
+    drawListInit(&r->frame);
+    drawListInit(&r->screen);
+    initHudCache(&r->hud);
+    initProfileOverlay(&r->overlay);
+    r->showProfile = '0';
+    initRain(&r->rain, RAINDROPS);
+    initCamera(&r->cam, windowWidth, windowHeight);
+    r->fleet = NULL;
+    r->numFleet = 0;
+    initLevelChunks(&r->chunks);
+    r->backend = noBackend;
+}
+static void newLevel(renderer *r, level *lvl)
+{
+    //a new level: the backend forgets the old level's chunks, and the camera starts at its bottom left
+    //(it moves to the taxi on the first frame)
+    if(r->backend.newLevel != NULL)
+    {
+        r->backend.newLevel(r->backend.target);
+    }
+    r->cam.x = lvl->extent.x1;
+    r->cam.y = lvl->extent.y1;
+}
+void loadLevelRenderer(renderer *r, level *lvl)
+{
+    //splits the level's boundary lines into chunks, call after a level has been made
+    loadLevelChunks(&r->chunks, lvl);
+    newLevel(r, lvl);
+}
+void loadCavernRenderer(renderer *r, level *lvl, const cavern *c)
+{
+    //like loadLevelRenderer(), but the lines are made from the cavern as the camera comes to them
+    //rather than taken from the level, as the simulation thread keeps changing those
+    loadCavernChunks(&r->chunks, lvl, c);
+    newLevel(r, lvl);
+}
+void freeRenderer(renderer *r)
+{
+    //frees the draw lists, the backend is freed by whoever made it
+    freeLevelChunks(&r->chunks);
+    drawListFree(&r->frame);
+    drawListFree(&r->screen);
+    freeHudCache(&r->hud);
+    freeProfileOverlay(&r->overlay);
+    freeRain(&r->rain);
+}
+void render(taxi *t, level *lvl, renderer *r)
+{
+    //this function draws all the level information to the screen
+    //the rain and HUD are drawn first, where they are on the screen, and then the level through the camera
+    //(whatever is drawn first at a pixel stays on top, so the HUD is never hidden)
+    //only the chunks of the level on screen are drawn, the platforms and taxis are rebuilt each frame
+    int pads[MAXVISIBLEPADS];
+    int found[MAXVISIBLECHUNKS];
+    const renderBackend *b = &r->backend;
+    int i, n;
+
+    b->begin(b->target);
+    drawListClear(&r->screen);
+    if(lvl->isRaining == '1')
+    {
+        drawRain(&r->screen, &r->rain);
+    }
+    buildHud(&r->screen, &r->hud, t, lvl);
+    if(r->showProfile == '1')
+    {
+        buildProfileOverlay(&r->screen, &r->overlay);
+    }
+    b->drawScreen(b->target, &r->screen);
+
+    //the camera follows the taxi, for levels bigger than the window
+    followCamera(&r->cam, lvl, t->x, t->y);
+    bbox view = cameraView(&r->cam);
+
+    n = visibleChunks(&r->chunks, view, found, MAXVISIBLECHUNKS);
+    for(i = 0; i < n; i++)
+    {
+        b->drawChunk(b->target, found[i], &r->chunks.chunks[found[i]].lines, r->cam.x, r->cam.y);
+    }
+    drawListClear(&r->frame);
+    buildScene(&r->frame, t, lvl, pads, visiblePads(&r->chunks, view, pads, MAXVISIBLEPADS));
+    buildFleet(&r->frame, r->fleet, r->numFleet, view);
+    b->drawLevel(b->target, &r->frame, r->cam.x, r->cam.y);
+
+    b->end(b->target);
+}
@@ -0,0 +1,48 @@
+#ifndef RENDER_H
+#define RENDER_H
+//drawing a frame of the game: the draw lists are built here the same way whatever draws them, and handed to a backend,
+//OpenGL vertex buffers in a window (glrender.h) or the software rasterizer into memory (softrender.h)
+//no OpenGL in here, so it builds into the headless version too
+#include "spacetaxi.h"
+#include "drawlist.h"
+#include "scene.h"
+#include "rain.h"
+#include "camera.h"
+
+typedef struct
+{
+    //what render() draws with, filled in by useGLBackend() or useSoftBackend()
+    //lists are drawn in the order they're handed over, and whatever is drawn first at a pixel stays on top
+    void *target; //the backend's own state, passed to each of these
+    void (*begin)(void *target); //clears the picture for a new frame
+    void (*drawScreen)(void *target, const drawList *dl); //a list drawn where it is on the screen
+    //a chunk of the level's boundary lines (camera.h), which never change so the backend can keep them from frame to frame
+    void (*drawChunk)(void *target, int chunk, const drawList *lines, double camX, double camY);
+    void (*drawLevel)(void *target, const drawList *dl, double camX, double camY); //a list drawn through the camera
+    void (*end)(void *target); //the frame is finished
+    void (*newLevel)(void *target); //the chunks are of a new level, so any kept from the old one are no use
+}renderBackend;
+
+typedef struct
+{
+    //everything needed to draw the game
+    drawList frame;      //rebuilt every frame: the taxi and platforms, drawn through the camera
+    drawList screen;     //rebuilt every frame: rain and HUD, drawn where they are on the screen
+    hudCache hud;        //HUD text, laid out again only when it changes
+    profileOverlay overlay; //stage timings, drawn over the game if showProfile is (1)
+    char showProfile;
+    rainSystem rain;     //drawn when the level has rain on, moved by updateRain()
+    camera cam;          //follows the taxi round levels bigger than the window
+    const taxi *fleet;   //the fleet's taxis (fleet mode), drawn after the player's, which stays on top of them
+    int numFleet;
+    levelChunks chunks;  //the level's boundary lines and platforms, split up so only those on screen are drawn
+    renderBackend backend;
+}renderer;
+
+void initRenderer(renderer *r, int windowWidth, int windowHeight);
+void loadLevelRenderer(renderer *r, level *lvl);
+void loadCavernRenderer(renderer *r, level *lvl, const cavern *c);
+void freeRenderer(renderer *r);
+void render(taxi *t, level *lvl, renderer *r);
+
+#endif
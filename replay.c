@@ -0,0 +1,188 @@
+//recording and playing back games, see replay.h
+#include <stdlib.h>
+#include <string.h>
+#include "replay.h"
+
+//the most steps a recording can hold, as the step number shares 32 bits with the controls
+#define MAXREPLAYTICKS 0x0fffffffu
+
+static int encodeInput(const taxiInput *in)
+{
+    //the controls in 4 bits: up thrust, left, right, and toggling the wheels
+    int code = 0;
+    if(in->vThrust > 0)
+    {
+        code |= 1;
+    }
+    if(in->hThrust < 0)
+    {
+        code |= 2;
+    }
+    else if(in->hThrust > 0)
+    {
+        code |= 4;
+    }
+    if(in->toggleWheels == 1)
+    {
+        code |= 8;
+    }
+    return code;
+}
+static void decodeInput(int code, taxiInput *in)
+{
+    in->vThrust = (code & 1) ? 1 : 0;
+    in->hThrust = (code & 2) ? -1 : ((code & 4) ? 1 : 0);
+    in->toggleWheels = (code & 8) ? 1 : 0;
+}
+
+uint64_t stepChecksum(uint64_t checksum, const taxi *t)
+{
+    //mixes the taxi's position and speed into a running checksum (FNV-1a over their bytes)
+    double state[4] = {t->x, t->y, t->vSpeed, t->hSpeed};
+    const unsigned char *bytes = (const unsigned char *)state;
+    size_t i;
+    for(i = 0; i < sizeof(state); i++)
+    {
+        checksum = (checksum ^ bytes[i]) * 1099511628211ULL;
+    }
+    return checksum;
+}
+
+int startRecording(inputRecorder *r, const char *path, unsigned int seed, double stepMs)
+{
+    //opens a recording file, returns 1 if it worked
+    //the header is written again with the final numbers by stopRecording()
+    memset(&r->h, 0, sizeof(r->h));
+    memcpy(r->h.magic, "STXR", 4);
+    r->h.version = REPLAYVERSION;
+    r->h.seed = seed;
+    r->h.stepMs = stepMs;
+    r->h.checksum = 14695981039346656037ULL;
+    r->lastInput = -1;
+
+    r->f = fopen(path, "wb");
+    if(r->f == NULL || fwrite(&r->h, sizeof(r->h), 1, r->f) != 1)
+    {
+        printf("can't write recording %s\n", path);
+        if(r->f != NULL)
+        {
+            fclose(r->f);
+            r->f = NULL;
+        }
+        return 0;
+    }
+    return 1;
+}
+void recordStep(inputRecorder *r, unsigned int tick, const taxiInput *in, const taxi *t)
+{
+    //call after every step with the controls it used and the taxi it left, only changes to the controls are written
+    int code = encodeInput(in);
+    if(r->f == NULL)
+    {
+        return;
+    }
+    r->h.checksum = stepChecksum(r->h.checksum, t);
+    if(code == r->lastInput || tick > MAXREPLAYTICKS)
+    {
+        return;
+    }
+    uint32_t event = (uint32_t)tick << 4 | code;
+    if(fwrite(&event, sizeof(event), 1, r->f) == 1)
+    {
+        r->h.numEvents++;
+        r->lastInput = code;
+    }
+}
+void stopRecording(inputRecorder *r, unsigned int ticks, int result, const taxi *t)
+{
+    //notes how the game ended in the header and closes the file
+    if(r->f == NULL)
+    {
+        return;
+    }
+    r->h.numTicks = ticks;
+    r->h.result = result;
+    r->h.money = t->money;
+    r->h.x = t->x;
+    r->h.y = t->y;
+    r->h.lives = t->lives;
+    r->h.levelCurrent = t->levelCurrent;
+    fseek(r->f, 0, SEEK_SET);
+    fwrite(&r->h, sizeof(r->h), 1, r->f);
+    fclose(r->f);
+    r->f = NULL;
+}
+
+int loadReplay(replay *rp, const char *path)
+{
+    //reads a whole recording into memory, returns 1 if it worked
+    rp->events = NULL;
+    rp->next = 0;
+
+    FILE *f = fopen(path, "rb");
+    if(f == NULL)
+    {
+        printf("can't open recording %s\n", path);
+        return 0;
+    }
+    if(fread(&rp->h, sizeof(rp->h), 1, f) != 1 || memcmp(rp->h.magic, "STXR", 4) != 0 || rp->h.version != REPLAYVERSION)
+    {
+        printf("%s is not a version %d recording\n", path, REPLAYVERSION);
+        fclose(f);
+        return 0;
+    }
+    rp->events = malloc(sizeof(uint32_t) * (rp->h.numEvents + 1));
+    if(rp->events == NULL || fread(rp->events, sizeof(uint32_t), rp->h.numEvents, f) != rp->h.numEvents)
+    {
+        printf("%s is cut short\n", path);
+        freeReplay(rp);
+        fclose(f);
+        return 0;
+    }
+    fclose(f);
+    return 1;
+}
+void replayInput(replay *rp, unsigned int tick, taxiInput *in)
+{
+    //sets the controls for this step, call once per step with increasing ticks
+    while(rp->next < rp->h.numEvents && (rp->events[rp->next] >> 4) <= tick)
+    {
+        decodeInput(rp->events[rp->next] & 15, in);
+        rp->next++;
+    }
+}
+unsigned int playReplay(replay *rp, const levelPack *pack, taxi *t, level *lvl, int *result, uint64_t *checksum)
+{
+    //plays the whole recording as fast as possible, leaving the game as it ended
+    //returns the number of steps played, with the last updateGame() result in result and the checksum of every step
+    unsigned int tick;
+    taxiInput input = {0.0, 0.0, 0};
+
+    rp->next = 0;
+    *result = GAMEPLAYING;
+    *checksum = 14695981039346656037ULL;
+    startGame(t, lvl, pack, rp->h.seed);
+    for(tick = 0; tick < rp->h.numTicks; tick++)
+    {
+        replayInput(rp, tick, &input);
+        *result = updateGame(t, lvl, pack, &input, rp->h.stepMs);
+        *checksum = stepChecksum(*checksum, t);
+        if(*result == GAMEOVER || *result == GAMEWON)
+        {
+            tick++;
+            break;
+        }
+    }
+    return tick;
+}
+int replayMatches(const replay *rp, unsigned int ticks, int result, const taxi *t, uint64_t checksum)
+{
+    //1 if a played back game went exactly as the recorded one did
+    return ticks == rp->h.numTicks && checksum == rp->h.checksum && result == rp->h.result && t->money == rp->h.money && t->x == rp->h.x
+        && t->y == rp->h.y && t->lives == rp->h.lives && t->levelCurrent == rp->h.levelCurrent;
+}
+void freeReplay(replay *rp)
+{
+    free(rp->events);
+    rp->events = NULL;
+}
@@ -0,0 +1,61 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+//recording a game's controls, and playing them back without a window
+//a game started with startGame() and a seed, stepped by updateGame() with a fixed step, always plays out the
+//same for the same controls, so a recording only needs the seed and the steps where the controls changed
+#include <stdio.h>
+#include <stdint.h>
+#include "spacetaxi.h"
+#include "levelpack.h"
+
+#define REPLAYVERSION 2
+
+typedef struct
+{
+    //the start of a recording file, followed by numEvents control changes
+    //each change is one 32 bit number: the step it happens on times 16, plus the controls (see encodeInput in replay.c)
+    char magic[4];      //"STXR"
+    int32_t version;    //REPLAYVERSION
+    uint32_t seed;      //the seed given to startGame()
+    uint32_t numEvents;
+    double stepMs;      //the fixed step, in milliseconds
+
+    //how the game went, so a replay can be checked against it
+    uint64_t checksum;  //of the taxi's position and speed after every step
+    uint32_t numTicks;  //steps the game ran for
+    int32_t result;     //the last thing updateGame() returned
+    double money;
+    double x;
+    double y;
+    int32_t lives;
+    int32_t levelCurrent;
+}replayHeader;
+
+typedef struct
+{
+    //a recording being written
+    FILE *f;
+    replayHeader h;
+    int lastInput; //the last controls written, -1 before the first
+}inputRecorder;
+
+typedef struct
+{
+    //a recording loaded for playing back
+    replayHeader h;
+    uint32_t *events;
+    uint32_t next; //the next event to play
+}replay;
+
+int startRecording(inputRecorder *r, const char *path, unsigned int seed, double stepMs);
+void recordStep(inputRecorder *r, unsigned int tick, const taxiInput *in, const taxi *t);
+void stopRecording(inputRecorder *r, unsigned int ticks, int result, const taxi *t);
+
+int loadReplay(replay *rp, const char *path);
+void replayInput(replay *rp, unsigned int tick, taxiInput *in);
+unsigned int playReplay(replay *rp, const levelPack *pack, taxi *t, level *lvl, int *result, uint64_t *checksum);
+int replayMatches(const replay *rp, unsigned int ticks, int result, const taxi *t, uint64_t checksum);
+uint64_t stepChecksum(uint64_t checksum, const taxi *t);
+void freeReplay(replay *rp);
+
+#endif
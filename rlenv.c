@@ -0,0 +1,313 @@
+//the reinforcement learning environment, see rlenv.h
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "spacetaxi.h"
+#include "levelpack.h"
+#include "autopilot.h"
+#include "rlenv.h"
+
+//steps in an episode, unless rlCreate() is given another number
+#define RLMAXSTEPS 2000
+
+typedef struct
+{
+    //one environment: a game, and how its episode is going
+    taxi t;
+    level lvl;
+    int steps;       //steps played in the episode
+    double money;    //the taxi's money after the last step, for the fare reward
+    int target;      //what the taxi was heading for after the last step (see autopilotTarget()),
+    double distance; //and how far it was, for the progress reward
+}rlGame;
+
+struct rlEnv
+{
+    levelPack pack;
+    //each level in the pack, loaded once with its collision grid, every game on a level shares its arrays and grid
+    //so starting an episode is just copying the level, without allocating anything
+    level *levels;
+    int numLevels;
+    rlGame *games;
+    int numEnvs;
+    double stepMs;
+    int actionRepeat;
+    int maxSteps;
+    int levelNumber;       //the level episodes are played on, or -1 for a level picked by each episode's seed
+    unsigned int nextSeed; //the seed for the next episode to start
+};
+
+//directions of the range finding rays: left, right, up, down, down and left, down and right
+static const double rayDirections[RLRAYS][2] = {
+    {-1.0, 0.0}, {1.0, 0.0}, {0.0, 1.0}, {0.0, -1.0}, {-0.70710678, -0.70710678}, {0.70710678, -0.70710678}
+};
+
+static void targetPoint(const rlGame *g, int target, double *x, double *y)
+{
+    //where the taxi is heading: just above the middle of a pad, or straight up out of the level
+    if(target >= 0)
+    {
+        lseg l = g->lvl.platforms[target].l;
+        *x = (l.x1 + l.x2) / 2;
+        *y = l.y1 - g->t.bb.y1;
+    }
+    else
+    {
+        *x = g->t.x;
+        *y = g->lvl.extent.y2 + 20;
+    }
+}
+static void castRays(const level *lvl, double x, double y, float *out)
+{
+    //how far each ray from (x, y) goes before it meets a line, as a fraction of RLRAYRANGE (at most 1)
+    int found[GRIDMAXFOUND];
+    bbox b = {x - RLRAYRANGE, y - RLRAYRANGE, x + RLRAYRANGE, y + RLRAYRANGE};
+    double nearest[RLRAYS];
+    int numFound = -1, numSegments, i, k;
+
+    if(lvl->grid.numPads == lvl->numplatforms && lvl->grid.numBounds == lvl->numbounds)
+    {
+        numFound = gridQuery(&lvl->grid, b, found, GRIDMAXFOUND);
+    }
+    numSegments = numFound >= 0 ? numFound : lvl->numplatforms + lvl->numbounds;
+    for(k = 0; k < RLRAYS; k++)
+    {
+        nearest[k] = RLRAYRANGE;
+    }
+    for(i = 0; i < numSegments; i++)
+    {
+        lseg l = levelSegment(lvl, numFound >= 0 ? found[i] : i);
+        double ex = l.x2 - l.x1, ey = l.y2 - l.y1;
+        double wx = l.x1 - x, wy = l.y1 - y;
+        for(k = 0; k < RLRAYS; k++)
+        {
+            //the ray (x, y) + s * direction meets the line at l.x1, l.y1 + u * (ex, ey)
+            double dx = rayDirections[k][0], dy = rayDirections[k][1];
+            double cross = dx * ey - dy * ex;
+            if(fabs(cross) < 1e-12)
+            {
+                continue;
+            }
+            double s = (wx * ey - wy * ex) / cross;
+            double u = (wx * dy - wy * dx) / cross;
+            if(s >= 0 && s < nearest[k] && u >= 0 && u <= 1)
+            {
+                nearest[k] = s;
+            }
+        }
+    }
+    for(k = 0; k < RLRAYS; k++)
+    {
+        out[k] = nearest[k] / RLRAYRANGE;
+    }
+}
+static void observe(const rlEnv *env, const rlGame *g, float *out)
+{
+    //writes an environment's observation, laid out as in rlenv.h
+    const taxi *t = &g->t;
+    const bbox *e = &g->lvl.extent;
+    double width = e->x2 - e->x1, height = e->y2 - e->y1;
+    double safe = SAFEVELOCITY;
+    double tx, ty;
+
+    targetPoint(g, g->target, &tx, &ty);
+    out[0] = (t->x - e->x1) / width;
+    out[1] = (t->y - e->y1) / height;
+    out[2] = t->hSpeed / safe;
+    out[3] = t->vSpeed / safe;
+    out[4] = t->wheelLandersEnabled == '1';
+    out[5] = t->inflight == '0' && t->bintact == '1';
+    out[6] = t->custo_waiting == '1';
+    out[7] = (tx - t->x) / width;
+    out[8] = (ty - t->y) / height;
+    out[9] = 1.0 - (double)g->steps / env->maxSteps;
+    castRays(&g->lvl, t->x, t->y, out + 10);
+}
+static void noteTarget(rlGame *g)
+{
+    //what the taxi is heading for now, and how far away it is
+    double tx, ty;
+    g->target = autopilotTarget(&g->t, &g->lvl);
+    targetPoint(g, g->target, &tx, &ty);
+    g->distance = sqrt((tx - g->t.x) * (tx - g->t.x) + (ty - g->t.y) * (ty - g->t.y));
+}
+
+static void startEpisode(rlEnv *env, rlGame *g, unsigned int seed)
+{
+    //a new game on the episode's level, everything random in it comes from the seed
+    //on the pack's first level this plays exactly like startGame() with the same seed
+    int n = env->levelNumber >= 0 ? env->levelNumber : (int)(seed % env->numLevels);
+
+    g->lvl = env->levels[n];
+    seedRandom(&g->lvl, seed);
+    //the random number loadLevel() uses for the rain, so the customers after it come out the same
+    if(gameRandBelow(&g->lvl, 100) > g->lvl.rainChance)
+    {
+        g->lvl.isRaining = '1';
+    }
+    else
+    {
+        g->lvl.isRaining = '0';
+    }
+    customerMakeNext(&g->lvl, 999, 'f');
+    initialiseTaxi(&g->t, 400, 400, 3);
+    g->t.levelCurrent = n + 1;
+    g->steps = 0;
+    g->money = g->t.money;
+    noteTarget(g);
+}
+
+rlEnv *rlCreate(const char *packPath, int numEnvs, double stepMs, int actionRepeat, int maxSteps)
+{
+    //makes numEnvs environments playing the levels in a level pack (levels.bin if packPath is NULL)
+    //each step is actionRepeat physics steps of stepMs milliseconds (0 for the game's 240 a second),
+    //and episodes are cut off after maxSteps steps (0 for RLMAXSTEPS)
+    //returns NULL if the pack can't be opened or there isn't the memory, the games start as if rlReset(env, 1, NULL)
+    int n;
+    rlEnv *env = calloc(1, sizeof(rlEnv));
+    if(env == NULL || numEnvs < 1)
+    {
+        free(env);
+        return NULL;
+    }
+    if(openLevelPack(&env->pack, packPath != NULL ? packPath : "levels.bin") == 0)
+    {
+        free(env);
+        return NULL;
+    }
+    env->numLevels = env->pack.numLevels;
+    env->levels = malloc(sizeof(level) * (env->numLevels + 1));
+    env->games = malloc(sizeof(rlGame) * numEnvs);
+    env->numEnvs = numEnvs;
+    if(env->levels == NULL || env->games == NULL || env->numLevels == 0)
+    {
+        env->numLevels = 0;
+        rlDestroy(env);
+        return NULL;
+    }
+    for(n = 0; n < env->numLevels; n++)
+    {
+        initialiseLevel(&env->levels[n]);
+        loadLevel(&env->levels[n], &env->pack, n);
+    }
+
+    env->stepMs = stepMs > 0 ? stepMs : 1000.0 / 240;
+    env->actionRepeat = actionRepeat > 0 ? actionRepeat : 1;
+    env->maxSteps = maxSteps > 0 ? maxSteps : RLMAXSTEPS;
+    env->levelNumber = -1;
+    rlReset(env, 1, NULL);
+    return env;
+}
+void rlDestroy(rlEnv *env)
+{
+    int n;
+    if(env == NULL)
+    {
+        return;
+    }
+    for(n = 0; n < env->numLevels; n++)
+    {
+        freeLevel(&env->levels[n]);
+    }
+    free(env->levels);
+    free(env->games);
+    closeLevelPack(&env->pack);
+    free(env);
+}
+int rlNumEnvs(const rlEnv *env)
+{
+    return env->numEnvs;
+}
+int rlNumLevels(const rlEnv *env)
+{
+    return env->numLevels;
+}
+int rlObsSize(void)
+{
+    return RLOBSSIZE;
+}
+int rlNumActions(void)
+{
+    return RLNUMACTIONS;
+}
+void rlSetLevel(rlEnv *env, int levelNumber)
+{
+    //plays every episode from now on on one level of the pack (counting from 0), or on any if it's -1
+    env->levelNumber = levelNumber >= 0 && levelNumber < env->numLevels ? levelNumber : -1;
+}
+
+void rlReset(rlEnv *env, unsigned int seed, float *obs)
+{
+    //starts a new episode in every environment, environment i with seed + i (later episodes carry on from
+    //seed + numEnvs), and writes their first observations into obs (numEnvs * RLOBSSIZE floats, or NULL)
+    int i;
+    for(i = 0; i < env->numEnvs; i++)
+    {
+        startEpisode(env, &env->games[i], seed + i);
+        if(obs != NULL)
+        {
+            observe(env, &env->games[i], obs + (size_t)i * RLOBSSIZE);
+        }
+    }
+    env->nextSeed = seed + env->numEnvs;
+}
+void rlStep(rlEnv *env, const int *actions, float *obs, float *rewards, unsigned char *dones)
+{
+    //plays one step in every environment with its action, then writes what it sees into obs (numEnvs * RLOBSSIZE floats),
+    //the reward for the step into rewards and whether its episode ended into dones (numEnvs each)
+    int i, r;
+    for(i = 0; i < env->numEnvs; i++)
+    {
+        rlGame *g = &env->games[i];
+        int action = actions[i] >= 0 && actions[i] < RLNUMACTIONS ? actions[i] : 0;
+        int h = action / 2 % 3;
+        char wheels = action >= 6 ? '1' : '0';
+        taxiInput in;
+        float reward = 0;
+        unsigned char done = RLRUNNING;
+
+        in.vThrust = action % 2;
+        in.hThrust = h == 1 ? -1 : (h == 2 ? 1 : 0);
+        in.toggleWheels = g->t.wheelLandersEnabled != wheels;
+        for(r = 0; r < env->actionRepeat && done == RLRUNNING; r++)
+        {
+            stepGame(&g->t, &g->lvl, &in, env->stepMs);
+            in.toggleWheels = 0;
+            if(g->t.justDied == '1')
+            {
+                reward -= RLCRASHPENALTY;
+                done = RLENDED;
+            }
+            else if(g->t.nextLevel == '1')
+            {
+                //leaving is only rewarded once every customer's been carried
+                reward += g->target == -1 ? RLEXITREWARD : 0;
+                done = RLENDED;
+            }
+        }
+        g->steps++;
+
+        //fares earned, and getting closer to the target (unless it's just changed, as a customer got in or out)
+        int lastTarget = g->target;
+        double lastDistance = g->distance;
+        reward += (g->t.money - g->money) / 100;
+        g->money = g->t.money;
+        noteTarget(g);
+        if(done == RLRUNNING && g->target == lastTarget)
+        {
+            reward += RLPROGRESS * (lastDistance - g->distance) / 100;
+        }
+
+        if(done == RLRUNNING && g->steps >= env->maxSteps)
+        {
+            done = RLTIMEOUT;
+        }
+        if(done != RLRUNNING)
+        {
+            startEpisode(env, g, env->nextSeed++);
+        }
+        observe(env, g, obs + (size_t)i * RLOBSSIZE);
+        rewards[i] = reward;
+        dones[i] = done;
+    }
+}
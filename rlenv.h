@@ -0,0 +1,57 @@
+#ifndef RLENV_H
+#define RLENV_H
+//reinforcement learning environment: many copies of the game stepped together, for training pilots
+//reset and step work on all the environments at once, writing observations, rewards and dones into
+//arrays the caller owns (one row per environment, back to back), so nothing is copied or allocated per step
+//everything in here is plain C types, so the shared library (make libspacetaxienv.so) can be loaded from
+//Python with ctypes and numpy arrays passed straight in, see the README
+//
+//an episode is one level of the pack, it ends when the taxi crashes, leaves through the top of the level
+//(once it has carried all the level's customers), or has been going for maxSteps steps
+//an environment whose episode has ended starts its next one straight away, in the same call to rlStep(),
+//so the observation it returns is the first of the new episode
+
+//floats in each environment's observation:
+//  0, 1   taxi x and y, over the width and height of the level
+//  2, 3   horizontal and vertical speed, over the safe landing speed
+//  4      (1) if the landing wheels are down
+//  5      (1) if landed on a pad
+//  6      (1) if carrying a customer
+//  7, 8   how far the target is in x and y (the waiting customer's pad, their destination, or the exit above),
+//         over the width and height of the level
+//  9      the fraction of the episode's steps left
+//  10-15  how far away the nearest line is left, right, up, down, down and left, and down and right,
+//         over RLRAYRANGE (1 if there's nothing that close)
+#define RLOBSSIZE     16
+#define RLRAYS        6
+#define RLRAYRANGE    200.0
+
+//actions are a number from 0 to RLNUMACTIONS - 1: vertical thrust (0 or 1) + 2 * horizontal thrust
+//(0 none, 1 left, 2 right) + 6 * landing wheels (0 up, 1 down)
+#define RLNUMACTIONS  12
+
+//rewards: the fare for each customer delivered (in pounds), plus RLPROGRESS for every 100 pixels closer
+//to the target (and minus that for going further away), RLEXITREWARD for leaving the level
+//and minus RLCRASHPENALTY for crashing
+#define RLPROGRESS     0.1f
+#define RLEXITREWARD   10.0f
+#define RLCRASHPENALTY 10.0f
+
+//what dones[] holds for each environment after a step
+#define RLRUNNING  0
+#define RLENDED    1 //crashed or left the level
+#define RLTIMEOUT  2 //ran out of steps
+
+typedef struct rlEnv rlEnv;
+
+rlEnv *rlCreate(const char *packPath, int numEnvs, double stepMs, int actionRepeat, int maxSteps);
+void rlDestroy(rlEnv *env);
+int rlNumEnvs(const rlEnv *env);
+int rlNumLevels(const rlEnv *env);
+int rlObsSize(void);
+int rlNumActions(void);
+void rlSetLevel(rlEnv *env, int levelNumber);
+void rlReset(rlEnv *env, unsigned int seed, float *obs);
+void rlStep(rlEnv *env, const int *actions, float *obs, float *rewards, unsigned char *dones);
+
+#endif
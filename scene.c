@@ -0,0 +1,292 @@
+//building the picture of the game as lists of lines and triangles (see drawlist.h)
+//no OpenGL in here, the lists are handed to the renderer in one go each frame
+#include <stdio.h>
+#include <stdlib.h>
+#include "spacetaxi.h"
+#include "drawlist.h"
+#include "font.h"
+#include "scene.h"
+#include "profile.h"
+
+//outlines of the taxi, as triangle fans around its centre
+//facing left/right, with and without the landing wheels
+static const double taxiLeft[] = {
+    13.0,12.0,  16.0,3.0,  25.0,3.0,  25.0,-6.0, //values here have been - 1 to center
+    -26.0,-6.0,  -26.0,0.0,  -14.0,3.0,  -8.0,12.0
+};
+static const double taxiLeftWheels[] = {
+    13.0,12.0,  16.0,3.0,  25.0,3.0,  25.0,-6.0, //values here have been - 1 to center
+    22.0,-6.0,  17.0,-9.0,  13.0,-9.0,  10.0,-6.0,
+    -5.0,-6.0,  -8.0,-9.0,  -14.0,-9.0,  -17.0,-6.0,
+    -26.0,-6.0,  -26.0,0.0,  -14.0,3.0,  -8.0,12.0
+};
+static const double taxiRight[] = {
+    -13.0,12.0,  -16.0,3.0,  -25.0,3.0,  -25.0,-6.0, //values here have been + 1 to center
+    26.0,-6.0,  26.0,0.0,  14.0,3.0,  8.0,12.0
+};
+static const double taxiRightWheels[] = {
+    -13.0,12.0,  -16.0,3.0,  -25.0,3.0,  -25.0,-6.0,
+    -22.0,-6.0,  -19.0,-9.0,  -13.0,-9.0,  -10.0,-6.0, //values here have been + 1 to center
+    5.0,-6.0,  8.0,-9.0,  14.0,-9.0,  17.0,-6.0,
+    26.0,-6.0,  26.0,0.0,  14.0,3.0,  8.0,12.0
+};
+
+static void drawTaxiShape(drawList *dl, const taxi *t)
+{
+    //the taxi's shape, facing the way it's going and with its wheels up or down, in the current colour
+	if(t->direction == 'l')
+	{
+        if(t->wheelLandersEnabled == '0')
+        {
+            drawListFan(dl, taxiLeft, sizeof(taxiLeft) / sizeof(double) / 2, t->x, t->y); /* draw Taxi */
+        }
+        else
+        {
+            drawListFan(dl, taxiLeftWheels, sizeof(taxiLeftWheels) / sizeof(double) / 2, t->x, t->y); /* draw Taxi with landing wheels */
+        }
+	}
+	else
+	{
+        if(t->wheelLandersEnabled == '0')
+        {
+            drawListFan(dl, taxiRight, sizeof(taxiRight) / sizeof(double) / 2, t->x, t->y); /* draw Taxi */
+        }
+        else
+        {
+            drawListFan(dl, taxiRightWheels, sizeof(taxiRightWheels) / sizeof(double) / 2, t->x, t->y); /* draw Taxi with landing wheels */
+        }
+	}
+}
+void drawTaxi(drawList *dl, taxi *t, level *lvl)
+{
+    //this function adds the taxi to the draw list, at its current position
+
+    //sets colour of taxi
+    if(t->bintact == '0')
+    {
+        drawListColour(dl, 1.0, 0.0, 0.0); //Taxi is red if destroyed.
+    }
+    else if(lvl->customerWaiting == '1')
+    {
+        drawListColour(dl, 1.0, 1.0, 0.0); /* Taxi is yellow if noone is riding*/
+    }
+    else
+    {
+        drawListColour(dl, 0.0, 1.0, 0.0); /* Taxi is green if someone is riding*/
+    }
+    drawTaxiShape(dl, t);
+}
+void buildFleet(drawList *dl, const taxi *taxis, int numTaxis, bbox view)
+{
+    //adds the fleet's taxis that are on screen (fleet.h) to the draw list, in a duller colour than the player's
+    int i;
+    for(i = 0; i < numTaxis; i++)
+    {
+        const taxi *t = &taxis[i];
+        if(t->x + t->bb.x2 < view.x1 || t->x + t->bb.x1 > view.x2 || t->y + t->bb.y2 < view.y1 || t->y + t->bb.y1 > view.y2)
+        {
+            continue;
+        }
+        if(t->bintact == '0')
+        {
+            drawListColour(dl, 0.6, 0.0, 0.0);
+        }
+        else
+        {
+            drawListColour(dl, 0.0, 0.6, 0.8);
+        }
+        drawTaxiShape(dl, t);
+    }
+}
+
+void initHudCache(hudCache *hud)
+{
+    initHudText(&hud->lives);
+    initHudText(&hud->money);
+    initHudText(&hud->fare);
+    initHudText(&hud->customerText);
+    initHudText(&hud->velocity);
+}
+void freeHudCache(hudCache *hud)
+{
+    freeHudText(&hud->lives);
+    freeHudText(&hud->money);
+    freeHudText(&hud->fare);
+    freeHudText(&hud->customerText);
+    freeHudText(&hud->velocity);
+}
+
+void buildScene(drawList *dl, taxi *t, level *lvl, const int *pads, int numPads)
+{
+    //this function adds the parts of the level that change from frame to frame to the draw list:
+    //the landing platforms given (the ones on screen), customers and the taxi
+    //(the boundary lines never change, so they're in the level's chunks instead (camera.h), and the HUD is in buildHud())
+    int i, k;
+
+    // draw lines
+    // the landing platforms
+    drawListColour(dl, 0.0, 1.0, 0.0);
+    for(k=0;k<numPads;k++)
+    {
+        i = pads[k];
+        //sets the colour of the landing platform
+        if(lvl->customerWaiting == '0' && lvl->currentCustomer.destPlatform == i)
+        {
+            drawListColour(dl, 0.0, 1.0, 0.0); //bright green if it is the destination platform
+        }
+        else
+        {
+            drawListColour(dl, 0.0, 1.0, 0.5); //duller green if not
+        }
+        //print the platform number, caverns have more than 9
+        if(i < 9)
+        {
+            printLetter(dl, i + 1, lvl->platforms[i].l.x1 + 30, lvl->platforms[i].l.y1 - 9);
+        }
+        else
+        {
+            char number[12];
+            printText(dl, number, snprintf(number, sizeof(number), "%d", i + 1), lvl->platforms[i].l.x1 + 30, lvl->platforms[i].l.y1 - 9, 14);
+        }
+        //draw the platform line
+        drawListVertex(dl, lvl->platforms[i].l.x1, lvl->platforms[i].l.y1);
+        drawListVertex(dl, lvl->platforms[i].l.x2, lvl->platforms[i].l.y1);
+        //checks if there is a customer on the platform
+        if(lvl->currentCustomer.fromPlatform == i && lvl->customerWaiting == '1')
+        {
+            //if there is a customer, draws a blue line to represent a person on the platform
+            drawListColour(dl, 0.0, 0.0, 1.0);
+            drawListVertex(dl, lvl->platforms[i].l.x1 + 3, lvl->platforms[i].l.y1 + 3);
+            drawListVertex(dl, lvl->platforms[i].l.x1 + 3, lvl->platforms[i].l.y1 + 8);
+            drawListColour(dl, 0.0, 1.0, 0.0);
+        }
+    }
+
+    //draw taxi
+    drawTaxi(dl, t, lvl);
+}
+
+void buildHud(drawList *dl, hudCache *hud, taxi *t, level *lvl)
+{
+    //this function adds the HUD to the draw list, it stays in the same place on the screen whatever the camera does
+    int i;
+
+    //draw player's lives, in the platforms' green
+    drawListColour(dl, 0.0, 1.0, 0.5);
+    char vv[7] = "Lives ";
+    vv[6] = (t->lives >= 0 && t->lives <= 9) ? '0' + t->lives : ' ';
+    printHudText(dl, &hud->lives, vv, 7, 600, 80, 14);
+
+    //draw player's current money total
+    drawListColour(dl, 0.5, 0.5, 1.0);
+    char money[9];
+    int a = t->money;
+    for(i=8; i >= 0; i--)
+    {
+        money[i] = (a%10 >= 0) ? '0' + a%10 : ' ';
+        a /= 10;
+    }
+    printHudText(dl, &hud->money, money, 9, 14 + 5, 50, 14);
+
+    //draw timer
+    char fare[4];
+    int c = lvl->currentCustomer.fare;
+    for(i=3; i >= 0; i--)
+    {
+        fare[i] = (c%10 >= 0) ? '0' + c%10 : ' ';
+        c /= 10;
+    }
+    printHudText(dl, &hud->fare, fare, 4, 14 + 620, 50, 14);
+
+    //draw customer text
+    char b[24] = "Hey taxi! Platform  !";
+    char v[21] = "Hey taxi! Up!        ";
+    if(lvl->levelCustomerCurrentNumber == lvl->levelCustomerNumber)
+    {
+        printHudText(dl, &hud->customerText, v, 21, 20, 80, 14);
+    }
+    else
+    {
+        int dest = lvl->currentCustomer.destPlatform + 1;
+        int length = 21;
+        if(dest > 9)
+        {
+            //caverns have platforms with longer numbers
+            length = 19 + snprintf(b + 19, sizeof(b) - 19, "%d!", dest);
+            length = length < (int)sizeof(b) ? length : (int)sizeof(b) - 1;
+        }
+        else
+        {
+            b[19] = dest >= 0 ? '0' + dest : ' ';
+        }
+        printHudText(dl, &hud->customerText, b, length, 20, 80, 14);
+    }
+
+    //draw current velocity
+    char bv[13] = "Velocity: ";
+    int tempVel = abs(t->velocity) / 10;
+
+    if(tempVel > 10)
+    {
+        drawListColour(dl, 1.0, 0.0, 0.0);
+    }
+    else if(tempVel > 5)
+    {
+        drawListColour(dl, 1.0, 1.0, 0.0);
+    }
+    else
+    {
+        drawListColour(dl, 0.0, 1.0, 0.0);
+    }
+    
+    bv[12] = '0' + abs(tempVel % 10);
+    tempVel /= 10;
+    bv[11] = '0' + abs(tempVel % 10);
+    tempVel /= 10;
+    bv[10] = '0' + abs(tempVel % 10);
+    printHudText(dl, &hud->velocity, bv, 13, 300, 30, 14);
+}
+
+
+void initProfileOverlay(profileOverlay *o)
+{
+    int i;
+    for(i = 0; i < NUMSTAGES; i++)
+    {
+        initHudText(&o->lines[i]);
+        o->ms[i] = 0;
+    }
+    o->framesUntilUpdate = 0;
+}
+void freeProfileOverlay(profileOverlay *o)
+{
+    int i;
+    for(i = 0; i < NUMSTAGES; i++)
+    {
+        freeHudText(&o->lines[i]);
+    }
+}
+void buildProfileOverlay(drawList *dl, profileOverlay *o)
+{
+    //prints the milliseconds per frame each stage has been taking, in the top left corner
+    //the averages are worked out again every OVERLAYFRAMES frames, in between the cached text is reused
+    int i;
+    if(o->framesUntilUpdate <= 0)
+    {
+        profileStageAverages(o->ms, OVERLAYFRAMES);
+        o->framesUntilUpdate = OVERLAYFRAMES;
+    }
+    o->framesUntilUpdate--;
+
+    drawListColour(dl, 1.0, 1.0, 0.0);
+    for(i = 0; i < NUMSTAGES; i++)
+    {
+        char line[HUDTEXTMAX];
+        int length = snprintf(line, sizeof(line), "%-10s%7.3f", profileStageNames[i], o->ms[i]);
+        if(length > HUDTEXTMAX - 1)
+        {
+            length = HUDTEXTMAX - 1;
+        }
+        printHudText(dl, &o->lines[i], line, length, 10, 590 - i * 22, 12);
+    }
+}
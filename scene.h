@@ -0,0 +1,40 @@
+#ifndef SCENE_H
+#define SCENE_H
+//building the picture of the game as draw lists, without needing OpenGL
+#include "spacetaxi.h"
+#include "drawlist.h"
+#include "font.h"
+#include "profile.h"
+
+typedef struct
+{
+    //the HUD strings, each only laid out again when it changes
+    hudText lives;
+    hudText money;
+    hudText fare;
+    hudText customerText;
+    hudText velocity;
+}hudCache;
+
+//frames the profile overlay averages over, it only changes this often so the numbers can be read
+#define OVERLAYFRAMES 30
+
+typedef struct
+{
+    //the stage timings shown on screen, one HUD string per stage
+    hudText lines[NUMSTAGES];
+    double ms[NUMSTAGES];
+    int framesUntilUpdate;
+}profileOverlay;
+
+void initHudCache(hudCache *hud);
+void freeHudCache(hudCache *hud);
+void drawTaxi(drawList *dl, taxi *t, level *lvl);
+void buildScene(drawList *dl, taxi *t, level *lvl, const int *pads, int numPads);
+void buildFleet(drawList *dl, const taxi *taxis, int numTaxis, bbox view);
+void buildHud(drawList *dl, hudCache *hud, taxi *t, level *lvl);
+void initProfileOverlay(profileOverlay *o);
+void freeProfileOverlay(profileOverlay *o);
+void buildProfileOverlay(drawList *dl, profileOverlay *o);
+
+#endif
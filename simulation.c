@@ -0,0 +1,740 @@
+//the game simulation: taxi movement, collision detection, customers and level building
+//does not use SDL or OpenGL, so it can also be run without a window (see headless.c)
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "spacetaxi.h"
+#include "levelpack.h"
+#include "profile.h"
+#include "dispatch.h"
+
+//all code enclosed by '    /*////////////////////////////////////////////////////////*/
+//comments is code from the example lunar lander game, by Eike Anderson
+
+void pcgSeed(pcg32 *r, unsigned long long seed, unsigned long long stream)
+{
+    //starts a generator, the same seed and stream always give the same numbers
+    r->state = 0;
+    r->inc = (stream << 1) | 1;
+    pcgNext(r);
+    r->state += seed;
+    pcgNext(r);
+}
+unsigned int pcgNext(pcg32 *r)
+{
+    //the next random 32 bit number: steps the 64 bit state, then shuffles its top bits into the output
+    unsigned long long old = r->state;
+    r->state = old * 6364136223846793005ULL + r->inc;
+    unsigned int xorShifted = (unsigned int)(((old >> 18) ^ old) >> 27);
+    unsigned int rot = (unsigned int)(old >> 59);
+    return (xorShifted >> rot) | (xorShifted << ((32 - rot) & 31));
+}
+unsigned int pcgBelow(pcg32 *r, unsigned int n)
+{
+    //a random number from 0 to n-1, by scaling rather than % so it takes one number and never loops
+    //(numbers are off from even by at most n in 4 billion, far too little to matter in the game)
+    return (unsigned int)(((unsigned long long)pcgNext(r) * n) >> 32);
+}
+pcg32 pcgSplit(pcg32 *r)
+{
+    //a new generator seeded from this one, on its own stream, for handing to another simulation
+    pcg32 child;
+    unsigned long long seed = ((unsigned long long)pcgNext(r) << 32) | pcgNext(r);
+    unsigned long long stream = ((unsigned long long)pcgNext(r) << 32) | pcgNext(r);
+    pcgSeed(&child, seed, stream);
+    return child;
+}
+void seedRandom(level *lvl, unsigned int seed)
+{
+    //starts the game's random numbers from a seed, so the same seed and the same controls play the same game
+    pcgSeed(&lvl->rng, seed, 0);
+}
+int gameRand(level *lvl)
+{
+    //the next random number from 0 to 2147483647, for anything that changes how the game plays
+    //used instead of rand() so games don't depend on the C library, or on anything else calling rand()
+    return (int)(pcgNext(&lvl->rng) >> 1);
+}
+int gameRandBelow(level *lvl, int n)
+{
+    //a random number from 0 to n-1 (0 if n isn't above 0)
+    if(n <= 0)
+    {
+        return 0;
+    }
+    return (int)pcgBelow(&lvl->rng, n);
+}
+
+void initialiseLevel(level *lvl)
+{
+    //function to reset the game clock and customer counters before the first level is made
+    lvl->gameTime = 0.0;
+    lvl->currentTimeSecs = 0;
+    seedRandom(lvl, 1);
+
+    lvl->numbounds = 0;
+    lvl->numplatforms = 0;
+    lvl->platforms = NULL;
+    lvl->bounds = NULL;
+    lvl->platformsCapacity = 0;
+    lvl->boundsCapacity = 0;
+    initialiseGrid(&lvl->grid);
+    int windowWidth = WINWIDTH;
+    int windowHeight = WINHEIGHT;
+    lvl->extent.x1 = 0;
+    lvl->extent.y1 = 0;
+    lvl->extent.x2 = windowWidth;
+    lvl->extent.y2 = windowHeight;
+    lvl->customerWaiting = '0';
+    lvl->levelCustomerNumber = 0;
+    lvl->levelCustomerCurrentNumber = 0;
+    lvl->dispatch = NULL;
+}
+
+static int makeRoom(void **array, int *capacity, int count, size_t size)
+{
+    //makes room for one more item at the end of one of the level's arrays, returns 0 if out of memory
+    //arrays still in a level pack are copied out first, so the pack is never changed
+    if(count < *capacity)
+    {
+        return 1;
+    }
+    int newCapacity = *capacity ? *capacity * 2 : 16;
+    while(newCapacity <= count)
+    {
+        newCapacity *= 2;
+    }
+    void *grown;
+    if(*capacity == 0)
+    {
+        grown = malloc(size * newCapacity);
+        if(grown != NULL && count > 0)
+        {
+            memcpy(grown, *array, size * count);
+        }
+    }
+    else
+    {
+        grown = realloc(*array, size * newCapacity);
+    }
+    if(grown == NULL)
+    {
+        return 0;
+    }
+    *array = grown;
+    *capacity = newCapacity;
+    return 1;
+}
+void addBoundary(level *lvl, double x1, double y1, double x2, double y2)
+{
+    //adds a boundary line to the level, call buildLevelGrid() once the level is finished
+    if(makeRoom((void **)&lvl->bounds, &lvl->boundsCapacity, lvl->numbounds, sizeof(lseg)) == 0)
+    {
+        return;
+    }
+    lseg t = {x1, y1, x2, y2};
+    lvl->bounds[lvl->numbounds] = t;
+    lvl->numbounds++;
+}
+void addPad(level *lvl, double x1, double y1, double x2, double y2)
+{
+    //adds just a landing pad, with no underside, for pads sat on the ground
+    if(makeRoom((void **)&lvl->platforms, &lvl->platformsCapacity, lvl->numplatforms, sizeof(lpad)) == 0)
+    {
+        return;
+    }
+    lseg t = {x1, y1, x2, y2};
+    lvl->platforms[lvl->numplatforms].l = t;
+    lvl->numplatforms++;
+}
+void createPlatform(level *lvl, int xStart, int xEnd, int yStart, int yEnd, int num)
+{
+    //function to create a platform and add it to the level struct, based on the platform start and end coordinates
+    //automatically fills in the unserside line segments
+
+    /* first the landing pads */
+    int before = lvl->numplatforms;
+    addPad(lvl, xStart, yStart, xEnd, yEnd);
+    if(lvl->numplatforms == before)
+    {
+        return;
+    }
+	
+    /* then the undersides of the landing pads */
+    addBoundary(lvl, xStart, yStart - 1.0, xStart + 30, yStart - 30);
+    addBoundary(lvl, xStart + 30, yStart - 30, xEnd - 30, yEnd - 30);
+    addBoundary(lvl, xEnd - 30, yEnd - 30, xEnd, yEnd - 1);
+}
+
+void initialiseTaxi(taxi *t, double x, double y, char lives)
+{
+    //function to automatically initialise the given taxi struct
+    t->x = x;
+    t->y = y;
+    t->bb.x1=-26.0;
+	t->bb.y1=-9.0;
+	t->bb.x2= 25.0;
+	t->bb.y2= 12.0;
+
+    t->vSpeed = 0;
+    t->hSpeed = 0;
+    t->vThrust = 0;
+    t->hThrust = 0;
+    t->direction = 'r';
+    t->velocity = 0;
+
+    t->bintact = '1';
+    t->inflight = '1';
+    t->wheelLandersEnabled = '1';
+
+    t->maxFuel = 300.0000;
+    t->fuel = t->maxFuel;
+    t->money = 0.00;
+    t->custo_waiting = '0';
+    t->landingOnceCustoCheck = '0';
+
+    t->justDied = '0';
+    t->lives = lives;
+    t->levelCurrent = 1;
+    t->nextLevel = '0';
+
+    t->bonusGiven = 0;
+}
+void initialiseCustomer(level *lvl, customer *custo, int destpad, int currentpad)
+{
+    //function to automatically initialise the given customer struct
+    custo->fare = gameRandBelow(lvl, 1000) + 1000;
+    custo->timeWaiting = 0;
+    custo->destPlatform = destpad;
+    custo->fromPlatform = currentpad;
+}
+void initialiseBBox(bbox *b, int ax1, int ay1, int ax2, int ay2)
+{
+    //function to initialise the given bounding box with given coordinates
+    b->x1 = ax1;
+    b->y1 = ay1;
+    b->x2 = ax2;
+    b->y2 = ay2;
+}
+bbox getBBox(taxi *t)
+{
+    //function to create a bouding box based on the taxi's bounding box, and then return it
+    bbox b;
+    b.x1 = t->bb.x1+t->x;
+    b.y1 = t->bb.y1+t->y;
+    b.x2 = t->bb.x2+t->x;
+    b.y2 = t->bb.y2+t->y;
+    return b;
+}
+int intersectBBxBB(bbox A, bbox B)
+{
+    /* identify intersection between two bounding boxes, returning 1 for intersection, 0 otherwise */
+    if((A.x1 >= B.x2 || A.x2 <= B.x1 || A.y1 >= B.y2 || A.y2 <= B.y1) || (B.x1 >= A.x2 || B.x2 <= A.x1 || B.y1 >= A.y2 || B.y2 <= A.y1))
+    {
+        return 0;
+    }
+    return 1;
+}
+int intersectLxL(lseg L1, lseg L2)
+{
+    /*////////////////////////////////////////////////////////*/
+    /* basic line-line intersection maths */
+	double D1 = ( (L2.x2-L2.x1)*(L1.y1-L2.y1) - (L2.y2-L2.y1)*(L1.x1-L2.x1) ) / ( (L2.y2-L2.y1)*(L1.x2-L1.x1) - (L2.x2-L2.x1)*(L1.y2-L1.y1) );
+	double D2 = ( (L1.x2-L1.x1)*(L1.y1-L2.y1) - (L1.y2-L1.y1)*(L1.x1-L2.x1) ) / ( (L2.y2-L2.y1)*(L1.x2-L1.x1) - (L2.x2-L2.x1)*(L1.y2-L1.y1) );
+	if (D1 >= 0 && D1 <= 1 && D2 >= 0 && D2 <= 1) return 1; /* intersection */
+	return 0;
+    /*////////////////////////////////////////////////////////*/
+}
+int intersectBBxL(bbox B, lseg Line)
+{
+    /*////////////////////////////////////////////////////////*/
+    int top=0, bottom=0, left=0, right=0; /* intersection with a side of the box */
+	lseg tLine; /* line segment for a side of the box */
+	
+	/* generate a side */
+	tLine.x1 =B.x1; 
+	tLine.y1 =B.y2;
+	tLine.x2 =B.x2;
+	tLine.y2 =B.y2;
+	bottom = intersectLxL(tLine,Line); /* test if it intersects */
+	
+	/* generate a side */
+	tLine.x1 =B.x1;
+	tLine.y1 =B.y1;
+	tLine.x2 =B.x2;
+	tLine.y2 =B.y1;
+	top    = intersectLxL(tLine,Line); /* test if it intersects */
+	
+	/* generate a side */
+	tLine.x1 =B.x1;
+	tLine.y1 =B.y1;
+	tLine.x2 =B.x1;
+	tLine.y2 =B.y2;
+	left   = intersectLxL(tLine,Line); /* test if it intersects */
+	
+	/* generate a side */
+	tLine.x1 =B.x2;
+	tLine.y1 =B.y1;
+	tLine.x2 =B.x2;
+	tLine.y2 =B.y2;
+	right  = intersectLxL(tLine,Line); /* test if it intersects */
+	
+	if(bottom || top || left || right) return 1; /* mark collision/intersection if one of the sides has an intersection */
+	
+    return 0;
+    /*////////////////////////////////////////////////////////*/
+}
+static int sweepAxis(double bMin, double bMax, double sMin, double sMax, double p, double *enter, double *exit)
+{
+    //narrows enter..exit down to the times the moving box and the line overlap along one axis
+    //p is how far the box moves along the axis, returns 0 if they never overlap
+    double lo = sMin - bMax, hi = sMax - bMin; //overlapping while lo <= p*time <= hi
+    if(p == 0)
+    {
+        return lo <= 0 && hi >= 0;
+    }
+    double t1 = lo / p, t2 = hi / p;
+    if(t1 > t2)
+    {
+        double swap = t1;
+        t1 = t2;
+        t2 = swap;
+    }
+    if(t1 > *enter)
+    {
+        *enter = t1;
+    }
+    if(t2 < *exit)
+    {
+        *exit = t2;
+    }
+    return *enter <= *exit;
+}
+double sweepBBxL(bbox B, double dx, double dy, lseg Line)
+{
+    //swept bounding box against a line, the box moving by (dx, dy) over the step
+    //returns the fraction of the move (0 to 1) at which the box first touches the line, or -1 if it doesn't
+    //a box and a line only overlap if they overlap along x, along y and along the line's normal (separating axes)
+    double enter = 0.0, exit = 1.0;
+    double nx = Line.y1 - Line.y2, ny = Line.x2 - Line.x1; //normal to the line
+    double halfW = (B.x2 - B.x1) / 2, halfH = (B.y2 - B.y1) / 2;
+    double centre = (B.x1 + halfW) * nx + (B.y1 + halfH) * ny;
+    double reach = fabs(nx) * halfW + fabs(ny) * halfH;
+    double s = Line.x1 * nx + Line.y1 * ny;
+
+    if(sweepAxis(B.x1, B.x2, fmin(Line.x1, Line.x2), fmax(Line.x1, Line.x2), dx, &enter, &exit)
+        && sweepAxis(B.y1, B.y2, fmin(Line.y1, Line.y2), fmax(Line.y1, Line.y2), dy, &enter, &exit)
+        && sweepAxis(centre - reach, centre + reach, s, s, dx * nx + dy * ny, &enter, &exit))
+    {
+        return enter;
+    }
+    return -1;
+}
+void customerMakeNext(level *lvl, int notPlatform, char death)
+{
+    //function to initialise the next customer in the level struct
+    int r = notPlatform;
+    //sets the destination platform to 1 if there is only one platform, or to a random number if more than one
+    if(lvl->numplatforms == 1)
+    {
+        r = 1;
+    }
+    else
+    {
+        //random number for destination platform is based on the number of platforms
+        //when a platform is ruled out, picks from the others and skips over it, so one random number is always enough
+        if(notPlatform >= 0 && notPlatform < lvl->numplatforms)
+        {
+            r = gameRandBelow(lvl, lvl->numplatforms - 1);
+            if(r >= notPlatform)
+            {
+                r++;
+            }
+        }
+        else
+        {
+            r = gameRandBelow(lvl, lvl->numplatforms);
+        }
+    }
+    int c = -1; //no starting platform for the exit customer
+
+    //sets the destination platform to go up if the customer counter for the level has been reached
+    //otherwise, the customer's staring platform is randomised
+
+    if(death == 'f')
+    {
+        lvl->levelCustomerCurrentNumber ++;
+    }
+
+    if(lvl->levelCustomerCurrentNumber == lvl->levelCustomerNumber)
+    {
+        r = lvl->numplatforms + 1;
+    }
+    else
+    {
+        //might not be working, but meant to loop while the from and destination platforms are the same
+        c = r;
+        //while(c == r)
+        {
+            c = gameRandBelow(lvl, lvl->numplatforms - 1) + 1;
+        }
+    }
+
+    //makes sure the customer is waiting
+    lvl->customerWaiting = '1';
+
+    //initialises the customer, and adds it to the level
+    customer custo;
+    initialiseCustomer(lvl, &custo, r, c);
+    lvl->currentCustomer = custo;
+
+
+
+    ///////// here!!!! make it a list of numbes, shuffled, and the first two numbers picked...
+}
+
+void customerReDestination(customer c)
+{
+
+}
+
+static void padCollision(taxi *t, level *lvl, int i)
+{
+    //the taxi has touched landing pad i: lands if the wheels are down and it's slow enough, otherwise crashes
+    int safeVel = SAFEVELOCITY;
+    lpad *pad = lvl->platforms;
+
+    if(t->wheelLandersEnabled == '1' && t->velocity <= safeVel)
+    {
+        t->inflight = '0';
+        t->vSpeed = 10.0;
+        t->hThrust = 0;
+        t->hSpeed = 0;
+        int y;
+        y = pad[i].l.y1 + (pad[i].l.y2 - pad[i].l.y1)*(t->x-pad[i].l.x1/pad[i].l.x2 - pad[i].l.x1) + 10; 
+        t->y=y;
+
+        if(lvl->dispatch != NULL)
+        {
+            //lots of customers at once, see dispatch.c
+            dispatchLanded(lvl->dispatch, t, lvl, i);
+            return;
+        }
+
+        // customer waiting on platform check
+        if(i == lvl->currentCustomer.fromPlatform && t->landingOnceCustoCheck == '0')
+        {
+            t->custo_current = lvl->currentCustomer;
+            t->custo_waiting = '1';
+            lvl->customerWaiting = '0';
+            t->landingOnceCustoCheck = '1';
+        }
+        
+        if(t->custo_waiting == '1') // check if there is a customer in the taxi
+        {
+            if(lvl->currentCustomer.destPlatform == i)
+            {
+                t->custo_waiting = '0';
+                t->money += t->custo_current.fare;
+                customerMakeNext(lvl, t->custo_current.destPlatform, 'f');
+                t->landingOnceCustoCheck = '0';
+            }
+        }
+    }
+    else
+    {
+        t->justDied = '1';
+        t->inflight = '0';
+        t->bintact = '0';
+    }
+}
+void doEvents(taxi *t, double frames, level *lvl)
+{
+    //this is the place where all the main calculations like movement take place
+    
+    int windowHeight = WINHEIGHT;
+    double h = HORIZONTSTR;double v = VERTICALSTR;double g = GRAVITY;
+    bbox b = getBBox(t);
+    
+    //checks that the taxi hasn't crashed before calculations
+    if(t->bintact == '1')
+    {
+        //movement calculations
+        t->vSpeed-=frames*g;
+        t->vSpeed+=frames*t->vThrust*v;
+        t->hSpeed+=frames*t->hThrust*h;
+        t->velocity = sqrt((t->vSpeed * t->vSpeed) + (t->hSpeed * t->hSpeed));
+
+        //how far the taxi moves this step, only if not on a platform
+        double dx = 0, dy = 0;
+        if(t->inflight == '1')
+        {
+            dx = frames*t->hSpeed;
+            dy = frames*t->vSpeed;
+        }
+
+        //hit detection, sweeping the bounding box along the move so fast taxis can't pass through thin lines
+        int i;
+        int found[GRIDMAXFOUND];
+        double tois[GRIDMAXFOUND]; //when the taxi touches each segment found, kept so they aren't swept again
+        int numFound = -1;
+        int numSegments = lvl->numplatforms + lvl->numbounds;
+        long long collisionTimer = profileStart();
+        //the grid gives just the segments near the whole move, landing pads first
+        if(lvl->grid.numPads == lvl->numplatforms && lvl->grid.numBounds == lvl->numbounds)
+        {
+            bbox sweep = b;
+            sweep.x1 += fmin(dx, 0);
+            sweep.x2 += fmax(dx, 0);
+            sweep.y1 += fmin(dy, 0);
+            sweep.y2 += fmax(dy, 0);
+            numFound = gridQuery(&lvl->grid, sweep, found, GRIDMAXFOUND);
+        }
+        if(numFound >= 0)
+        {
+            numSegments = numFound;
+        }
+        //first find when in the move the taxi first touches something...
+        double first = 2.0;
+        for(i=0;i<numSegments;i++)
+        {
+            double toi = sweepBBxL(b, dx, dy, levelSegment(lvl, numFound >= 0 ? found[i] : i));
+            if(i < GRIDMAXFOUND)
+            {
+                tois[i] = toi;
+            }
+            if(toi >= 0 && toi < first)
+            {
+                first = toi;
+            }
+        }
+        profileEnd(STAGECOLLISION, collisionTimer);
+        if(first > 1.0)
+        {
+            //a clear path
+            t->y+=dy;
+            t->x+=dx;
+        }
+        else
+        {
+            //...then stop it there and land on or crash into whatever it touched
+            t->y+=dy*first;
+            t->x+=dx*first;
+            for(i=0;i<numSegments;i++)
+            {
+                //only a level without a grid has more segments than there are kept times
+                int id = numFound >= 0 ? found[i] : i;
+                double toi = i < GRIDMAXFOUND ? tois[i] : sweepBBxL(b, dx, dy, levelSegment(lvl, id));
+                if(toi < 0 || toi > first + 1e-9)
+                {
+                    continue;
+                }
+                if(id < lvl->numplatforms)
+                {
+                    long long customerTimer = profileStart();
+                    padCollision(t, lvl, id);
+                    profileEnd(STAGECUSTOMER, customerTimer);
+                }
+                else
+                {
+                    t->justDied = '1';
+                    t->inflight = '0';
+                    t->bintact = '0';
+                }
+            }
+        }
+        //exit level above
+        if(b.y1 > lvl->extent.y2)
+        {
+            t->nextLevel = '1';
+        }
+    }
+
+}
+
+void applyInput(taxi *t, const taxiInput *in)
+{
+    //copies the player's controls onto the taxi, doing what the key presses in main() used to do directly
+    if(in->toggleWheels == 1)
+    {
+        //checks if landers are enables, and reverses it
+        if(t->wheelLandersEnabled == '1')
+        {
+            t->wheelLandersEnabled = '0';
+            //puts the lander back in flight in case it was landed
+            t->inflight = '1';
+        }
+        else
+        {
+            t->wheelLandersEnabled = '1';
+        }
+    }
+
+    if(in->vThrust > 0 && t->vThrust <= 0)
+    {
+        //up thruster just switched on: is in air, and no longer landed
+        t->inflight = '1';
+        t->landingOnceCustoCheck = '0';
+    }
+    t->vThrust = in->vThrust;
+
+    //horizontal thrusters only work with the landing wheels up
+    if(in->hThrust == 0 || t->wheelLandersEnabled == '0')
+    {
+        t->hThrust = in->hThrust;
+    }
+
+    //sets the direction of the taxi based on horizontal thruster direction
+    if(t->hThrust < 0)
+	{
+		t->direction = 'l';
+	}
+	else if(t->hThrust > 0)
+	{
+		t->direction = 'r';
+	}
+}
+void advanceClock(level *lvl, double ms)
+{
+    //moves the game clock on by the given number of milliseconds
+    //every whole second that passes takes 10 off the current customer's fare
+    lvl->gameTime += ms;
+    while(lvl->gameTime >= (lvl->currentTimeSecs + 1) * 1000.0)
+    {
+        lvl->currentTimeSecs++;
+        lvl->currentCustomer.fare -= 10;
+    }
+}
+void stepGame(taxi *t, level *lvl, const taxiInput *in, double ms)
+{
+    //advances the whole game by ms milliseconds with the given controls, without needing a window
+    double simSpeed = SIMSPEED;
+
+    applyInput(t, in);
+    advanceClock(lvl, ms);
+    if(lvl->dispatch != NULL)
+    {
+        updateDispatch(lvl->dispatch, t, lvl);
+    }
+
+    //extra life once the player has earnt enough
+    if(t->money > 10000 && t->bonusGiven == 0)
+    {
+        t->lives++;
+        t->bonusGiven = 1;
+    }
+    doEvents(t, ms * simSpeed, lvl);
+}
+void respawnTaxi(taxi *t, level *lvl)
+{
+    //has died: reset taxi flags and give the level a new customer
+    //reset position
+    t->x = 400.0;
+    t->y = 400.0;
+    //decrement lives
+    t->lives--;
+    //now in flight and intact
+    t->inflight = '1';
+    t->bintact = '1';
+    //reset speed and thrusts
+    t->vSpeed = 0.0;
+    t->hSpeed = 0.0;
+    t->vThrust = 0.0;
+    t->hThrust = 0.0;
+    //customer no longer in taxi
+    t->custo_waiting = '0';
+    long long customerTimer = profileStart();
+    customerMakeNext(lvl, 999, 't');
+    profileEnd(STAGECUSTOMER, customerTimer);
+    lvl->customerWaiting = '0';
+    //resets just died flag, no longer dieing
+    t->justDied = '0';
+}
+int loadNextLevel(taxi *t, level *lvl, const levelPack *pack)
+{
+    //increments the level, then loads it from the level pack and resets the taxi
+    //returns 1 if a level was loaded, or 0 if there are no levels left and the game is won
+    int loaded = 1;
+
+    t->levelCurrent++;
+    if(loadLevel(lvl, pack, t->levelCurrent - 1))
+    {
+        //new customer for the new level
+        customerMakeNext(lvl, 999, 't');
+    }
+    else
+    {
+        //end of the game you won what, add stuff in here like and end screen or sumethin' plez future me, k thx bi!
+        loaded = 0;
+        freeLevel(lvl);
+        lvl->isRaining = '0';
+        buildLevelGrid(lvl);
+    }
+    //resets for next level:
+    //reset taxi position
+    t->x = 400.0;
+    t->y = 400.0;
+    //reset thrusts & speed
+    t->vSpeed = 0.0;
+    t->hSpeed = 0.0;
+    t->vThrust = 0.0;
+    t->hThrust = 0.0;
+    //resets next level flag, no longer going to next level
+    t->nextLevel = '0';
+
+    return loaded;
+}
+void startGame(taxi *t, level *lvl, const levelPack *pack, unsigned int seed)
+{
+    //sets up a new game on the pack's first level, everything random in it comes from the seed
+    initialiseLevel(lvl);
+    seedRandom(lvl, seed);
+    loadLevel(lvl, pack, 0);
+    customerMakeNext(lvl, 999, 'f');
+    initialiseTaxi(t, 400, 400, 3);
+}
+int updateGame(taxi *t, level *lvl, const levelPack *pack, const taxiInput *in, double ms)
+{
+    //one step of the whole game: stepGame(), then respawning after a crash or moving on to the next level
+    //returns what happened, one of the GAME... values
+    stepGame(t, lvl, in, ms);
+    if(t->justDied == '1')
+    {
+        if(t->lives > 1)
+        {
+            respawnTaxi(t, lvl);
+            return GAMERESPAWNED;
+        }
+        return GAMEOVER;
+    }
+    if(t->nextLevel == '1')
+    {
+        if(loadNextLevel(t, lvl, pack) == 0)
+        {
+            return GAMEWON;
+        }
+        return GAMENEWLEVEL;
+    }
+    return GAMEPLAYING;
+}
+void freeLevel(level *lvl)
+{
+    //frees the memory the level allocated for itself (its collision grid, and segment arrays not in a level pack)
+    //leaves it with no platforms or boundary lines
+    if(lvl->platformsCapacity > 0)
+    {
+        free(lvl->platforms);
+    }
+    if(lvl->boundsCapacity > 0)
+    {
+        free(lvl->bounds);
+    }
+    lvl->platforms = NULL;
+    lvl->bounds = NULL;
+    lvl->platformsCapacity = 0;
+    lvl->boundsCapacity = 0;
+    lvl->numplatforms = 0;
+    lvl->numbounds = 0;
+    freeGrid(&lvl->grid);
+}
@@ -0,0 +1,524 @@
+//the software backend: rasterizing draw lists into a canvas, and saving it as PPM or PNG (see softrender.h)
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "softrender.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+int initCanvas(canvas *c, int width, int height, double scale)
+{
+    //makes a cleared canvas, returns 0 if out of memory
+    c->width = width > 0 ? width : 1;
+    c->height = height > 0 ? height : 1;
+    c->scale = scale > 0 ? scale : 1.0;
+    c->pixels = malloc(sizeof(unsigned int) * c->width * c->height);
+    if(c->pixels == NULL)
+    {
+        return 0;
+    }
+    clearCanvas(c);
+    return 1;
+}
+void freeCanvas(canvas *c)
+{
+    free(c->pixels);
+    c->pixels = NULL;
+}
+void clearCanvas(canvas *c)
+{
+    //black, with nothing drawn yet
+    memset(c->pixels, 0, sizeof(unsigned int) * c->width * c->height);
+}
+
+static unsigned int vertexColour(const vertex *v)
+{
+    return v->r | (unsigned int)v->g << 8 | (unsigned int)v->b << 16 | CANVASDRAWN;
+}
+static void fillSpan(unsigned int *p, int n, unsigned int colour)
+{
+    //sets the pixels in a row that haven't been drawn yet this frame to colour
+#if defined(__AVX2__)
+    __m256i colour8 = _mm256_set1_epi32((int)colour);
+    __m256i drawn8 = _mm256_set1_epi32((int)CANVASDRAWN);
+    for(; n >= 8; n -= 8, p += 8)
+    {
+        __m256i old = _mm256_loadu_si256((__m256i *)p);
+        __m256i empty = _mm256_cmpeq_epi32(_mm256_and_si256(old, drawn8), _mm256_setzero_si256());
+        _mm256_storeu_si256((__m256i *)p, _mm256_blendv_epi8(old, colour8, empty));
+    }
+#endif
+#if defined(__SSE2__)
+    __m128i colour4 = _mm_set1_epi32((int)colour);
+    __m128i drawn4 = _mm_set1_epi32((int)CANVASDRAWN);
+    for(; n >= 4; n -= 4, p += 4)
+    {
+        __m128i old = _mm_loadu_si128((__m128i *)p);
+        __m128i empty = _mm_cmpeq_epi32(_mm_and_si128(old, drawn4), _mm_setzero_si128());
+        _mm_storeu_si128((__m128i *)p, _mm_or_si128(_mm_and_si128(empty, colour4), _mm_andnot_si128(empty, old)));
+    }
+#endif
+    for(; n > 0; n--, p++)
+    {
+        if((*p & CANVASDRAWN) == 0)
+        {
+            *p = colour;
+        }
+    }
+}
+static void plot(canvas *c, int x, int y, unsigned int colour)
+{
+    if(x >= 0 && x < c->width && y >= 0 && y < c->height && (c->pixels[y * c->width + x] & CANVASDRAWN) == 0)
+    {
+        c->pixels[y * c->width + x] = colour;
+    }
+}
+static void drawLine(canvas *c, double x1, double y1, double x2, double y2, unsigned int colour)
+{
+    //a one pixel wide line between the pixels the ends are in (Bresenham), x and y in canvas pixels from the top left
+    int ax = (int)floor(x1), ay = (int)floor(y1), bx = (int)floor(x2), by = (int)floor(y2);
+    if((ax < 0 && bx < 0) || (ay < 0 && by < 0) || (ax >= c->width && bx >= c->width) || (ay >= c->height && by >= c->height))
+    {
+        return;
+    }
+    int dx = abs(bx - ax), dy = -abs(by - ay);
+    int sx = ax < bx ? 1 : -1, sy = ay < by ? 1 : -1;
+    int err = dx + dy;
+    for(;;)
+    {
+        plot(c, ax, ay, colour);
+        if(ax == bx && ay == by)
+        {
+            break;
+        }
+        int e2 = err * 2;
+        if(e2 >= dy)
+        {
+            err += dy;
+            ax += sx;
+        }
+        if(e2 <= dx)
+        {
+            err += dx;
+            ay += sy;
+        }
+    }
+}
+static double edgeX(const double *a, const double *b, double y)
+{
+    //where the edge from a to b crosses the row at y
+    return a[0] + (b[0] - a[0]) * (y - a[1]) / (b[1] - a[1]);
+}
+static void drawTriangle(canvas *c, const double *p0, const double *p1, const double *p2, unsigned int colour)
+{
+    //fills the pixels whose middles are inside the triangle, a row at a time, x and y in canvas pixels from the top left
+    const double *v[3] = {p0, p1, p2}, *swap;
+    int row, first, last, i;
+
+    //sorted from the top down
+    for(i = 0; i < 3; i++)
+    {
+        int k = i == 1 ? 1 : 0;
+        if(v[k + 1][1] < v[k][1])
+        {
+            swap = v[k];
+            v[k] = v[k + 1];
+            v[k + 1] = swap;
+        }
+    }
+
+    first = (int)ceil(v[0][1] - 0.5);
+    last = (int)ceil(v[2][1] - 0.5) - 1;
+    first = first < 0 ? 0 : first;
+    last = last >= c->height ? c->height - 1 : last;
+    for(row = first; row <= last; row++)
+    {
+        double y = row + 0.5;
+        double xa = edgeX(v[0], v[2], y);
+        double xb = y < v[1][1] ? edgeX(v[0], v[1], y) : edgeX(v[1], v[2], y);
+        int left = (int)ceil(fmin(xa, xb) - 0.5);
+        int right = (int)ceil(fmax(xa, xb) - 0.5);
+        left = left < 0 ? 0 : left;
+        right = right > c->width ? c->width : right;
+        if(right > left)
+        {
+            fillSpan(c->pixels + row * c->width + left, right - left, colour);
+        }
+    }
+}
+void canvasDrawList(canvas *c, const drawList *dl, double xOff, double yOff)
+{
+    //draws the lines and then the triangles, moved by xOff and yOff, with y going up from the bottom like OpenGL
+    //flat shaded, each taking the colour of its last vertex
+    int i, k;
+    double p[3][2];
+
+    for(i = 0; i + 1 < dl->lines.count; i += 2)
+    {
+        const vertex *v = dl->lines.v + i;
+        for(k = 0; k < 2; k++)
+        {
+            p[k][0] = (v[k].x + xOff) * c->scale;
+            p[k][1] = c->height - (v[k].y + yOff) * c->scale;
+        }
+        drawLine(c, p[0][0], p[0][1], p[1][0], p[1][1], vertexColour(&v[1]));
+    }
+    for(i = 0; i + 2 < dl->tris.count; i += 3)
+    {
+        const vertex *v = dl->tris.v + i;
+        for(k = 0; k < 3; k++)
+        {
+            p[k][0] = (v[k].x + xOff) * c->scale;
+            p[k][1] = c->height - (v[k].y + yOff) * c->scale;
+        }
+        drawTriangle(c, p[0], p[1], p[2], vertexColour(&v[2]));
+    }
+}
+
+static void beginSoftFrame(void *target)
+{
+    clearCanvas(target);
+}
+static void drawSoftScreen(void *target, const drawList *dl)
+{
+    canvasDrawList(target, dl, 0, 0);
+}
+static void drawSoftChunk(void *target, int chunk, const drawList *lines, double camX, double camY)
+{
+    //nothing to keep between frames, it's all drawn again anyway
+    (void)chunk;
+    canvasDrawList(target, lines, -camX, -camY);
+}
+static void drawSoftLevel(void *target, const drawList *dl, double camX, double camY)
+{
+    canvasDrawList(target, dl, -camX, -camY);
+}
+static void endSoftFrame(void *target)
+{
+    (void)target;
+}
+void useSoftBackend(renderer *r, canvas *c)
+{
+    //draws the renderer's frames into the canvas, which should be the window's size times its scale
+    r->backend.target = c;
+    r->backend.begin = beginSoftFrame;
+    r->backend.drawScreen = drawSoftScreen;
+    r->backend.drawChunk = drawSoftChunk;
+    r->backend.drawLevel = drawSoftLevel;
+    r->backend.end = endSoftFrame;
+    r->backend.newLevel = NULL;
+}
+
+static void canvasRGB(const canvas *c, int i, unsigned char *rgb)
+{
+    unsigned int p = c->pixels[i];
+    rgb[0] = p & 255;
+    rgb[1] = p >> 8 & 255;
+    rgb[2] = p >> 16 & 255;
+}
+int writePPM(const canvas *c, const char *path)
+{
+    //saves the canvas as a binary PPM, returns 0 if the file couldn't be written
+    FILE *f = fopen(path, "wb");
+    int i, ok;
+    if(f == NULL)
+    {
+        return 0;
+    }
+    fprintf(f, "P6\n%d %d\n255\n", c->width, c->height);
+    for(i = 0; i < c->width * c->height; i++)
+    {
+        unsigned char rgb[3];
+        canvasRGB(c, i, rgb);
+        fwrite(rgb, 1, 3, f);
+    }
+    ok = ferror(f) == 0;
+    return fclose(f) == 0 && ok;
+}
+int readPPM(canvas *c, const char *path)
+{
+    //loads a binary PPM written by writePPM() into a new canvas (every pixel counted as drawn), returns 0 if it couldn't
+    FILE *f = fopen(path, "rb");
+    int width, height, maxValue, i;
+    if(f == NULL)
+    {
+        return 0;
+    }
+    if(fscanf(f, "P6 %d %d %d", &width, &height, &maxValue) != 3 || maxValue != 255 || fgetc(f) == EOF
+       || width <= 0 || height <= 0 || initCanvas(c, width, height, 1.0) == 0)
+    {
+        fclose(f);
+        return 0;
+    }
+    for(i = 0; i < width * height; i++)
+    {
+        unsigned char rgb[3];
+        if(fread(rgb, 1, 3, f) != 3)
+        {
+            freeCanvas(c);
+            fclose(f);
+            return 0;
+        }
+        c->pixels[i] = rgb[0] | (unsigned int)rgb[1] << 8 | (unsigned int)rgb[2] << 16 | CANVASDRAWN;
+    }
+    fclose(f);
+    return 1;
+}
+long long diffCanvas(canvas *diff, const canvas *a, const canvas *b)
+{
+    //counts the pixels whose colours differ between two canvases the same size, or returns -1 if they aren't
+    //diff (if not NULL) is made a new canvas showing them: red where they differ, a dimmed a everywhere else,
+    //or -2 is returned if there's no memory for it
+    long long n = 0;
+    int i;
+    if(a->width != b->width || a->height != b->height)
+    {
+        return -1;
+    }
+    if(diff != NULL && initCanvas(diff, a->width, a->height, 1.0) == 0)
+    {
+        return -2;
+    }
+    for(i = 0; i < a->width * a->height; i++)
+    {
+        unsigned int pa = a->pixels[i] & ~CANVASDRAWN, pb = b->pixels[i] & ~CANVASDRAWN;
+        if(pa != pb)
+        {
+            n++;
+        }
+        if(diff != NULL)
+        {
+            diff->pixels[i] = (pa != pb ? 0x0000ffu : (pa >> 2) & 0x3f3f3fu) | CANVASDRAWN;
+        }
+    }
+    return n;
+}
+
+//PNG: the pixels are compressed with deflate, using its fixed Huffman codes and only looking for repeats of the
+//pixel to the left or the one above, which is most of a picture of lines on black, so no zlib is needed
+
+//lengths and distances of repeats, and how many extra bits follow the code for each (from the deflate spec, RFC 1951)
+static const int lengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const int lengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const int distanceBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073,
+                                     4097, 6145, 8193, 12289, 16385, 24577};
+static const int distanceExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+typedef struct
+{
+    //writes deflate's bit stream into out, least significant bit first
+    unsigned char *out;
+    size_t n;
+    unsigned long long bits;
+    int numBits;
+}bitWriter;
+
+static void putBits(bitWriter *w, unsigned int value, int n)
+{
+    w->bits |= (unsigned long long)value << w->numBits;
+    w->numBits += n;
+    while(w->numBits >= 8)
+    {
+        w->out[w->n++] = w->bits & 255;
+        w->bits >>= 8;
+        w->numBits -= 8;
+    }
+}
+static void putCode(bitWriter *w, unsigned int code, int n)
+{
+    //Huffman codes go in the other way round, most significant bit first
+    unsigned int reversed = 0;
+    int i;
+    for(i = 0; i < n; i++)
+    {
+        reversed = reversed << 1 | (code >> i & 1);
+    }
+    putBits(w, reversed, n);
+}
+static void putSymbol(bitWriter *w, int symbol)
+{
+    //a literal byte (0 to 255), the end of the block (256) or a length code (257 to 285), in the fixed codes
+    if(symbol < 144)
+    {
+        putCode(w, 0x30 + symbol, 8);
+    }
+    else if(symbol < 256)
+    {
+        putCode(w, 0x190 + symbol - 144, 9);
+    }
+    else if(symbol < 280)
+    {
+        putCode(w, symbol - 256, 7);
+    }
+    else
+    {
+        putCode(w, 0xc0 + symbol - 280, 8);
+    }
+}
+static void putRepeat(bitWriter *w, int length, int distance)
+{
+    //the next length bytes are the same as those distance back
+    int i = 28;
+    while(lengthBase[i] > length)
+    {
+        i--;
+    }
+    putSymbol(w, 257 + i);
+    putBits(w, length - lengthBase[i], lengthExtra[i]);
+    i = 29;
+    while(distanceBase[i] > distance)
+    {
+        i--;
+    }
+    putCode(w, i, 5);
+    putBits(w, distance - distanceBase[i], distanceExtra[i]);
+}
+static size_t deflateFixed(const unsigned char *in, size_t n, int pixelBytes, int rowBytes, unsigned char *out)
+{
+    //compresses n bytes into out (which needs room for n + n / 8 + 16) as one fixed Huffman block, returns its size
+    //a repeat of the pixel to the left or the row above is used wherever one is 3 bytes or longer
+    bitWriter w = {out, 0, 0, 0};
+    int distances[2] = {pixelBytes, rowBytes};
+    size_t i = 0;
+    int k;
+
+    putBits(&w, 1, 1); //the last block
+    putBits(&w, 1, 2); //fixed codes
+    while(i < n)
+    {
+        int bestLength = 0, bestDistance = 0;
+        for(k = 0; k < 2; k++)
+        {
+            size_t d = distances[k];
+            int length = 0;
+            if(d > i || d > 32768)
+            {
+                continue;
+            }
+            while(length < 258 && i + length < n && in[i + length] == in[i + length - d])
+            {
+                length++;
+            }
+            if(length > bestLength)
+            {
+                bestLength = length;
+                bestDistance = d;
+            }
+        }
+        if(bestLength >= 3)
+        {
+            putRepeat(&w, bestLength, bestDistance);
+            i += bestLength;
+        }
+        else
+        {
+            putSymbol(&w, in[i]);
+            i++;
+        }
+    }
+    putSymbol(&w, 256);
+    putBits(&w, 0, 7); //the last byte
+    return w.n;
+}
+static unsigned int pngCrc(const unsigned char *data, size_t n, unsigned int crc)
+{
+    //the PNG chunk checksum, a bit at a time as there's only a few kilobytes to check per picture
+    size_t i;
+    int k;
+    crc = ~crc;
+    for(i = 0; i < n; i++)
+    {
+        crc ^= data[i];
+        for(k = 0; k < 8; k++)
+        {
+            crc = crc >> 1 ^ (0xedb88320u & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+static void putBigEndian(unsigned char *p, unsigned int value)
+{
+    p[0] = value >> 24;
+    p[1] = value >> 16 & 255;
+    p[2] = value >> 8 & 255;
+    p[3] = value & 255;
+}
+static void writeChunk(FILE *f, const char *type, const unsigned char *data, size_t n)
+{
+    //a PNG chunk: length, type, data and the checksum of the type and data
+    unsigned char header[8], check[4];
+    putBigEndian(header, n);
+    memcpy(header + 4, type, 4);
+    putBigEndian(check, pngCrc(data, n, pngCrc(header + 4, 4, 0)));
+    fwrite(header, 1, 8, f);
+    fwrite(data, 1, n, f);
+    fwrite(check, 1, 4, f);
+}
+int writePNG(const canvas *c, const char *path)
+{
+    //saves the canvas as an 8 bit RGB PNG, returns 0 if out of memory or the file couldn't be written
+    static const unsigned char signature[8] = {137, 'P', 'N', 'G', '\r', '\n', 26, '\n'};
+    int rowBytes = 1 + c->width * 3, x, y, ok;
+    size_t rawSize = (size_t)rowBytes * c->height;
+    unsigned char *raw = malloc(rawSize);
+    unsigned char *z = malloc(rawSize + rawSize / 8 + 64);
+    unsigned char header[13];
+    unsigned int a = 1, b = 0;
+    size_t i, n;
+    FILE *f;
+
+    if(raw == NULL || z == NULL)
+    {
+        free(raw);
+        free(z);
+        return 0;
+    }
+    //each row starts with its filter type, 0 for none
+    for(y = 0; y < c->height; y++)
+    {
+        unsigned char *row = raw + (size_t)y * rowBytes;
+        row[0] = 0;
+        for(x = 0; x < c->width; x++)
+        {
+            canvasRGB(c, y * c->width + x, row + 1 + x * 3);
+        }
+    }
+    //a zlib stream: header, deflate data, and the Adler-32 checksum of the uncompressed bytes
+    z[0] = 0x78;
+    z[1] = 0x01;
+    n = 2 + deflateFixed(raw, rawSize, 3, rowBytes, z + 2);
+    for(i = 0; i < rawSize; i++)
+    {
+        a = (a + raw[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    putBigEndian(z + n, b << 16 | a);
+    n += 4;
+
+    putBigEndian(header, c->width);
+    putBigEndian(header + 4, c->height);
+    header[8] = 8;  //bits per channel
+    header[9] = 2;  //RGB
+    header[10] = 0; //deflate
+    header[11] = 0; //filters per row
+    header[12] = 0; //not interlaced
+    f = fopen(path, "wb");
+    ok = f != NULL;
+    if(ok)
+    {
+        fwrite(signature, 1, 8, f);
+        writeChunk(f, "IHDR", header, 13);
+        writeChunk(f, "IDAT", z, n);
+        writeChunk(f, "IEND", NULL, 0);
+        ok = ferror(f) == 0;
+        ok = fclose(f) == 0 && ok;
+    }
+    free(raw);
+    free(z);
+    return ok;
+}
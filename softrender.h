@@ -0,0 +1,34 @@
+#ifndef SOFTRENDER_H
+#define SOFTRENDER_H
+//the software backend for render.h: draws the same lines and triangles as the OpenGL one into a picture in memory,
+//for screenshots and thumbnails without a window or a GPU, and saves it as PPM or PNG
+//the alpha of each pixel says whether it's been drawn yet this frame, and a pixel only takes the first colour drawn
+//on it, the same as the OpenGL backend's depth test, so both draw the same picture
+//triangles are filled a row at a time, 4 pixels per instruction with SSE2 (8 with AVX2, CFLAGS="-O2 -mavx2")
+#include "drawlist.h"
+#include "render.h"
+
+//set in a pixel once it's been drawn this frame
+#define CANVASDRAWN 0xff000000u
+
+typedef struct
+{
+    //a picture in memory
+    int width, height;
+    unsigned int *pixels; //row by row from the top, each r | g << 8 | b << 16, and CANVASDRAWN once drawn
+    double scale;         //canvas pixels per level pixel, below 1 for thumbnails
+}canvas;
+
+int initCanvas(canvas *c, int width, int height, double scale);
+void freeCanvas(canvas *c);
+void clearCanvas(canvas *c);
+void canvasDrawList(canvas *c, const drawList *dl, double xOff, double yOff);
+void useSoftBackend(renderer *r, canvas *c);
+
+//saving, loading and comparing pictures
+int writePPM(const canvas *c, const char *path);
+int writePNG(const canvas *c, const char *path);
+int readPPM(canvas *c, const char *path);
+long long diffCanvas(canvas *diff, const canvas *a, const canvas *b);
+
+#endif
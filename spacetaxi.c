@@ -1,1564 +1,514 @@
-//build in clang with: $ clang spacetaxi.c -lSDL2 -lGLU -lGL -lm -o spacetaxi 
+//build with the makefile: $ make   (or for the window-less simulation: $ make spacetaxi_headless)
 #include <SDL2/SDL.h>
 #include <GL/gl.h>
-#include <GL/glu.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
+#include <time.h>
+#include <stdatomic.h>
+#include "spacetaxi.h"
+#include "scene.h"
+#include "glrender.h"
+#include "levelpack.h"
+#include "replay.h"
+#include "profile.h"
+#include "handoff.h"
+#include "autopilot.h"
+#include "cavern.h"
+#include "gamestate.h"
+#include "fleet.h"
+#include "capture.h"
 
 //all code enclosed by '    /*////////////////////////////////////////////////////////*/
 //comments is code from the example lunar lander game, by Eike Anderson
 
-//gameplay constants::
-//window dimensions
-#define WINWIDTH     800;
-#define WINHEIGHT    600;
-//max safe velocity that won't crash the taxi
-#define SAFEVELOCITY 100.0;
-//force of gravity on taxi
-#define GRAVITY      200.0;
-//strength of vertical thrusters of taxi
-#define VERTICALSTR  400.0;
-//strength of horizontal thrusters of taxi
-#define HORIZONTSTR  280.0;
+//physics steps per second, unless changed with --hz
+#define PHYSICSHZ    240
+//longest frame the physics will catch up on, so a long stall doesn't need hundreds of steps at once
+#define MAXFRAMEMS   100.0
+//how long the game stops after a crash or a new level, for gamefeel
+#define RESULTPAUSEMS 2000.0
+//how long the last screen stays up once the game is over or won, before the window closes
+#define ENDPAUSEMS    4000.0
 
 typedef struct
 {
-    //line segment, if taxi collides it crashes and loses a life
-    //made of two connected coordinates
-    double x1;
-    double y1;
-    double x2;
-    double y2;
-}lseg;
-
-typedef struct
-{
-    //information needed for each customer
-    double fare; //how much money currently giving, decrements by 10 (£0.10) each second
-    double timeWaiting; //how long the customer has been waiting, increments each second until at destination
-
-    char name[4]; //5 letter name of customer
-
-    int destPlatform; //int 1 to 10 to tell destination platform (10 for top exit)
-    int fromPlatform; //int 1 to 10 to tell where the customer starts (10 from previous level)
-}customer;
-
-typedef struct
-{
-    //the landing pads, on which the taxi can land and customers spawn
-    lseg l; //contains a line segment for collission detection and coordinates for rendering the line
-    char customerWaiting; //flag to show if a customer is waiting on the landing pad 1 true, 0 false
-    customer c; //a copy of any customer waiting on the pad,  HDSAHKJDAS//////////////////////////////////////might go unused.?
-}lpad;
-
-typedef struct
-{
-    //bounding box, consisting of two opposite coordinates of a box
-    double x1;
-    double y1;
-    double x2;
-    double y2;
-}bbox;
-
-typedef struct
-{
-    //taxi and general game information not specific to any level
-    double x; // X coordinate of the taxi
-	double y; // Y coordinate of the taxi
-    bbox bb; // bounding box of taxi
-
-	double vSpeed; // vertical velocity of taxi
-	double hSpeed; // horizontal velocity of taxi
-	double vThrust; // vertical thrust flag (-1/0/1)
-	double hThrust; // horizontal thrust flag (0/1)  
-	char direction; // flag - gives the direction the taxi is currently facing, l for left, r for right
-    int velocity; // The total current velocity of the taxi
-
-	char bintact;   // flag - is the lander whole/intact (1) or has it crashed (0)
-	char inflight; // flag - is the lander flying (1) or has it landed/crashed (0)
-    char wheelLandersEnabled; // if the landers are enabled (1), thus horizontal movement is disabled, else (0)
-    
-    double fuel;    // the amount of fuel left
-    double maxFuel; // the size of the taxi's fuel tank, in case upgraded
-    double money;   // how much total the player has earnt during the game
-    customer custo_current; // the current customer, if in the taxi
-    char custo_waiting; //checks if there is a customer riding the taxi
-    
-    char landingOnceCustoCheck; // makes sure that customer is checked only once when landed
-
-    char justDied; // flag to check if the taxi just crashed, (1) just crashed, otherwise (0)
-    char lives;    // number of lives
-    int levelCurrent; // the number of the currently loaded level
-    char nextLevel; // flag to say to load next level (1), or not (0)
-
-    char bonusGiven; //flag to check if extra life has been awarded, (1) yes, (0) no
-}taxi;
+    //a copy of the game for drawing, published by the simulation thread after its steps
+    //the level's segment arrays are shared with the simulation's level, they're in the level pack and never change
+    //(apart from a cavern's boundary lines, which the renderer makes for itself from the cavern instead)
+    taxi t;
+    level lvl;
+    double prevX, prevY;  //taxi position before the last physics step, for drawing in between steps
+    Uint64 stepCounter;   //performance counter time that the last step caught up to
+    taxi *fleet;          //the fleet's taxis, in fleet mode (allocated once for each snapshot), otherwise NULL
+    int numFleet;
+    int levelLoads;       //goes up every time a new level is loaded, so the renderer knows to load it too
+    char paused;          //(1) if the game is paused and nothing should be drawn
+    char finished;        //(1) once the game is over and the simulation thread has stopped
+}gameSnapshot;
 
 typedef struct
 {
-    //The level, including the custmer, timer, and the level terrain (landing pads and line segments)
-    int rainChance; // chance of the level having rain, percentage (from 0 to 100)
-    char isRaining; // after random chance is calculated on level load, if it is now raining (1) or not (0)
-
-    int numbounds;   // number of boundary lines
-    int numplatforms; // number of platforms
-    lpad platforms[9]; // array of the platforms
-    lseg bounds[100]; // array of the boundary lines 
-
-    Uint32 currentTicks; //number of ticks since start of program, for game clock
-    int changedTicks; //number of ticks between frames
-    int currentTimeSecs;   //current number of seconds since program start
-
-    char customerWaiting;  //flag to check if there is a customer waiting on a platform (1) or not (0)
-    int levelCustomerNumber; //the number of customers that the given level has in total, the final being the exit customer
-    int levelCustomerCurrentNumber; //the current customer number the player is on, out of the total above
-    customer currentCustomer;   //the current customer
-}level;
+    //everything the simulation thread needs, the taxi and level are only touched by it while it runs
+    taxi t;
+    level lvl;
+    const levelPack *pack;
+    double stepMs;
+    inputRecorder rec;
+    gameSnapshot snapshots[3];
+    tripleBuffer snapshotBuffer; //which snapshot is being written, and which is being drawn
+    inputQueue input;            //key presses from the main thread
+    autopilot *pilot;            //flies the taxi instead of the keys in demo mode, otherwise NULL
+    cavern *cave;                //the cavern being played, or NULL for the level pack's levels
+    fleet *fleet;                //computer flown taxis sharing the level, or NULL
+    //practice mode: a crash goes straight back to the start of the level without losing a life,
+    //and the rewind key goes back through the states saved after each step
+    char practice;
+    gameState levelStart;
+    stateRing history;
+    atomic_int quit;             //set by the main thread when the window is closed
+}gameThread;
 
 //key functions
-void updateTicks(level *lvl) 
+double frameTimer(Uint64 *lastCounter)
 {
-    //Updates the in game timer and ticks
-    Uint32 lastTicks = lvl->currentTicks;
-    lvl->currentTicks = SDL_GetTicks();
-    lvl->changedTicks = lvl->currentTicks - lastTicks;
-    //if number of ticks has incremented by 1000, one second is added to the level timer
-    if(lvl->currentTicks/1000 != lvl->currentTimeSecs)
-    {
-        lvl->currentTimeSecs++;
-        lvl->currentCustomer.fare -= 10;
-    }
-    if(lvl->changedTicks > 20)
-    {
-        lvl->changedTicks = 20;
-    }
+    //returns the milliseconds since the last call, using the high resolution SDL counter
+    Uint64 now = SDL_GetPerformanceCounter();
+    double ms = (double)(now - *lastCounter) * 1000.0 / SDL_GetPerformanceFrequency();
+    *lastCounter = now;
+    return ms;
 }
-void printLetter(char ltr, double xPos, double yPos)
-{
-    //function to print a letter to screen, using GL_LINES, based on letter, and possition perameters
-    switch(ltr)
-    {
-        case 1: case '1':
-            glBegin(GL_LINES);
-                //right top
-                glVertex3d(xPos + 10, yPos - 1, 0.0f);
-                glVertex3d(xPos + 10, yPos - 8, 0.0f);
-                //right bottom
-                glVertex3d(xPos + 10, yPos - 9, 0.0f);
-                glVertex3d(xPos + 10, yPos - 16, 0.0f);
-            glEnd();
-        break;
-        case 2: case '2':
-            glBegin(GL_LINES);
-                //right top
-                glVertex3d(xPos + 10, yPos - 1, 0.0f);
-                glVertex3d(xPos + 10, yPos - 8, 0.0f);
-                //left bottom
-                glVertex3d(xPos + 0, yPos - 9, 0.0f);
-                glVertex3d(xPos + 0, yPos - 16, 0.0f);
-                //top
-                glVertex3d(xPos + 1, yPos - 0, 0.0f);
-                glVertex3d(xPos + 9, yPos - 0, 0.0f);
-                //middle
-                glVertex3d(xPos + 1, yPos - 9, 0.0f);
-                glVertex3d(xPos + 9, yPos - 9, 0.0f);
-                //bottom
-                glVertex3d(xPos + 1, yPos - 17, 0.0f);
-                glVertex3d(xPos + 9, yPos - 17, 0.0f);
-            glEnd();
-        break;
-        case 3: case '3':
-            glBegin(GL_LINES);
-                //right top
-                glVertex3d(xPos + 10, yPos - 1, 0.0f);
-                glVertex3d(xPos + 10, yPos - 8, 0.0f);
-                //right bottom
-                glVertex3d(xPos + 10, yPos - 9, 0.0f);
-                glVertex3d(xPos + 10, yPos - 16, 0.0f);
-                //top
-                glVertex3d(xPos + 1, yPos - 0, 0.0f);
-                glVertex3d(xPos + 9, yPos - 0, 0.0f);
-                //middle
-                glVertex3d(xPos + 1, yPos - 9, 0.0f);
-                glVertex3d(xPos + 9, yPos - 9, 0.0f);
-                //bottom
-                glVertex3d(xPos + 1, yPos - 17, 0.0f);
-                glVertex3d(xPos + 9, yPos - 17, 0.0f);
-            glEnd();
-        break;
-        case 4: case '4':
-            glBegin(GL_LINES);
-                //right top
-                glVertex3d(xPos + 10, yPos - 1, 0.0f);
-                glVertex3d(xPos + 10, yPos - 8, 0.0f);
-                //right bottom
-                glVertex3d(xPos + 10, yPos - 9, 0.0f);
-                glVertex3d(xPos + 10, yPos - 16, 0.0f);
-                //left top
-                glVertex3d(xPos + 0, yPos - 1, 0.0f);
-                glVertex3d(xPos + 0, yPos - 8, 0.0f);
-                //middle
-                glVertex3d(xPos + 1, yPos - 9, 0.0f);
-                glVertex3d(xPos + 9, yPos - 9, 0.0f);
-            glEnd();
-        break;
-        case 5: case '5':
-            glBegin(GL_LINES);
-                //right bottom
-                glVertex3d(xPos + 10, yPos - 9, 0.0f);
-                glVertex3d(xPos + 10, yPos - 16, 0.0f);
-                //left top
-                glVertex3d(xPos + 0, yPos - 1, 0.0f);
-                glVertex3d(xPos + 0, yPos - 8, 0.0f);
-                //top
-                glVertex3d(xPos + 1, yPos - 0, 0.0f);
-                glVertex3d(xPos + 9, yPos - 0, 0.0f);
-                //middle
-                glVertex3d(xPos + 1, yPos - 9, 0.0f);
-                glVertex3d(xPos + 9, yPos - 9, 0.0f);
-                //bottom
-                glVertex3d(xPos + 1, yPos - 17, 0.0f);
-                glVertex3d(xPos + 9, yPos - 17, 0.0f);
-            glEnd();
-        break;
-        case 6: case '6':
-            glBegin(GL_LINES);
-                //right bottom
-                glVertex3d(xPos + 10, yPos - 9, 0.0f);
-                glVertex3d(xPos + 10, yPos - 16, 0.0f);
-                //left top
-                glVertex3d(xPos + 0, yPos - 1, 0.0f);
-                glVertex3d(xPos + 0, yPos - 8, 0.0f);
-                //left bottom
-                glVertex3d(xPos + 0, yPos - 9, 0.0f);
-                glVertex3d(xPos + 0, yPos - 16, 0.0f);
-                //top
-                glVertex3d(xPos + 1, yPos - 0, 0.0f);
-                glVertex3d(xPos + 9, yPos - 0, 0.0f);
-                //middle
-                glVertex3d(xPos + 1, yPos - 9, 0.0f);
-                glVertex3d(xPos + 9, yPos - 9, 0.0f);
-                //bottom
-                glVertex3d(xPos + 1, yPos - 17, 0.0f);
-                glVertex3d(xPos + 9, yPos - 17, 0.0f);
-            glEnd();
-        break;
-        case 7: case '7':
-            glBegin(GL_LINES);
-                //right top
-                glVertex3d(xPos + 10, yPos - 1, 0.0f);
-                glVertex3d(xPos + 10, yPos - 8, 0.0f);
-                //right bottom
-                glVertex3d(xPos + 10, yPos - 9, 0.0f);
-                glVertex3d(xPos + 10, yPos - 16, 0.0f);
-                //top
-                glVertex3d(xPos + 1, yPos - 0, 0.0f);
-                glVertex3d(xPos + 9, yPos - 0, 0.0f);
-            glEnd();
-        break;
-        case 8: case '8':
-            glBegin(GL_LINES);
-                //right top
-                glVertex3d(xPos + 10, yPos - 1, 0.0f);
-                glVertex3d(xPos + 10, yPos - 8, 0.0f);
-                //right bottom
-                glVertex3d(xPos + 10, yPos - 9, 0.0f);
-                glVertex3d(xPos + 10, yPos - 16, 0.0f);
-                //left top
-                glVertex3d(xPos + 0, yPos - 1, 0.0f);
-                glVertex3d(xPos + 0, yPos - 8, 0.0f);
-                //left bottom
-                glVertex3d(xPos + 0, yPos - 9, 0.0f);
-                glVertex3d(xPos + 0, yPos - 16, 0.0f);
-                //top
-                glVertex3d(xPos + 1, yPos - 0, 0.0f);
-                glVertex3d(xPos + 9, yPos - 0, 0.0f);
-                //middle
-                glVertex3d(xPos + 1, yPos - 9, 0.0f);
-                glVertex3d(xPos + 9, yPos - 9, 0.0f);
-                //bottom
-                glVertex3d(xPos + 1, yPos - 17, 0.0f);
-                glVertex3d(xPos + 9, yPos - 17, 0.0f);
-            glEnd();
-        break;
-        case 9: case '9':
-            glBegin(GL_LINES);
-                //right top
-                glVertex3d(xPos + 10, yPos - 1, 0.0f);
-                glVertex3d(xPos + 10, yPos - 8, 0.0f);
-                //right bottom
-                glVertex3d(xPos + 10, yPos - 9, 0.0f);
-                glVertex3d(xPos + 10, yPos - 16, 0.0f);
-                //left top
-                glVertex3d(xPos + 0, yPos - 1, 0.0f);
-                glVertex3d(xPos + 0, yPos - 8, 0.0f);
-                //top
-                glVertex3d(xPos + 1, yPos - 0, 0.0f);
-                glVertex3d(xPos + 9, yPos - 0, 0.0f);
-                //middle
-                glVertex3d(xPos + 1, yPos - 9, 0.0f);
-                glVertex3d(xPos + 9, yPos - 9, 0.0f);
-                //bottom
-                glVertex3d(xPos + 1, yPos - 17, 0.0f);
-                glVertex3d(xPos + 9, yPos - 17, 0.0f);
-            glEnd();
-        break;
-        case 0: case '0':
-            glBegin(GL_LINES);
-                //right top
-                glVertex3d(xPos + 10, yPos - 1, 0.0f);
-                glVertex3d(xPos + 10, yPos - 8, 0.0f);
-                //right bottom
-                glVertex3d(xPos + 10, yPos - 9, 0.0f);
-                glVertex3d(xPos + 10, yPos - 16, 0.0f);
-                //left top
-                glVertex3d(xPos + 0, yPos - 1, 0.0f);
-                glVertex3d(xPos + 0, yPos - 8, 0.0f);
-                //left bottom
-                glVertex3d(xPos + 0, yPos - 9, 0.0f);
-                glVertex3d(xPos + 0, yPos - 16, 0.0f);
-                //top
-                glVertex3d(xPos + 1, yPos - 0, 0.0f);
-                glVertex3d(xPos + 9, yPos - 0, 0.0f);
-                //bottom
-                glVertex3d(xPos + 1, yPos - 17, 0.0f);
-                glVertex3d(xPos + 9, yPos - 17, 0.0f);
-            glEnd();
-        break;
-        case 'a': case 'A':
-            glBegin(GL_LINES);
-                //full right
-                glVertex3d(xPos + 10, yPos - 0, 0.0f);
-                glVertex3d(xPos + 10, yPos - 17, 0.0f);
-                //full left
-                glVertex3d(xPos + 0, yPos - 0, 0.0f);
-                glVertex3d(xPos + 0, yPos - 17, 0.0f);
-                //top
-                glVertex3d(xPos + 1, yPos - 0, 0.0f);
-                glVertex3d(xPos + 9, yPos - 0, 0.0f);
-                //middle
-                glVertex3d(xPos + 1, yPos - 9, 0.0f);
-                glVertex3d(xPos + 9, yPos - 9, 0.0f);
-            glEnd();
-        break;
-        case 'b': case 'B':
-            glBegin(GL_LINES);
-                //right top
-                glVertex3d(xPos + 10, yPos - 1, 0.0f);
-                glVertex3d(xPos + 10, yPos - 8, 0.0f);
-                //right bottom
-                glVertex3d(xPos + 10, yPos - 9, 0.0f);
-                glVertex3d(xPos + 10, yPos - 16, 0.0f);
-                //full left
-                glVertex3d(xPos + 0, yPos - 0, 0.0f);
-                glVertex3d(xPos + 0, yPos - 17, 0.0f);
-                //top
-                glVertex3d(xPos + 0, yPos - 0, 0.0f);
-                glVertex3d(xPos + 9, yPos - 0, 0.0f);
-                //middle
-                glVertex3d(xPos + 1, yPos - 9, 0.0f);
-                glVertex3d(xPos + 9, yPos - 9, 0.0f);
-                //bottom
-                glVertex3d(xPos + 1, yPos - 17, 0.0f);
-                glVertex3d(xPos + 10, yPos - 17, 0.0f);
-            glEnd();
-        break;
-        case 'c': case 'C':
-            glBegin(GL_LINES);
-                //full left
-                glVertex3d(xPos + 0, yPos - 0, 0.0f);
-                glVertex3d(xPos + 0, yPos - 16, 0.0f);
-                //top
-                glVertex3d(xPos + 1, yPos - 0, 0.0f);
-                glVertex3d(xPos + 9, yPos - 0, 0.0f);
-                //bottom
-                glVertex3d(xPos + 1, yPos - 17, 0.0f);
-                glVertex3d(xPos + 9, yPos - 17, 0.0f);
-            glEnd();
-        break;
-        case 'd': case 'D':
-            glBegin(GL_LINES);
-                //full right
-                glVertex3d(xPos + 10, yPos - 0, 0.0f);
-                glVertex3d(xPos + 10, yPos - 16, 0.0f);
-                //full left
-                glVertex3d(xPos + 0, yPos - 0, 0.0f);
-                glVertex3d(xPos + 0, yPos - 17, 0.0f);
-                //top
-                glVertex3d(xPos + 1, yPos - 0, 0.0f);
-                glVertex3d(xPos + 9, yPos - 0, 0.0f);
-                //bottom
-                glVertex3d(xPos + 1, yPos - 17, 0.0f);
-                glVertex3d(xPos + 9, yPos - 17, 0.0f);
-            glEnd();
-        break;
-        case 'e': case 'E':
-            glBegin(GL_LINES);
-                //full left
-                glVertex3d(xPos + 0, yPos - 0, 0.0f);
-                glVertex3d(xPos + 0, yPos - 17, 0.0f);
-                //top
-                glVertex3d(xPos + 1, yPos - 0, 0.0f);
-                glVertex3d(xPos + 9, yPos - 0, 0.0f);
-                //middle
-                glVertex3d(xPos + 1, yPos - 9, 0.0f);
-                glVertex3d(xPos + 9, yPos - 9, 0.0f);
-                //bottom
-                glVertex3d(xPos + 1, yPos - 17, 0.0f);
-                glVertex3d(xPos + 9, yPos - 17, 0.0f);
-            glEnd();
-        break;
-        case 'f': case 'F':
-            glBegin(GL_LINES);
-                //full left
-                glVertex3d(xPos + 0, yPos - 0, 0.0f);
-                glVertex3d(xPos + 0, yPos - 17, 0.0f);
-                //top
-                glVertex3d(xPos + 1, yPos - 0, 0.0f);
-                glVertex3d(xPos + 9, yPos - 0, 0.0f);
-                //middle
-                glVertex3d(xPos + 1, yPos - 9, 0.0f);
-                glVertex3d(xPos + 9, yPos - 9, 0.0f);
-            glEnd();
-        break;
-        case 'g': case 'G':
-            glBegin(GL_LINES);
-                //right bottom
-                glVertex3d(xPos + 10, yPos - 9, 0.0f);
-                glVertex3d(xPos + 10, yPos - 16, 0.0f);
-                //full left
-                glVertex3d(xPos + 0, yPos - 0, 0.0f);
-                glVertex3d(xPos + 0, yPos - 16, 0.0f);
-                //top
-                glVertex3d(xPos + 1, yPos - 0, 0.0f);
-                glVertex3d(xPos + 9, yPos - 0, 0.0f);
-                //middle
-                glVertex3d(xPos + 7, yPos - 9, 0.0f);
-                glVertex3d(xPos + 9, yPos - 9, 0.0f);
-                //bottom
-                glVertex3d(xPos + 1, yPos - 17, 0.0f);
-                glVertex3d(xPos + 9, yPos - 17, 0.0f);
-            glEnd();
-        break;
-        case 'h': case 'H':
-            glBegin(GL_LINES);
-                //full right
-                glVertex3d(xPos + 10, yPos - 0, 0.0f);
-                glVertex3d(xPos + 10, yPos - 17, 0.0f);
-                //full left
-                glVertex3d(xPos + 0, yPos - 0, 0.0f);
-                glVertex3d(xPos + 0, yPos - 17, 0.0f);
-                //middle
-                glVertex3d(xPos + 1, yPos - 9, 0.0f);
-                glVertex3d(xPos + 9, yPos - 9, 0.0f);
-            glEnd();
-        break;
-        case 'i': case 'I':
-            glBegin(GL_LINES);
-                //full centre
-                glVertex3d(xPos + 5, yPos - 0, 0.0f);
-                glVertex3d(xPos + 5, yPos - 17, 0.0f);
-                //top
-                glVertex3d(xPos + 1, yPos - 0, 0.0f);
-                glVertex3d(xPos + 9, yPos - 0, 0.0f);
-                //bottom
-                glVertex3d(xPos + 1, yPos - 17, 0.0f);
-                glVertex3d(xPos + 9, yPos - 17, 0.0f);
-            glEnd();
-        break;
-        case 'j': case 'J':
-            glBegin(GL_LINES);
-                //right top
-                glVertex3d(xPos + 10, yPos - 1, 0.0f);
-                glVertex3d(xPos + 10, yPos - 8, 0.0f);
-                //right bottom
-                glVertex3d(xPos + 10, yPos - 9, 0.0f);
-                glVertex3d(xPos + 10, yPos - 16, 0.0f);
-                //full right
-                glVertex3d(xPos + 10, yPos - 0, 0.0f);
-                glVertex3d(xPos + 10, yPos - 17, 0.0f);
-                //left top
-                glVertex3d(xPos + 0, yPos - 1, 0.0f);
-                glVertex3d(xPos + 0, yPos - 8, 0.0f);
-                //left bottom
-                glVertex3d(xPos + 0, yPos - 9, 0.0f);
-                glVertex3d(xPos + 0, yPos - 16, 0.0f);
-                //full left
-                glVertex3d(xPos + 0, yPos - 0, 0.0f);
-                glVertex3d(xPos + 0, yPos - 17, 0.0f);
-                //top
-                glVertex3d(xPos + 1, yPos - 0, 0.0f);
-                glVertex3d(xPos + 9, yPos - 0, 0.0f);
-                //middle
-                glVertex3d(xPos + 1, yPos - 9, 0.0f);
-                glVertex3d(xPos + 9, yPos - 9, 0.0f);
-                //bottom
-                glVertex3d(xPos + 1, yPos - 17, 0.0f);
-                glVertex3d(xPos + 9, yPos - 17, 0.0f);
-            glEnd();
-        break;
-        case 'k': case 'K':
-            glBegin(GL_LINES);
-                //right top
-                glVertex3d(xPos + 1, yPos - 8, 0.0f);
-                glVertex3d(xPos + 10, yPos - 1, 0.0f);
-                //right bottom
-                glVertex3d(xPos + 1, yPos - 9, 0.0f);
-                glVertex3d(xPos + 10, yPos - 16, 0.0f);
-                //full left
-                glVertex3d(xPos + 0, yPos - 0, 0.0f);
-                glVertex3d(xPos + 0, yPos - 17, 0.0f);
-            glEnd();
-        break;
-        case 'l': case 'L':
-            glBegin(GL_LINES);
-                //full left
-                glVertex3d(xPos + 0, yPos - 0, 0.0f);
-                glVertex3d(xPos + 0, yPos - 17, 0.0f);
-                //bottom
-                glVertex3d(xPos + 1, yPos - 17, 0.0f);
-                glVertex3d(xPos + 9, yPos - 17, 0.0f);
-            glEnd();
-        break;
-        case 'm': case 'M':
-            glBegin(GL_LINES);
-                //bottom left to top middle diagonal
-                glVertex3d(xPos + 0, yPos - 17, 0.0f);
-                glVertex3d(xPos + 3, yPos - 0, 0.0f);
-
-                glVertex3d(xPos + 3, yPos - 0, 0.0f);
-                glVertex3d(xPos + 5, yPos - 17, 0.0f);
-                glVertex3d(xPos + 5, yPos - 17, 0.0f);
-                glVertex3d(xPos + 8, yPos - 0, 0.0f);
-
-                //top middle to bottom right diagonal
-                glVertex3d(xPos + 8, yPos - 0, 0.0f);
-                glVertex3d(xPos + 10, yPos -17, 0.0f);
-            glEnd();
-        break;
-        case 'n': case 'N':
-            glBegin(GL_LINES);
-                //full right
-                glVertex3d(xPos + 10, yPos - 0, 0.0f);
-                glVertex3d(xPos + 10, yPos - 17, 0.0f);
-                //full left
-                glVertex3d(xPos + 0, yPos - 0, 0.0f);
-                glVertex3d(xPos + 0, yPos - 17, 0.0f);
-                //top left to bottom right diagonal
-                glVertex3d(xPos + 0, yPos - 0, 0.0f);
-                glVertex3d(xPos + 10, yPos - 17, 0.0f);
-            glEnd();
-        break;
-        case 'o': case 'O':
-            glBegin(GL_LINES);
-                //full right
-                glVertex3d(xPos + 10, yPos - 0, 0.0f);
-                glVertex3d(xPos + 10, yPos - 17, 0.0f);
-                //full left
-                glVertex3d(xPos + 0, yPos - 0, 0.0f);
-                glVertex3d(xPos + 0, yPos - 17, 0.0f);
-                //top
-                glVertex3d(xPos + 1, yPos - 0, 0.0f);
-                glVertex3d(xPos + 9, yPos - 0, 0.0f);
-                //bottom
-                glVertex3d(xPos + 1, yPos - 17, 0.0f);
-                glVertex3d(xPos + 9, yPos - 17, 0.0f);
-            glEnd();
-        break;
-        case 'p': case 'P':
-            glBegin(GL_LINES);
-                //right top
-                glVertex3d(xPos + 10, yPos - 1, 0.0f);
-                glVertex3d(xPos + 10, yPos - 8, 0.0f);     
-                //full left
-                glVertex3d(xPos + 0, yPos - 0, 0.0f);
-                glVertex3d(xPos + 0, yPos - 17, 0.0f);
-                //top
-                glVertex3d(xPos + 1, yPos - 0, 0.0f);
-                glVertex3d(xPos + 9, yPos - 0, 0.0f);
-                //middle
-                glVertex3d(xPos + 1, yPos - 9, 0.0f);
-                glVertex3d(xPos + 9, yPos - 9, 0.0f);
-            glEnd();
-        break;
-        case 'q': case 'Q':
-            glBegin(GL_LINES);
-                //full right
-                glVertex3d(xPos + 10, yPos - 0, 0.0f);
-                glVertex3d(xPos + 10, yPos - 17, 0.0f);
-                //full left
-                glVertex3d(xPos + 0, yPos - 0, 0.0f);
-                glVertex3d(xPos + 0, yPos - 16, 0.0f);
-                //top
-                glVertex3d(xPos + 1, yPos - 0, 0.0f);
-                glVertex3d(xPos + 9, yPos - 0, 0.0f);
-                //bottom
-                glVertex3d(xPos + 1, yPos - 17, 0.0f);
-                glVertex3d(xPos + 9, yPos - 17, 0.0f);
-                //right diagonal
-                glVertex3d(xPos + 5, yPos - 9, 0.0f);
-                glVertex3d(xPos + 11, yPos - 18, 0.0f);
-            glEnd();
-        break;
-        case 'r': case 'R':
-            glBegin(GL_LINES);
-                //right top
-                glVertex3d(xPos + 10, yPos - 1, 0.0f);
-                glVertex3d(xPos + 10, yPos - 8, 0.0f);
-                //right bottom
-                glVertex3d(xPos + 10, yPos - 9, 0.0f);
-                glVertex3d(xPos + 10, yPos - 17, 0.0f);
-                //full left
-                glVertex3d(xPos + 0, yPos - 0, 0.0f);
-                glVertex3d(xPos + 0, yPos - 17, 0.0f);
-                //top
-                glVertex3d(xPos + 1, yPos - 0, 0.0f);
-                glVertex3d(xPos + 9, yPos - 0, 0.0f);
-                //middle
-                glVertex3d(xPos + 1, yPos - 9, 0.0f);
-                glVertex3d(xPos + 9, yPos - 9, 0.0f);
-            glEnd();
-        break;
-        case 's': case 'S':
-            glBegin(GL_LINES);
-                //right bottom
-                glVertex3d(xPos + 10, yPos - 9, 0.0f);
-                glVertex3d(xPos + 10, yPos - 16, 0.0f);
-                //left top
-                glVertex3d(xPos + 0, yPos - 1, 0.0f);
-                glVertex3d(xPos + 0, yPos - 8, 0.0f);
-                //top
-                glVertex3d(xPos + 1, yPos - 0, 0.0f);
-                glVertex3d(xPos + 9, yPos - 0, 0.0f);
-                //middle
-                glVertex3d(xPos + 1, yPos - 9, 0.0f);
-                glVertex3d(xPos + 9, yPos - 9, 0.0f);
-                //bottom
-                glVertex3d(xPos + 1, yPos - 17, 0.0f);
-                glVertex3d(xPos + 9, yPos - 17, 0.0f);
-            glEnd();
-        break;
-        case 't': case 'T':
-            glBegin(GL_LINES);
-                //full centre
-                glVertex3d(xPos + 5, yPos - 0, 0.0f);
-                glVertex3d(xPos + 5, yPos - 17, 0.0f);
-                //top
-                glVertex3d(xPos + 0, yPos - 0, 0.0f);
-                glVertex3d(xPos + 10, yPos - 0, 0.0f);
-            glEnd();
-        break;
-        case 'u': case 'U':
-            glBegin(GL_LINES);
-                //full right
-                glVertex3d(xPos + 10, yPos - 0, 0.0f);
-                glVertex3d(xPos + 10, yPos - 17, 0.0f);
-                //full left
-                glVertex3d(xPos + 0, yPos - 0, 0.0f);
-                glVertex3d(xPos + 0, yPos - 16, 0.0f);
-                //bottom
-                glVertex3d(xPos + 1, yPos - 17, 0.0f);
-                glVertex3d(xPos + 9, yPos - 17, 0.0f);
-            glEnd();
-        break;
-        case 'v': case 'V':
-            glBegin(GL_LINES);
-                //top left to bottom middle diagonal
-                glVertex3d(xPos + 0, yPos - 0, 0.0f);
-                glVertex3d(xPos + 5, yPos - 17, 0.0f);
-                //bottom middle to top right diagonal
-                glVertex3d(xPos + 5, yPos - 17, 0.0f);
-                glVertex3d(xPos + 10, yPos - 0, 0.0f);
-            glEnd();
-        break;
-        case 'w': case 'W':
-            glBegin(GL_LINES);
-                //top left to bottom middle diagonal
-                glVertex3d(xPos + 0, yPos - 0, 0.0f);
-                glVertex3d(xPos + 3, yPos - 17, 0.0f);
-
-                glVertex3d(xPos + 3, yPos - 17, 0.0f);
-                glVertex3d(xPos + 5, yPos - 0, 0.0f);
-                glVertex3d(xPos + 5, yPos - 0, 0.0f);
-                glVertex3d(xPos + 8, yPos - 17, 0.0f);
 
-                //bottom middle to top right diagonal
-                glVertex3d(xPos + 8, yPos - 17, 0.0f);
-                glVertex3d(xPos + 10, yPos - 0, 0.0f);
-            glEnd();
-        break;
-        case 'x': case 'X':
-            glBegin(GL_LINES);
-                //top left to bottom right diagonal
-                glVertex3d(xPos + 0, yPos - 0, 0.0f);
-                glVertex3d(xPos + 10, yPos - 17, 0.0f);
-                //bottom left to top right diagonal
-                glVertex3d(xPos + 0, yPos - 17, 0.0f);
-                glVertex3d(xPos + 10, yPos - 0, 0.0f);
-            glEnd();
-        break;
-        case 'y': case 'Y':
-            glBegin(GL_LINES);
-                //top left to middle diagonal
-                glVertex3d(xPos + 0, yPos - 0, 0.0f);
-                glVertex3d(xPos + 5, yPos - 8, 0.0f);
-                //middle to top right diagonal
-                glVertex3d(xPos + 5, yPos - 8, 0.0f);
-                glVertex3d(xPos + 10, yPos - 0, 0.0f);
-                //left bottom
-                glVertex3d(xPos + 5, yPos - 9, 0.0f);
-                glVertex3d(xPos + 5, yPos - 16, 0.0f);
-            glEnd();
-        break;
-        case 'z': case 'Z':
-            glBegin(GL_LINES);
-                //bottom left to top right diagonal
-                glVertex3d(xPos + 0, yPos - 17, 0.0f);
-                glVertex3d(xPos + 10, yPos - 0, 0.0f);
-                //top
-                glVertex3d(xPos + 1, yPos - 0, 0.0f);
-                glVertex3d(xPos + 9, yPos - 0, 0.0f);
-                //bottom
-                glVertex3d(xPos + 1, yPos - 17, 0.0f);
-                glVertex3d(xPos + 9, yPos - 17, 0.0f);
-            glEnd();
-        break;
-        case '.':
-            glBegin(GL_LINES);
-                glVertex3d(xPos + 0, yPos - 15, 0.0f);
-                glVertex3d(xPos + 0, yPos - 17, 0.0f);
-            glEnd();
-        break;
-        case '!':
-            glBegin(GL_LINES);
-                //left top
-                glVertex3d(xPos + 5, yPos - 1, 0.0f);
-                glVertex3d(xPos + 5, yPos - 12, 0.0f);
-                //dot
-                glVertex3d(xPos + 5, yPos - 15, 0.0f);
-                glVertex3d(xPos + 5, yPos - 17, 0.0f);
-            glEnd();
-        break;
-    }  
-}
-
-
-void createPlatform(level *lvl, int xStart, int xEnd, int yStart, int yEnd, int num)
+static void publishSnapshot(gameThread *g, double prevX, double prevY, double accumulator, int levelLoads, char paused, char finished)
 {
-    //function to create a platform and add it to the level struct, based on the platform start and end coordinates
-    //automatically fills in the unserside line segments
-
-    lseg t; //temp line segment
-
-    /* first the landing pads */
-	t.x1 = xStart;
-	t.y1 = yStart;
-	t.x2 = xEnd;
-	t.y2 = yEnd;
-	lvl->platforms[lvl->numplatforms].l=t; 
-	
-    /* then the undersides of the landing pads */
-	t.x1 = xStart;
-	t.y1 = yStart - 1.0;
-	t.x2 = xStart + 30;
-	t.y2 = yStart - 30;
-	lvl->bounds[lvl->numbounds]=t;
-	t.x1 = xStart + 30;
-	t.y1 = yStart - 30;
-	t.x2 = xEnd - 30;
-	t.y2 = yEnd - 30;
-	lvl->bounds[lvl->numbounds + 1]=t;
-	t.x1 = xEnd - 30;
-	t.y1 = yEnd - 30;
-	t.x2 = xEnd;
-	t.y2 = yEnd - 1;
-	lvl->bounds[lvl->numbounds + 2]=t;
-
-    //increment the numbers of boundary lines and landing platforms
-    lvl->numbounds += 3;
-    lvl->numplatforms += 1;
-}
-
-
-void waitForSecs(int secs, char stillRenderScene)
-{
-    //function to make the program wait for a given number of seconds
-    SDL_Delay(secs * 1000);
+    //copies the game into the free snapshot and hands it to the main thread
+    gameSnapshot *s = &g->snapshots[g->snapshotBuffer.back];
+    s->t = g->t;
+    s->lvl = g->lvl;
+    s->prevX = prevX;
+    s->prevY = prevY;
+    if(g->fleet != NULL)
+    {
+        memcpy(s->fleet, g->fleet->taxis, sizeof(taxi) * g->fleet->numTaxis);
+        s->numFleet = g->fleet->numTaxis;
+    }
+    s->stepCounter = SDL_GetPerformanceCounter() - (Uint64)(accumulator * SDL_GetPerformanceFrequency() / 1000.0);
+    s->levelLoads = levelLoads;
+    s->paused = paused;
+    s->finished = finished;
+    tripleBufferPublish(&g->snapshotBuffer);
 }
-void initialiseTaxi(taxi *t, double x, double y, char lives)
+static int simulationThread(void *data)
 {
-    //function to automatically initialise the given taxi struct
-    t->x = x;
-    t->y = y;
-    t->bb.x1=-26.0;
-	t->bb.y1=-9.0;
-	t->bb.x2= 25.0;
-	t->bb.y2= 12.0;
-
-    t->vSpeed = 0;
-    t->hSpeed = 0;
-    t->vThrust = 0;
-    t->hThrust = 0;
-    t->direction = 'r';
-    t->velocity = 0;
-
-    t->bintact = '1';
-    t->inflight = '1';
-    t->wheelLandersEnabled = '1';
-
-    t->maxFuel = 300.0000;
-    t->fuel = t->maxFuel;
-    t->money = 0.00;
-    t->custo_waiting = '0';
-
-    t->justDied = '0';
-    t->lives = lives;
-    t->levelCurrent = 1;
+    //runs the physics at its fixed step, away from the main thread so waiting for vsync never holds it up
+    gameThread *g = data;
+    taxi *t = &g->t;
+    level *lvl = &g->lvl;
+    //the keys currently held down, passed to the simulation each step
+    taxiInput input = {0.0, 0.0, 0};
+    inputEvent e;
+    char paused = '1'; //the game starts paused
+    double accumulator = 0;
+    double frameMs;
+    double prevX = t->x, prevY = t->y;
+    Uint64 lastCounter = SDL_GetPerformanceCounter();
+    unsigned int tick = 0; //steps played so far
+    int result = GAMEPLAYING;
+    int levelLoads = 0;
+    //milliseconds left of a pause after a crash or level change, or before the game closes at the end
+    //the main thread keeps drawing and handling the window while it counts down
+    double waitMs = 0;
+    char ending = '0'; //(1) once the game is over or won, the game closes when waitMs runs out
+    int go = 1;
 
-    t->bonusGiven = 0;
-}
-void initialiseCustomer(customer *custo, int destpad, int currentpad)
-{
-    //function to automatically initialise the given customer struct
-    custo->fare = rand()%1000 + 1000;
-    custo->timeWaiting = 0;
-    custo->destPlatform = destpad;
-    custo->fromPlatform = currentpad;
-}
-void initialiseBBox(bbox *b, int ax1, int ay1, int ax2, int ay2)
-{
-    //function to initialise the given bounding box with given coordinates
-    b->x1 = ax1;
-    b->y1 = ay1;
-    b->x2 = ax2;
-    b->y2 = ay2;
-}
-bbox getBBox(taxi *t)
-{
-    //function to create a bouding box based on the taxi's bounding box, and then return it
-    bbox b;
-    b.x1 = t->bb.x1+t->x;
-    b.y1 = t->bb.y1+t->y;
-    b.x2 = t->bb.x2+t->x;
-    b.y2 = t->bb.y2+t->y;
-    return b;
-}
-int intersectBBxBB(bbox A, bbox B)
-{
-    /* identify intersection between two bounding boxes, returning 1 for intersection, 0 otherwise */
-    if((A.x1 >= B.x2 || A.x2 <= B.x1 || A.y1 >= B.y2 || A.y2 <= B.y1) || (B.x1 >= A.x2 || B.x2 <= A.x1 || B.y1 >= A.y2 || B.y2 <= A.y1))
+    if(g->practice == '1')
     {
-        return 0;
+        saveGameState(&g->levelStart, t, lvl);
+        pushState(&g->history, t, lvl);
     }
-    return 1;
-}
-int intersectLxL(lseg L1, lseg L2)
-{
-    /*////////////////////////////////////////////////////////*/
-    /* basic line-line intersection maths */
-	double D1 = ( (L2.x2-L2.x1)*(L1.y1-L2.y1) - (L2.y2-L2.y1)*(L1.x1-L2.x1) ) / ( (L2.y2-L2.y1)*(L1.x2-L1.x1) - (L2.x2-L2.x1)*(L1.y2-L1.y1) );
-	double D2 = ( (L1.x2-L1.x1)*(L1.y1-L2.y1) - (L1.y2-L1.y1)*(L1.x1-L2.x1) ) / ( (L2.y2-L2.y1)*(L1.x2-L1.x1) - (L2.x2-L2.x1)*(L1.y2-L1.y1) );
-	if (D1 >= 0 && D1 <= 1 && D2 >= 0 && D2 <= 1) return 1; /* intersection */
-	return 0;
-    /*////////////////////////////////////////////////////////*/
-}
-int intersectBBxL(bbox B, lseg Line)
-{
-    /*////////////////////////////////////////////////////////*/
-    int top=0, bottom=0, left=0, right=0; /* intersection with a side of the box */
-	lseg tLine; /* line segment for a side of the box */
-	
-	/* generate a side */
-	tLine.x1 =B.x1; 
-	tLine.y1 =B.y2;
-	tLine.x2 =B.x2;
-	tLine.y2 =B.y2;
-	bottom = intersectLxL(tLine,Line); /* test if it intersects */
-	
-	/* generate a side */
-	tLine.x1 =B.x1;
-	tLine.y1 =B.y1;
-	tLine.x2 =B.x2;
-	tLine.y2 =B.y1;
-	top    = intersectLxL(tLine,Line); /* test if it intersects */
-	
-	/* generate a side */
-	tLine.x1 =B.x1;
-	tLine.y1 =B.y1;
-	tLine.x2 =B.x1;
-	tLine.y2 =B.y2;
-	left   = intersectLxL(tLine,Line); /* test if it intersects */
-	
-	/* generate a side */
-	tLine.x1 =B.x2;
-	tLine.y1 =B.y1;
-	tLine.x2 =B.x2;
-	tLine.y2 =B.y2;
-	right  = intersectLxL(tLine,Line); /* test if it intersects */
-	
-	if(bottom || top || left || right) return 1; /* mark collision/intersection if one of the sides has an intersection */
-	
-    return 0;
-    /*////////////////////////////////////////////////////////*/
-}
-void customerMakeNext(level *lvl, int notPlatform, char death)
-{
-    //function to initialise the next customer in the level struct
-    int r = notPlatform;
-    //sets the destination platform to 1 if there is only one platform, or to a random number if more than one
-    if(lvl->numplatforms == 1)
-    {
-        r = 1;
-    }
-    else
+
+    while(go && atomic_load(&g->quit) == 0)
     {
-        //random number for destination platform is based on the number of platforms
-        while(r == notPlatform)
+        //the key presses since last time
+        while(inputQueuePop(&g->input, &e))
         {
-            r = (rand() % (lvl->numplatforms));
-            printf("here %d! \n", r);  
+            switch(e.type)
+            {
+                case INPUTVTHRUST:
+                input.vThrust = e.value;
+                break;
+                case INPUTHTHRUST:
+                input.hThrust = e.value;
+                break;
+                case INPUTWHEELS:
+                input.toggleWheels = 1;
+                break;
+                case INPUTPAUSE:
+                paused = paused == '1' ? '0' : '1';
+                break;
+                case INPUTREWIND:
+                if(g->practice == '1' && rewindStates(&g->history, (int)(REWINDSTEP * 1000.0 / g->stepMs + 0.5), t, lvl) > 0)
+                {
+                    //don't draw the taxi sliding back
+                    prevX = t->x;
+                    prevY = t->y;
+                }
+                break;
+            }
         }
-    }
-    int c;
-
-    //sets the destination platform to go up if the customer counter for the level has been reached
-    //otherwise, the customer's staring platform is randomised
 
-    if(death == 'f')
-    {
-        lvl->levelCustomerCurrentNumber ++;
-    }
-
-    if(lvl->levelCustomerCurrentNumber == lvl->levelCustomerNumber)
-    {
-        r = lvl->numplatforms + 1;
-    }
-    else
-    {
-        //might not be working, but meant to loop while the from and destination platforms are the same
-        c = r;
-        //while(c == r)
+        //the physics always steps by the same amount, as many times as the time since the last pass needs
+        frameMs = frameTimer(&lastCounter);
+        if(frameMs > MAXFRAMEMS)
         {
-            c = (rand() % (lvl->numplatforms - 1) + 1);
+            frameMs = MAXFRAMEMS;
         }
-    }
-
-    //makes sure the customer is waiting
-    lvl->customerWaiting = '1';
-
-    //initialises the customer, and adds it to the level
-    customer custo;
-    initialiseCustomer(&custo, r, c);
-    lvl->currentCustomer = custo;
-
-
-
-    ///////// here!!!! make it a list of numbes, shuffled, and the first two numbers picked...
-}
-
-void newCustomerMakeNext(level *lvl)
-{
-    int i, j[99], k, l, y = lvl->numplatforms;
-
-    for(i = 0; i < y; i++)
-    {
-        j[i] = i;
-    }
-
-    for(i = 0; i < 100; i++)
-    {
-        k = (rand() %  y);
-        l = j[i];
-        j[i] = j[k];
-        j[k] = l;
-    }
-}
-
-void customerReDestination(customer c)
-{
-
-}
-
-void doEvents(taxi *t, double frames, level *lvl)
-{
-    //this is the place where all the main calculations like movement take place
-    
-    updateTicks(lvl);
-    int windowHeight = WINHEIGHT;
-    double h = HORIZONTSTR;double v = VERTICALSTR;double g = GRAVITY;
-    bbox b = getBBox(t);
-
-    lpad *pad = lvl->platforms;
-    
-    //checks that the taxi hasn't crashed before calculations
-    if(t->bintact == '1')
-    {
-        //movement calculations
-        t->vSpeed-=frames*g;
-        t->vSpeed+=frames*t->vThrust*v;
-        t->hSpeed+=frames*t->hThrust*h;
-        t->velocity = sqrt((t->vSpeed * t->vSpeed) + (t->hSpeed * t->hSpeed));
-
-        if(t->inflight == '1')
+        if(paused == '0' && waitMs > 0)
         {
-            //only calculates movement if not on a platform
-            t->y+=frames*t->vSpeed;
-            t->x+=frames*t->hSpeed;
+            waitMs -= frameMs;
+            if(waitMs <= 0 && ending == '1')
+            {
+                go = 0;
+            }
         }
-        
-        //hit detection
-        int i;
-        int safeVel = SAFEVELOCITY;
-        //landing pads
-        for(i=0;i<lvl->numplatforms;i++)
+        else if(paused == '0')
         {
-            if(intersectBBxL(b, pad[i].l) == 1)
+            accumulator += frameMs;
+            while(accumulator >= g->stepMs && waitMs <= 0)
             {
-                if(t->wheelLandersEnabled == '1' && t->velocity <= safeVel)
+                long long stageTimer = profileStart();
+                prevX = t->x;
+                prevY = t->y;
+                if(g->cave != NULL)
                 {
-                    t->inflight = '0';
-                    t->vSpeed = 10.0;
-                    t->hThrust = 0;
-                    t->hSpeed = 0;
-                    int y;
-                    y = pad[i].l.y1 + (pad[i].l.y2 - pad[i].l.y1)*(t->x-pad[i].l.x1/pad[i].l.x2 - pad[i].l.x1) + 10; 
-                    t->y=y;
-
-                    // customer waiting on platform check
-                    if(i == lvl->currentCustomer.fromPlatform && t->landingOnceCustoCheck == '0')
-                    {
-                        t->custo_current = lvl->currentCustomer;
-                        t->custo_waiting = '1';
-                        lvl->customerWaiting = '0';
-                        printf("\r peach has got it %d",lvl->currentCustomer.destPlatform);
-                        fflush(stdout);
-                        t->landingOnceCustoCheck = '1';
-                    }
-                    
-                    if(t->custo_waiting == '1') // check if there is a customer in the taxi
-                    {
-                        if(lvl->currentCustomer.destPlatform == i)
-                        {
-                            t->custo_waiting = '0';
-                            t->money += t->custo_current.fare;
-                            customerMakeNext(lvl, t->custo_current.destPlatform, 'f');
-                            t->landingOnceCustoCheck = '0';
-                        }
-                    }
+                    //the cavern's lines round the taxi, made again when it moves on a chunk
+                    streamCavern(g->cave, lvl, t->x);
                 }
-                else
+                if(g->fleet != NULL)
                 {
-                    t->justDied = '1';
-                    t->inflight = '0';
-                    t->bintact = '0';
+                    //the fleet goes first, so if it crashes the taxi updateGame() deals with it this step
+                    stepFleet(g->fleet, t, lvl, g->stepMs);
                 }
-                
+                if(g->pilot != NULL)
+                {
+                    autopilotInput(g->pilot, t, lvl, &input);
+                }
+                result = updateGame(t, lvl, g->pack, &input, g->stepMs);
+                recordStep(&g->rec, tick, &input, t);
+                tick++;
+                accumulator -= g->stepMs;
+                //a wheel toggle only happens once per key press
+                input.toggleWheels = 0;
+                profileEnd(STAGEPHYSICS, stageTimer);
+                if(result == GAMEPLAYING)
+                {
+                    pushState(&g->history, t, lvl);
+                    continue;
+                }
+                if(g->practice == '1' && (result == GAMERESPAWNED || result == GAMEOVER))
+                {
+                    //practice: straight back to the start of the level, with no pause and no life lost
+                    loadGameState(&g->levelStart, t, lvl);
+                    clearStateRing(&g->history);
+                    pushState(&g->history, t, lvl);
+                    prevX = t->x;
+                    prevY = t->y;
+                    continue;
+                }
+                //pause game, for gamefeel
+                if(result != GAMEOVER)
+                {
+                    waitMs += RESULTPAUSEMS;
+                }
+                if(result == GAMEOVER || result == GAMEWON)
+                {
+                    ending = '1';
+                    waitMs += ENDPAUSEMS;
+                }
+                //moved on to the next level
+                if(result == GAMENEWLEVEL || result == GAMEWON)
+                {
+                    levelLoads++;
+                    //practice restarts and rewinds only go back as far as the start of the new level
+                    saveGameState(&g->levelStart, t, lvl);
+                    clearStateRing(&g->history);
+                    pushState(&g->history, t, lvl);
+                }
+                //the taxi has been moved back to the start, so don't draw it sliding there
+                //and don't count the pause as time to catch up on
+                prevX = t->x;
+                prevY = t->y;
+                accumulator = 0;
             }
-        } 
-        //boundary lines
-        for(i=0;i<lvl->numbounds;i++)
+        }
+        else
         {
-            if(intersectBBxL(b, lvl->bounds[i]) == 1)
-            {
-                t->justDied = '1';
-                t->inflight = '0';
-                t->bintact = '0';
-            }
+            accumulator = 0;
+        }
+        publishSnapshot(g, prevX, prevY, accumulator, levelLoads, paused, '0');
+
+        //sleeps until the next step is due
+        if(paused == '0' && waitMs <= 0 && accumulator < g->stepMs)
+        {
+            SDL_Delay((Uint32)(g->stepMs - accumulator));
         }
-        //exit level above
-        if(b.y1 > 600)
+        else
         {
-            t->nextLevel = '1';
+            SDL_Delay(1);
         }
     }
-
+    stopRecording(&g->rec, tick, result, t);
+    publishSnapshot(g, prevX, prevY, 0, levelLoads, paused, '1');
+    return 0;
 }
-void drawTaxi(taxi *t, level *lvl)
-{
-    //this function draws the taxi to screen
-
-    /*////////////////////////////////////////////////////////*/
-    GLint matrixmode=0;
-	glGetIntegerv(GL_MATRIX_MODE,&matrixmode); /* get current matrix mode */
-	
-	glMatrixMode(GL_MODELVIEW); /* set the modelview matrix */
-	glPushMatrix(); /* store current modelview matrix */
-	glTranslated(t->x,t->y,0.0); /* move the lander to its correct position */
-    /*////////////////////////////////////////////////////////*/
-
-
-    //sets the direction of the taxi based on horizontal thruster direction
-    if(t->hThrust < 0)
-	{
-		t->direction = 'l';
-	}
-	else if(t->hThrust > 0)
-	{
-		t->direction = 'r';
-	}
-
 
-    //sets colour of taxi
-    if(t->bintact == '0')
-    {
-        glColor3d(1.0,0.0,0.0); //Taxi is red if destroyed.
-    }
-    else if(lvl->customerWaiting == '1')
-    {
-        glColor3d(1.0,1.0,0.0); /* Taxi is yellow if noone is riding*/
-    }
-    else
-    {
-        glColor3d(0.0,1.0,0.0); /* Taxi is green if someone is riding*/
-    }
-	if(t->direction == 'l')
-	{
-           if(t->wheelLandersEnabled == '0')
-           {
-               glBegin(GL_TRIANGLE_FAN); /* draw Taxi */
-	    		glVertex3d(13.0,12.0,0.0);
-	    		glVertex3d(16.0,3.0,0.0);
-	    		glVertex3d(25.0,3.0,0.0);
-			    glVertex3d(25.0,-6.0,0.0); //values here have been - 1 to center
-	    		glVertex3d(-26.0,-6.0,0.0);
-    			glVertex3d(-26.0,0.0,00);
-   				glVertex3d(-14.0,3.0,0.0);
-			    glVertex3d(-8.0,12.0,0.0);
-		    glEnd();
-           }
-           else
-           {
-               glBegin(GL_TRIANGLE_FAN); /* draw Taxi with landing wheels */
-	    		glVertex3d(13.0,12.0,0.0);
-	    		glVertex3d(16.0,3.0,0.0);
-	    		glVertex3d(25.0,3.0,0.0);
-			    glVertex3d(25.0,-6.0,0.0); //values here have been - 1 to center
-		    	glVertex3d(22.0,-6.0,0.0);
-	    		glVertex3d(17.0,-9.0,0.0);
-		    	glVertex3d(13.0,-9.0,0.0);
-	    		glVertex3d(10.0,-6.0,0.0);
-		    	glVertex3d(-5.0,-6.0,0.0);
-	    		glVertex3d(-8.0,-9.0,0.0);
-			    glVertex3d(-14.0,-9.0,0.0);
-		    	glVertex3d(-17.0,-6.0,0.0);
-	    		glVertex3d(-26.0,-6.0,0.0);
-    			glVertex3d(-26.0,0.0,00);
-   				glVertex3d(-14.0,3.0,0.0);
-			    glVertex3d(-8.0,12.0,0.0);
-		    glEnd();
-           }
-	}
-	else
-	{
-           if(t->wheelLandersEnabled == '0')
-           {
-	    	glBegin(GL_TRIANGLE_FAN); /* draw Taxi */
-    			glVertex3d(-13.0,12.0,0.0);
-		    	glVertex3d(-16.0,3.0,0.0);
-		    	glVertex3d(-25.0,3.0,0.0);
-	    		glVertex3d(-25.0,-6.0,0.0);  //values here have been + 1 to center
-		    	glVertex3d(26.0,-6.0,0.0);
-    			glVertex3d(26.0,0.0,00);
-    			glVertex3d(14.0,3.0,0.0);
-			    glVertex3d(8.0,12.0,0.0);
-		    glEnd();            
-           }
-           else
-           {
-	    	glBegin(GL_TRIANGLE_FAN); /* draw Taxi with landing wheels */
-    			glVertex3d(-13.0,12.0,0.0);
-		    	glVertex3d(-16.0,3.0,0.0);
-		    	glVertex3d(-25.0,3.0,0.0);
-	    		glVertex3d(-25.0,-6.0,0.0);
-    			glVertex3d(-22.0,-6.0,0.0);
-    			glVertex3d(-19.0,-9.0,0.0);
-    			glVertex3d(-13.0,-9.0,0.0); //values here have been + 1 to center
-	    		glVertex3d(-10.0,-6.0,0.0);
-	    		glVertex3d(5.0,-6.0,0.0);
-    			glVertex3d(8.0,-9.0,0.0);
-   				glVertex3d(14.0,-9.0,0.0);
-	    		glVertex3d(17.0,-6.0,0.0);
-		    	glVertex3d(26.0,-6.0,0.0);
-    			glVertex3d(26.0,0.0,00);
-    			glVertex3d(14.0,3.0,0.0);
-			    glVertex3d(8.0,12.0,0.0);
-		    glEnd();                
-           }
-
-	}
-
-}
-void render(taxi *t, level *lvl)
+//main
+int main(int argc, char **argv)
 {
-    //this function draws all the level information to the screen
+    int winposx = 100;
+    int winposy = 100;
+    int windowWidth = WINWIDTH;
+    int windowHeight = WINHEIGHT;
+    int physicsHz = PHYSICSHZ;
+    int vsync = 1;
+    const char *packPath = "levels.bin";
+    const char *recordPath = NULL;
+    const char *tracePath = NULL;
+    const char *capturePath = NULL;
+    char showProfile = '0';
+    char demo = '0';
+    char playCavern = '0';
+    char practice = '0';
+    int fleetSize = 0;
+    int rainDrops = RAINDROPS;
+    unsigned int seed = time(NULL);
     int i;
 
-   	glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-
-    //adds rain, if the level has it on
-    if(lvl->isRaining == '1')
+    //command line options: --hz N for the physics rate, --uncapped to draw as fast as possible instead of at the display refresh,
+    //--levels file to play a different level pack, --seed N to play the same game again,
+    //--record file to save the game's controls for playing back with spacetaxi_headless replay,
+    //--rain N for the number of rain drops in rainy levels, --profile to show how long each part of a frame takes (or press P), --trace file to save the timings for chrome://tracing,
+    //--autopilot to watch the computer fly (return still pauses), --cavern to fly along a procedural cavern made from the seed,
+    //--practice for practice mode (crashes restart the level straight away, R rewinds), --fleet N for N computer flown taxis to share the level with,
+    //--capture file to record a video of the game as it's drawn (Y4M if the name ends in .y4m, raw RGB24 otherwise)
+    for(i = 1; i < argc; i++)
     {
-        //adds randomised blue lines to the screen each frame
-        glColor3d(0.0,1.0,1.0); //the rain is blue
-        for(i=0;i<40;i++)
+        if(strcmp(argv[i], "--hz") == 0 && i + 1 < argc)
+        {
+            physicsHz = atoi(argv[++i]);
+            if(physicsHz < 10)
+            {
+                physicsHz = 10;
+            }
+        }
+        else if(strcmp(argv[i], "--uncapped") == 0)
         {
-            int k = rand()%800;
-            int e = rand()%500 + 100;
-            glBegin(GL_LINES);
-                glVertex3d(k,e,0.0);
-                glVertex3d(k+5,e+5,0.0);
-            glEnd();
+            vsync = 0;
         }
-    }
-
-    // draw lines
-    // first the boundary lines...
-    glColor3d(0.5,0.5,0.5);
-    for(i=0;i<lvl->numbounds;i++)
-    {
-        glBegin(GL_LINES);
-            glVertex3d(lvl->bounds[i].x1,lvl->bounds[i].y1,0.0f);
-            glVertex3d(lvl->bounds[i].x2,lvl->bounds[i].y2,0.0f);
-        glEnd();
-    }
-    // ...then the landing platforms
-    glColor3d(0.0,1.0,0.0);
-    for(i=0;i<lvl->numplatforms;i++)
-    {
-        //sets the colour of the landing platform
-        if(lvl->customerWaiting == '0' && lvl->currentCustomer.destPlatform == i)
+        else if(strcmp(argv[i], "--levels") == 0 && i + 1 < argc)
         {
-            glColor3d(0.0,1.0,0.0); //bright green if it is the destination platform
+            packPath = argv[++i];
         }
-        else
+        else if(strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            seed = strtoul(argv[++i], NULL, 10);
+        }
+        else if(strcmp(argv[i], "--record") == 0 && i + 1 < argc)
         {
-            glColor3d(0.0,1.0,0.5); //duller green if not
+            recordPath = argv[++i];
         }
-        //print the platform number
-        printLetter(i + 1, lvl->platforms[i].l.x1 + 30, lvl->platforms[i].l.y1 - 9);
-        //draw the platform line
-        glBegin(GL_LINES);
-            glVertex3d(lvl->platforms[i].l.x1,lvl->platforms[i].l.y1,0.0f);
-            glVertex3d(lvl->platforms[i].l.x2,lvl->platforms[i].l.y1,0.0f);
-        glEnd();
-        //checks if there is a customer on the platform
-        if(lvl->currentCustomer.fromPlatform == i && lvl->customerWaiting == '1')
+        else if(strcmp(argv[i], "--rain") == 0 && i + 1 < argc)
         {
-            //if there is a customer, draws a blue line to represent a person on the platform
-            glColor3d(0.0,0.0,1.0);
-            glBegin(GL_LINES);
-                glVertex3d(lvl->platforms[i].l.x1 + 3,lvl->platforms[i].l.y1 + 3,0.0f);
-                glVertex3d(lvl->platforms[i].l.x1 + 3,lvl->platforms[i].l.y1 + 8,0.0f);
-            glEnd();
-            glColor3d(0.0,1.0,0.0);
+            rainDrops = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--profile") == 0)
+        {
+            showProfile = '1';
+        }
+        else if(strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+        {
+            tracePath = argv[++i];
+        }
+        else if(strcmp(argv[i], "--autopilot") == 0)
+        {
+            demo = '1';
+        }
+        else if(strcmp(argv[i], "--cavern") == 0)
+        {
+            playCavern = '1';
+        }
+        else if(strcmp(argv[i], "--practice") == 0)
+        {
+            practice = '1';
+        }
+        else if(strcmp(argv[i], "--fleet") == 0 && i + 1 < argc)
+        {
+            fleetSize = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--capture") == 0 && i + 1 < argc)
+        {
+            capturePath = argv[++i];
         }
     }
+    printf("seed %u\n", seed);
 
-    //draw player's lives
-    char vv[7] = "Lives ";
-    vv[6] = t->lives;
-    for(i=6; i >= 0; i--)
+    //the levels, mapped from the level pack file
+    levelPack pack;
+    if(openLevelPack(&pack, packPath) == 0)
     {
-        printLetter(vv[i], 14 * i + 600, 80);
+        return 1;
     }
 
-    //draw player's current money total
-    glColor3d(0.5,0.5,1.0);
-    int a = t->money;
-    for(i=9; i > 0; i--)
+    SDL_Window *window = SDL_CreateWindow("Taxi D'espace", winposx, winposy, windowWidth, windowHeight, SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN);
+	SDL_GLContext context = SDL_GL_CreateContext(window);
+    SDL_GL_SetSwapInterval(vsync);
+
+    //fixed GL state and the camera
+    setupView(windowWidth, windowHeight);
+
+    //vertex buffers for drawing
+    renderer rend;
+    glTarget gl;
+    initRenderer(&rend, windowWidth, windowHeight);
+    useGLBackend(&rend, &gl);
+    rend.showProfile = showProfile;
+
+    //the video recording, read back from each drawn frame (startCapture says why if it can't)
+    videoCapture capture;
+    if(capturePath != NULL && startCapture(&capture, capturePath, windowWidth, windowHeight) == 0)
     {
-        printLetter(a%10, 14 * i + 5, 50);
-        a /= 10;
+        capturePath = NULL;
     }
-
-    //draw timer
-    int c = lvl->currentCustomer.fare;
-    for(i=4; i > 0; i--)
+    if(rainDrops != RAINDROPS)
     {
-        printLetter(c%10, 14 * i + 620, 50);
-        c /= 10;
+        freeRain(&rend.rain);
+        initRain(&rend.rain, rainDrops);
     }
+    profileEnable(showProfile == '1' || tracePath != NULL);
 
-    //draw customer text
-    char b[21] = "Hey taxi! Platform  !";
-    char v[21] = "Hey taxi! Up!        ";
-    if(lvl->levelCustomerCurrentNumber == lvl->levelCustomerNumber)
+    //map and play objects setup, everything random in the game comes from the seed
+    //the simulation thread plays the game, this thread handles the window: key events in, snapshots drawn
+    static gameThread g;
+    g.pack = &pack;
+    g.stepMs = 1000.0 / physicsHz;
+    static cavern cave;
+    g.cave = NULL;
+    if(playCavern == '1')
     {
-        for(i=20; i >= 0; i--)
+        if(startCavernGame(&g.t, &g.lvl, &cave, seed, CAVERNCHUNKS) == 0)
         {
-            printLetter(v[i], 14 * i + 20, 80);
+            printf("out of memory for the cavern\n");
+            if(capturePath != NULL)
+            {
+                stopCapture(&capture);
+            }
+            freeRenderer(&rend);
+            freeGLTarget(&gl);
+            closeLevelPack(&pack);
+            SDL_GL_DeleteContext(context);
+            SDL_DestroyWindow(window);
+            SDL_Quit();
+            return 1;
         }
+        loadCavernRenderer(&rend, &g.lvl, &cave);
+        g.cave = &cave;
     }
     else
     {
-        b[19] = lvl->currentCustomer.destPlatform + 1;
-        for(i=20; i >= 0; i--)
+        startGame(&g.t, &g.lvl, &pack, seed);
+        loadLevelRenderer(&rend, &g.lvl);
+    }
+    initTripleBuffer(&g.snapshotBuffer);
+    initInputQueue(&g.input);
+    atomic_init(&g.quit, 0);
+    //the first snapshot, so there's something to draw before the simulation publishes one
+    g.snapshots[0].t = g.t;
+    g.snapshots[0].lvl = g.lvl;
+    g.snapshots[0].prevX = g.t.x;
+    g.snapshots[0].prevY = g.t.y;
+    g.snapshots[0].stepCounter = SDL_GetPerformanceCounter();
+    g.snapshots[0].levelLoads = 0;
+    g.snapshots[0].paused = '1';
+    g.snapshots[0].finished = '0';
+    //fleet mode, each snapshot gets room for a copy of the fleet's taxis
+    static fleet traffic;
+    g.fleet = NULL;
+    for(i = 0; i < 3; i++)
+    {
+        g.snapshots[i].fleet = NULL;
+        g.snapshots[i].numFleet = 0;
+    }
+    if(fleetSize > 0 && g.cave != NULL)
+    {
+        printf("fleets only fly the level pack's levels, not caverns\n");
+    }
+    else if(fleetSize > 0 && initFleet(&traffic, fleetSize, seed))
+    {
+        g.fleet = &traffic;
+        for(i = 0; i < 3; i++)
         {
-            printLetter(b[i], 14 * i + 20, 80);
+            g.snapshots[i].fleet = malloc(sizeof(taxi) * traffic.numTaxis);
+            if(g.snapshots[i].fleet == NULL)
+            {
+                g.fleet = NULL;
+            }
         }
     }
+    int levelLoads = 0;
 
-    //draw current velocity
-    char bv[21] = "Velocity: ";
-    int tempVel = abs(t->velocity) / 10;
-
-    if(tempVel > 10)
+    //the controls used at each step can be saved, as the seed and fixed step make the rest of the game the same every time
+    g.rec.f = NULL;
+    if(recordPath != NULL && (g.cave != NULL || practice == '1' || g.fleet != NULL))
     {
-        glColor3d(1.0,0.0,0.0);
+        printf("recordings are only of level pack games without practice mode or a fleet, not saving one\n");
     }
-    else if(tempVel > 5)
+    else if(recordPath != NULL)
     {
-        glColor3d(1.0,1.0,0.0);
+        startRecording(&g.rec, recordPath, seed, g.stepMs);
     }
-    else
+    //practice mode keeps the last REWINDSECONDS of steps, allocated once here
+    g.practice = '0';
+    g.history.states = NULL;
+    clearStateRing(&g.history);
+    if(practice == '1' && g.cave != NULL)
     {
-        glColor3d(0.0,1.0,0.0);
+        //a saved state doesn't have the cavern's customers, so rewinding would leave them at the wrong time
+        printf("practice mode is only for the level pack's levels, not caverns\n");
     }
-    
-    bv[12] = abs(tempVel % 10);
-    tempVel /= 10;
-    bv[11] = abs(tempVel % 10);
-    tempVel /= 10;
-    bv[10] = abs(tempVel % 10);
-    for(i=0; i < 13; i++)
+    else if(practice == '1' && g.fleet != NULL)
     {
-        printLetter(bv[i], 14 * i + 300, 30);
+        //nor the fleet's taxis, so rewinding would move the player back among taxis still where they are now
+        printf("practice mode is only for games without a fleet\n");
     }
-
-
-    //draw taxi
-    drawTaxi(t, lvl);
-    //print it to screen
-    glFlush();
-}
-
-
-void makeLevel1(level *lvl)
-{
-    /*
-        The first level is very simple, only one platform in the centre.
-        8 boundary lines, 1 pad
-    */
-    /* first create the level boundaries */
-    lseg t; //temp line segment
-	t.x1 = 1.0;
-	t.y1 = 101.0;
-	t.x2 = 1.0;
-	t.y2 = 599.0;
-	lvl->bounds[0]=t;
-	t.x1 = 1.0;
-	t.y1 = 101.0;
-	t.x2 = 799.0;
-	t.y2 = 101.0;
-    lvl->bounds[1]=t;
-	t.x1 = 799.0;
-	t.y1 = 101.0;
-	t.x2 = 799.0;
-	t.y2 = 599.0;
-	lvl->bounds[2]=t;
-	t.x1 = 1.0;
-	t.y1 = 599.0;
-	t.x2 = 300.0;
-	t.y2 = 599.0;
-	lvl->bounds[3]=t; 
-    t.x1 = 500.0;
-	t.y1 = 599.0;
-	t.x2 = 799.0;
-	t.y2 = 599.0;
-	lvl->bounds[4]=t; 
-	
-    lvl->numbounds = 5;
-    lvl->numplatforms = 0;
-
-    createPlatform(lvl, 180, 620, 250, 250, 1);
-    //createPlatform(lvl, 400, 550, 450, 450, 2);
-
-    // check for rain
-    lvl->rainChance = 5;
-    if(rand()%100 > lvl->rainChance)
-    {
-        lvl->isRaining = '1';
-    }
-    else
+    else if(practice == '1' && initStateRing(&g.history, (int)(REWINDSECONDS * 1000.0 / g.stepMs) + 1))
     {
-        lvl->isRaining = '0';
+        g.practice = '1';
     }
-
-    //set level cutomer numbers
-    lvl->levelCustomerNumber = 1;
-    lvl->levelCustomerCurrentNumber = 0;
-}
-void makeLevel2(level *lvl)
-{
-    /*
-        The second level is a bit more complicated, with two landin pads
-        11 boundary lines, 2 pads
-    */
-    
-    /* first create the level boundaries */
-    lseg t; //temp line segment
-	t.x1 = 1.0;
-	t.y1 = 101.0;
-	t.x2 = 1.0;
-	t.y2 = 599.0;
-	lvl->bounds[0]=t;
-	t.x1 = 1.0;
-	t.y1 = 101.0;
-	t.x2 = 799.0;
-	t.y2 = 101.0;
-	lvl->bounds[1]=t;
-	t.x1 = 799.0;
-	t.y1 = 101.0;
-	t.x2 = 799.0;
-	t.y2 = 599.0;
-	lvl->bounds[2]=t;
-	t.x1 = 1.0;
-	t.y1 = 599.0;
-	t.x2 = 300.0;
-	t.y2 = 599.0;
-	lvl->bounds[3]=t; 
-    t.x1 = 500.0;
-	t.y1 = 599.0;
-	t.x2 = 799.0;
-	t.y2 = 599.0;
-	lvl->bounds[4]=t; 
-
-    lvl->numbounds = 5;
-    lvl->numplatforms = 0;
-
-    createPlatform(lvl, 50, 250, 250, 250, 1);
-    createPlatform(lvl, 400, 550, 250, 250, 2);
-
-    // check for rain
-    lvl->rainChance = 40;
-    if(rand()%100 > lvl->rainChance)
+    //demo mode, the autopilot's workers use the spare processors
+    static autopilot pilot;
+    g.pilot = NULL;
+    if(demo == '1' && g.cave != NULL)
     {
-        lvl->isRaining = '1';
+        //its distance maps only cover the window's area
+        printf("the autopilot only flies the level pack's levels, not caverns\n");
     }
-    else
+    else if(demo == '1' && startAutopilot(&pilot, autopilotWorkers(), g.stepMs, seed))
     {
-        lvl->isRaining = '0';
+        g.pilot = &pilot;
     }
+    SDL_Thread *simThread = SDL_CreateThread(simulationThread, "simulation", &g);
 
-    //set level cutomer numbers
-    lvl->levelCustomerNumber = 3;
-    lvl->levelCustomerCurrentNumber = 1;
-}
-void makeLevel3(level *lvl)
-{
-    /*
-        The second level is a bit more complicated, with two landin pads
-        32 boundary lines, 9 pads
-    */
-
-    /* first create the level boundaries */
-    lseg t; //temp line segment
-	t.x1 = 1.0;
-	t.y1 = 101.0;
-	t.x2 = 1.0;
-	t.y2 = 599.0;
-	lvl->bounds[0]=t;
-	t.x1 = 1.0;
-	t.y1 = 101.0;
-	t.x2 = 799.0;
-	t.y2 = 101.0;
-	lvl->bounds[1]=t;
-	t.x1 = 799.0;
-	t.y1 = 101.0;
-	t.x2 = 799.0;
-	t.y2 = 599.0;
-	lvl->bounds[2]=t;
-	t.x1 = 1.0;
-	t.y1 = 599.0;
-	t.x2 = 300.0;
-	t.y2 = 599.0;
-	lvl->bounds[3]=t; 
-    t.x1 = 500.0;
-	t.y1 = 599.0;
-	t.x2 = 799.0;
-	t.y2 = 599.0;
-	lvl->bounds[4]=t; 
-
-    lvl->numbounds = 5;
-    lvl->numplatforms = 0;
-    
-    createPlatform(lvl, 20, 100, 250, 250, 1);
-    createPlatform(lvl, 120, 200, 250, 250, 2);
-    createPlatform(lvl, 220, 300, 250, 250, 3);
-    createPlatform(lvl, 320, 400, 250, 250, 4);
-    createPlatform(lvl, 420, 500, 250, 250, 5);
-    createPlatform(lvl, 520, 600, 250, 250, 6);
-    createPlatform(lvl, 620, 700, 250, 250, 7);
-    createPlatform(lvl, 500, 600, 400, 400, 8);
-    createPlatform(lvl, 180, 620, 500, 500, 9);
-
-    // check for rain
-    lvl->rainChance = 90;
-    if(rand()%100 > lvl->rainChance)
-    {
-        lvl->isRaining = '1';
-    }
-    else
-    {
-        lvl->isRaining = '0';
-    }
-
-    //set level cutomer numbers
-    lvl->levelCustomerNumber = 9;
-    lvl->levelCustomerCurrentNumber = 1;
-}
-
-
-//main
-int main(int argc, char **argv)
-{
-    int winposx = 100;
-    int winposy = 100;
-    int windowWidth = WINWIDTH;
-    int windowHeight = WINHEIGHT;
-    Uint32 timer;
-
-    SDL_Window *window = SDL_CreateWindow("Taxi D'espace", winposx, winposy, windowWidth, windowHeight, SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN);
-	SDL_GLContext context = SDL_GL_CreateContext(window);
-
-    /*//////////////////////////////////////////////////*/
-    /* Set up the parts of the scene that will stay the same for every frame. */
-    glFrontFace(GL_CCW);     /* Enforce counter clockwise face ordering (to determine front and back side) */
-    glEnable(GL_NORMALIZE);
-	glShadeModel(GL_FLAT); /* enable flat shading - Gouraud shading would be GL_SMOOTH */
-
-
-    glEnable(GL_DEPTH_TEST);
-
-    /* Set the clear (background) colour */
-    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-
-    /* Set up the camera/viewing volume (projection matrix) and the timer */
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    gluOrtho2D(0.0, (GLdouble)(windowWidth-1),0.0,(GLdouble)(windowHeight-1));
-    glViewport(0,0,windowWidth,windowHeight);
-    /*//////////////////////////////////////////////////*/
-
-    //map setup
-    level lvl;
-    makeLevel1(&lvl);
-    customerMakeNext(&lvl, 999, 'f');
-
-    //play objects setup
-    taxi t;
-    initialiseTaxi(&t, 400, 400, 3);
-
-    //set game flags, first for while playing, second for pause function
+    Uint64 lastCounter = SDL_GetPerformanceCounter();
     int go = 1;
-    int go1 = 0;
     while(go)
     {
         SDL_Event incomingevent;
+        double frameMs = frameTimer(&lastCounter);
+        long long frameTimerStart = profileStart();
+        long long stageTimer = profileStart();
 
+        //key presses are passed on to the simulation thread, which applies them at its next step
         while(SDL_PollEvent(&incomingevent))
         {
             switch(incomingevent.type)
@@ -1571,61 +521,44 @@ int main(int argc, char **argv)
                 // key events
                 switch(incomingevent.key.keysym.sym)
                 {
-                    //pause function, press 1 to pause or unpause game
+                    //pause function, press enter to pause or unpause game
                     case SDLK_RETURN:
-                    if(go1 == 1)
-                    {
-                        //game paused
-                        go1 = 0;
-                    }
-                    else
+                    inputQueuePush(&g.input, INPUTPAUSE, 0);
+                    break;
+                    //rewind, in practice mode
+                    case SDLK_r:
+                    inputQueuePush(&g.input, INPUTREWIND, 0);
+                    break;
+                    //shows or hides the profile overlay, timing starts the first time it's shown
+                    case SDLK_p:
+                    rend.showProfile = rend.showProfile == '1' ? '0' : '1';
+                    if(rend.showProfile == '1')
                     {
-                        //game unpaused
-                        go1 = 1;
+                        profileEnable(1);
                     }
                     break;
                     //direction keys
                     //a;left
                     case SDLK_LEFT:
                     case SDLK_a:
-                    if(t.wheelLandersEnabled == '0')
-                    {
-                        t.hThrust = -1;
-                    }
+                    inputQueuePush(&g.input, INPUTHTHRUST, -1);
                     break;
                     //d;right
                     case SDLK_RIGHT:
                     case SDLK_d:
-                    if(t.wheelLandersEnabled == '0')
-                    {
-                        t.hThrust = 1;
-                    }
+                    inputQueuePush(&g.input, INPUTHTHRUST, 1);
                     break;
                     //w;up
                     case SDLK_UP:
                     case SDLK_w:
                     //up thruster enabled
-                    t.vThrust = 1;
-                    //is in air flag
-                    t.inflight = '1';
-                    //is no longer landed
-                    t.landingOnceCustoCheck = '0';
+                    inputQueuePush(&g.input, INPUTVTHRUST, 1);
                     break;
                     //d;down
                     case SDLK_DOWN:
                     case SDLK_s:
-                    //checks if landers are enables, and reverses it
-                    if(t.wheelLandersEnabled == '1')
-                    {
-                        t.wheelLandersEnabled = '0';
-                        //puts the lander back in flight in case it was landed
-                        t.inflight = '1';
-                    }
-                    else
-                    {
-                        t.wheelLandersEnabled = '1';
-                    }
-                    
+                    //raises or lowers the landing wheels on the next step
+                    inputQueuePush(&g.input, INPUTWHEELS, 0);
                     break;
                 }
                 break;
@@ -1635,116 +568,96 @@ int main(int argc, char **argv)
                     //removes thrusts once key is lifted
                     case SDLK_LEFT:
                     case SDLK_a:
-                    t.hThrust = 0;
-                    break;
                     case SDLK_RIGHT:
                     case SDLK_d:
-                    t.hThrust = 0;
+                    inputQueuePush(&g.input, INPUTHTHRUST, 0);
                     break;
                     case SDLK_UP:
                     case SDLK_w:
-                    t.vThrust = 0;
+                    inputQueuePush(&g.input, INPUTVTHRUST, 0);
                     break;
                 }
             }
         }
-        if(go1 != 0 || t.nextLevel == '1')
+        profileEnd(STAGEINPUT, stageTimer);
+
+        //the newest state of the game
+        gameSnapshot *snap = &g.snapshots[tripleBufferLatest(&g.snapshotBuffer)];
+        if(snap->levelLoads != levelLoads)
         {
-            if(t.money > 10000 && t.bonusGiven == 0)
+            loadLevelRenderer(&rend, &snap->lvl);
+            levelLoads = snap->levelLoads;
+        }
+        if(snap->finished == '1')
+        {
+            go = 0;
+        }
+        if(snap->paused == '0')
+        {
+            //draws the taxi part way between its last two physics positions, so it moves smoothly at any frame rate
+            taxi drawn = snap->t;
+            double alpha = (double)(SDL_GetPerformanceCounter() - snap->stepCounter) * 1000.0 / SDL_GetPerformanceFrequency() / g.stepMs;
+            if(alpha > 1.0)
             {
-                t.lives++;
-                t.bonusGiven = 1;
+                alpha = 1.0;
             }
-            doEvents(&t,lvl.changedTicks * 0.0005,&lvl);
-            if(t.justDied == '1')
+            drawn.x = snap->prevX + (snap->t.x - snap->prevX) * alpha;
+            drawn.y = snap->prevY + (snap->t.y - snap->prevY) * alpha;
+            //render the screen, the rain moves with the frames rather than the physics steps as it's only for show
+            stageTimer = profileStart();
+            if(snap->lvl.isRaining == '1')
             {
-                if(t.lives > 1)
-                {
-                    //has died: reset taxi flags
-                    //reset position
-                    t.x = 400.0;
-                    t.y = 400.0;
-                    //decrement lives
-                    t.lives--;
-                    //now in flight and intact
-                    t.inflight = '1';
-                    t.bintact = '1';
-                    //reset speed and thrusts
-                    t.vSpeed = 0.0;
-                    t.hSpeed = 0.0;
-                    t.vThrust = 0.0;
-                    t.hThrust = 0.0;
-                    //customer no longer in taxi
-                    t.custo_waiting = '0';
-                    customerMakeNext(&lvl, 999, 't');
-                    lvl.customerWaiting = '0';
-                    //lvl.
-                    //pause game, for gamefeel
-                    waitForSecs(2, '1');
-                    //resets just died flag, no longer dieing
-                    t.justDied = '0';
-                }
-                else
-                {
-                    go = 0;
-                }
+                updateRain(&rend.rain, frameMs > MAXFRAMEMS ? MAXFRAMEMS : frameMs);
             }
-            //check if going to next level
-            else if(t.nextLevel == '1')
+            rend.fleet = snap->fleet;
+            rend.numFleet = snap->numFleet;
+            render(&drawn,&snap->lvl,&rend);
+            //the capture only starts reading back the frame here, so it's timed as part of drawing it
+            if(capturePath != NULL)
             {
-                //if true: increment level, then check which level to load
-                t.levelCurrent++;
-                if(t.levelCurrent == 1)
-                {
-                    //loading level 1 + new customer
-                    makeLevel1(&lvl);
-                    lvl.currentCustomer.destPlatform = (rand() % lvl.numplatforms);
-                }
-                else if(t.levelCurrent == 2)
-                {
-                    //loading level 2 + new customer
-                    makeLevel2(&lvl);
-                    lvl.currentCustomer.destPlatform = (rand() % lvl.numplatforms);
-                }
-                else if(t.levelCurrent == 3)
-                {
-                    //loading level 3 + new customer
-                    makeLevel3(&lvl);
-                    lvl.currentCustomer.destPlatform = (rand() % lvl.numplatforms);
-                }
-                else
-                {
-                    //end of the game you won what, add stuff in here like and end screen or sumethin' plez future me, k thx bi!
-                    go = 0;
-                    lvl.numbounds = 0;
-                    lvl.numplatforms = 0;
-                    lvl.isRaining = '0';
-                }
-                //resets for next level:
-                //reset taxi position
-                t.x = 400.0;
-                t.y = 400.0;
-                //reset thrusts & speed
-                t.vSpeed = 0.0;
-                t.hSpeed = 0.0;
-                t.vThrust = 0.0;
-                t.hThrust = 0.0;
-                printf("\n%d\n", lvl.currentCustomer.destPlatform);
-                //pause game, for gamefeel
-                waitForSecs(2,'1');
-                //resets next level flag, no longer going to next level
-                t.nextLevel = '0';
+                captureFrame(&capture, frameMs);
             }
-            //render the screen
-            render(&t,&lvl);
+            profileEnd(STAGERENDER, stageTimer);
         }
+        stageTimer = profileStart();
         SDL_GL_SwapWindow(window);
+        profileEnd(STAGESWAP, stageTimer);
+        profileEnd(STAGEFRAME, frameTimerStart);
+    }
+    //stops the simulation if the window was closed, and waits for it to save its recording
+    atomic_store(&g.quit, 1);
+    SDL_WaitThread(simThread, NULL);
+    if(g.pilot != NULL)
+    {
+        stopAutopilot(g.pilot);
+    }
+    freeStateRing(&g.history);
+    freeFleet(&traffic);
+    for(i = 0; i < 3; i++)
+    {
+        free(g.snapshots[i].fleet);
+    }
+    if(tracePath != NULL)
+    {
+        profileWriteTrace(tracePath);
+    }
+    if(capturePath != NULL)
+    {
+        stopCapture(&capture);
+        printf("captured %lld frames to %s (%lld dropped)%s\n", capture.written, capturePath, capture.dropped, capture.failed == '1' ? ", writing failed" : "");
     }
-    waitForSecs(4, '0');
     //exit cleanup
+    freeRenderer(&rend);
+    freeGLTarget(&gl);
+    freeLevel(&g.lvl);
+    if(g.cave != NULL)
+    {
+        freeCavern(g.cave);
+    }
+    closeLevelPack(&pack);
     SDL_GL_DeleteContext(context);
 	SDL_DestroyWindow(window);
 	SDL_Quit();
 
 	return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,220 @@
+#ifndef SPACETAXI_H
+#define SPACETAXI_H
+//shared game state and simulation functions
+//nothing in here needs SDL or OpenGL, so the simulation can be built without a display (see headless.c)
+
+//gameplay constants::
+//window dimensions
+#define WINWIDTH     800;
+#define WINHEIGHT    600;
+//max safe velocity that won't crash the taxi
+#define SAFEVELOCITY 100.0;
+//force of gravity on taxi
+#define GRAVITY      200.0;
+//strength of vertical thrusters of taxi
+#define VERTICALSTR  400.0;
+//strength of horizontal thrusters of taxi
+#define HORIZONTSTR  280.0;
+//how many simulation 'frames' pass per millisecond of game time
+#define SIMSPEED     0.0005;
+
+typedef struct
+{
+    //line segment, if taxi collides it crashes and loses a life
+    //made of two connected coordinates
+    double x1;
+    double y1;
+    double x2;
+    double y2;
+}lseg;
+
+typedef struct
+{
+    //information needed for each customer
+    double fare; //how much money currently giving, decrements by 10 (£0.10) each second
+    double timeWaiting; //how long the customer has been waiting, increments each second until at destination
+
+    char name[4]; //5 letter name of customer
+
+    int destPlatform; //int 1 to 10 to tell destination platform (10 for top exit)
+    int fromPlatform; //int 1 to 10 to tell where the customer starts (10 from previous level)
+}customer;
+
+typedef struct
+{
+    //the landing pads, on which the taxi can land and customers spawn
+    //only a line segment, so pads can be stored in level packs the same way as boundary lines
+    lseg l; //contains a line segment for collission detection and coordinates for rendering the line
+}lpad;
+
+typedef struct
+{
+    //bounding box, consisting of two opposite coordinates of a box
+    double x1;
+    double y1;
+    double x2;
+    double y2;
+}bbox;
+
+//size of the collision grid cells, in level units (made bigger for very spread out levels)
+#define GRIDCELLSIZE 64.0
+//most segments one grid query will hand back before doEvents gives up and checks them all
+#define GRIDMAXFOUND 256
+
+typedef struct
+{
+    //uniform grid over the level's line segments, so collision checks only look at segments near the taxi
+    //built once per level by buildLevelGrid(), segment ids are platform numbers first then numplatforms + boundary number
+    double x, y;     //bottom left corner of the grid
+    double cellSize; //width and height of each cell
+    int cols, rows;
+    int *cellStart;  //cols*rows+1 offsets into items, a cell's segments are items[cellStart[c]] to items[cellStart[c+1]-1]
+    int *items;      //segment ids, grouped by cell
+    int *segCol;     //the first column and row of cells each segment covers, so a segment
+    int *segRow;     //spread over several cells is only reported once by a query
+    int numPads;     //the number of platforms and boundary lines the grid was built for,
+    int numBounds;   //if the level no longer matches, doEvents checks every segment instead
+}segGrid;
+
+typedef struct
+{
+    //taxi and general game information not specific to any level
+    double x; // X coordinate of the taxi
+	double y; // Y coordinate of the taxi
+    bbox bb; // bounding box of taxi
+
+	double vSpeed; // vertical velocity of taxi
+	double hSpeed; // horizontal velocity of taxi
+	double vThrust; // vertical thrust flag (-1/0/1)
+	double hThrust; // horizontal thrust flag (0/1)
+	char direction; // flag - gives the direction the taxi is currently facing, l for left, r for right
+    int velocity; // The total current velocity of the taxi
+
+	char bintact;   // flag - is the lander whole/intact (1) or has it crashed (0)
+	char inflight; // flag - is the lander flying (1) or has it landed/crashed (0)
+    char wheelLandersEnabled; // if the landers are enabled (1), thus horizontal movement is disabled, else (0)
+
+    double fuel;    // the amount of fuel left
+    double maxFuel; // the size of the taxi's fuel tank, in case upgraded
+    double money;   // how much total the player has earnt during the game
+    customer custo_current; // the current customer, if in the taxi
+    char custo_waiting; //checks if there is a customer riding the taxi
+
+    char landingOnceCustoCheck; // makes sure that customer is checked only once when landed
+
+    char justDied; // flag to check if the taxi just crashed, (1) just crashed, otherwise (0)
+    char lives;    // number of lives
+    int levelCurrent; // the number of the currently loaded level
+    char nextLevel; // flag to say to load next level (1), or not (0)
+
+    char bonusGiven; //flag to check if extra life has been awarded, (1) yes, (0) no
+}taxi;
+
+typedef struct
+{
+    //PCG32 random number generator (pcg-random.org): 64 bits of state, and a stream picked when it's seeded
+    //generators on different streams give unrelated numbers even from the same seed, so one can be split into many,
+    //and as each simulation owns its own they can run side by side on different threads
+    unsigned long long state;
+    unsigned long long inc; //the stream, always odd
+}pcg32;
+
+typedef struct
+{
+    //The level, including the custmer, timer, and the level terrain (landing pads and line segments)
+    int rainChance; // chance of the level having rain, percentage (from 0 to 100)
+    char isRaining; // after random chance is calculated on level load, if it is now raining (1) or not (0)
+
+    int numbounds;   // number of boundary lines
+    int numplatforms; // number of platforms
+    lpad *platforms; // array of the platforms
+    lseg *bounds; // array of the boundary lines
+    //the arrays are either in a level pack (capacities 0) or were allocated by createPlatform/addBoundary
+    //copies of a level share the arrays and grid, only the original should be freed
+    int platformsCapacity;
+    int boundsCapacity;
+    segGrid grid; // collision grid over the platforms and boundary lines
+    //the area the level covers, the window for levels in a level pack but bigger for caverns
+    //the camera stays inside it, and flying out of its top leaves the level
+    bbox extent;
+
+    pcg32 rng; //the game's random number generator, see gameRand()
+
+    double gameTime; //milliseconds of game time simulated so far, for game clock
+    int currentTimeSecs;   //current number of seconds of game time
+
+    char customerWaiting;  //flag to check if there is a customer waiting on a platform (1) or not (0)
+    int levelCustomerNumber; //the number of customers that the given level has in total, the final being the exit customer
+    int levelCustomerCurrentNumber; //the current customer number the player is on, out of the total above
+    customer currentCustomer;   //the current customer
+    //lots of customers waiting at once instead (dispatch.h), setting currentCustomer to the one offered, or NULL
+    //the dispatcher belongs to whoever made it, and copies of a level for trying things out should set this to NULL
+    struct dispatcher *dispatch;
+}level;
+
+typedef struct
+{
+    //the player's controls for one simulation step, filled in from the keyboard or by a computer pilot
+    double vThrust; //vertical thrust wanted, 0 or 1
+    double hThrust; //horizontal thrust wanted, -1, 0 or 1 (ignored while the landing wheels are down)
+    char toggleWheels; //(1) to raise/lower the landing wheels this step, otherwise (0)
+}taxiInput;
+
+//what updateGame() says happened in a step
+#define GAMEPLAYING   0
+#define GAMERESPAWNED 1 //crashed, and the taxi is back at the start with a life less
+#define GAMENEWLEVEL  2 //left the level, and the next one is loaded
+#define GAMEOVER      3 //crashed with no lives left
+#define GAMEWON       4 //left the last level
+
+//random numbers, kept in the level so a seeded game always plays the same
+void pcgSeed(pcg32 *r, unsigned long long seed, unsigned long long stream);
+unsigned int pcgNext(pcg32 *r);
+unsigned int pcgBelow(pcg32 *r, unsigned int n);
+pcg32 pcgSplit(pcg32 *r);
+void seedRandom(level *lvl, unsigned int seed);
+int gameRand(level *lvl);
+int gameRandBelow(level *lvl, int n);
+
+//level building
+void initialiseLevel(level *lvl);
+//levels are normally loaded from a level pack (levelpack.h), these build one in code
+void createPlatform(level *lvl, int xStart, int xEnd, int yStart, int yEnd, int num);
+void addPad(level *lvl, double x1, double y1, double x2, double y2);
+void addBoundary(level *lvl, double x1, double y1, double x2, double y2);
+void freeLevel(level *lvl);
+
+//taxi and customers
+void initialiseTaxi(taxi *t, double x, double y, char lives);
+void initialiseCustomer(level *lvl, customer *custo, int destpad, int currentpad);
+void customerMakeNext(level *lvl, int notPlatform, char death);
+void customerReDestination(customer c);
+
+//collision detection
+void initialiseBBox(bbox *b, int ax1, int ay1, int ax2, int ay2);
+bbox getBBox(taxi *t);
+int intersectBBxBB(bbox A, bbox B);
+int intersectLxL(lseg L1, lseg L2);
+int intersectBBxL(bbox B, lseg Line);
+double sweepBBxL(bbox B, double dx, double dy, lseg Line);
+
+//collision grid (grid.c)
+lseg levelSegment(const level *lvl, int id);
+void initialiseGrid(segGrid *g);
+void buildLevelGrid(level *lvl);
+void buildLevelGridArea(level *lvl, const bbox *area);
+void freeGrid(segGrid *g);
+int gridQuery(const segGrid *g, bbox b, int *found, int maxFound);
+
+//stepping the game
+void applyInput(taxi *t, const taxiInput *in);
+void advanceClock(level *lvl, double ms);
+void doEvents(taxi *t, double frames, level *lvl);
+void stepGame(taxi *t, level *lvl, const taxiInput *in, double ms);
+void respawnTaxi(taxi *t, level *lvl);
+struct levelPack;
+int loadNextLevel(taxi *t, level *lvl, const struct levelPack *pack);
+void startGame(taxi *t, level *lvl, const struct levelPack *pack, unsigned int seed);
+int updateGame(taxi *t, level *lvl, const struct levelPack *pack, const taxiInput *in, double ms);
+
+#endif
@@ -0,0 +1,513 @@
+//the level validator, see validate.h
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "validate.h"
+
+//room round the level's lines the lattice also covers, so the taxi can fly out of the top
+#define VALMARGIN 60.0
+//most threads it will use
+#define VALMAXWORKERS 64
+
+typedef struct
+{
+    //the controls held for one move, wheels down can't use the side thrusters
+    //(wheels up with no side thrust is left out, it does the same as wheels down but can't land)
+    signed char vThrust;
+    signed char hThrust;
+    signed char wheels;
+}valMove;
+
+static const valMove moves[] = {{0, 0, 1}, {1, 0, 1}, {0, -1, 0}, {0, 1, 0}, {1, -1, 0}, {1, 1, 0}};
+#define NUMMOVES (int)(sizeof(moves) / sizeof(moves[0]))
+
+typedef struct
+{
+    float cost;
+    int state;
+}valEntry;
+
+typedef struct
+{
+    //one search, reused by a worker for each job it takes
+    //each lattice state keeps the exact taxi state of the cheapest way found into it, and moves are played from that
+    const level *lvl;
+    taxi base;        //the taxi every move starts from, with its position and speed filled in
+    double stepMs;
+    double x0, y0;    //bottom left corner of the lattice
+    int cols, rows;
+    int numStates;
+    float *state;     //x, y, hSpeed, vSpeed for each lattice state
+    float *cost;      //fuel to get there, VALNOROUTE if not found yet
+    valEntry *heap;   //states waiting to be searched from, cheapest first (entries go stale when a state gets cheaper)
+    int heapSize, heapCapacity;
+    float *found;     //fuel to land on each pad, then to leave the level
+    long long explored;
+}valSearch;
+
+typedef struct
+{
+    //the searches to do, taken one at a time by the workers
+    const level *levels;
+    levelReport *reports;
+    int *jobLevel;   //which level, and which pad (or numPads for the start point), each search is from
+    int *jobFrom;
+    long long *jobExplored;
+    int numJobs;
+    atomic_int nextJob;
+    double stepMs;
+    int maxStates;
+}valJobs;
+
+static void latticeSize(const level *lvl, double *x0, double *y0, int *cols, int *rows)
+{
+    //the lattice covers every line in the level, and a margin round them
+    int n = lvl->numplatforms + lvl->numbounds, i;
+    double minX = 0, minY = 0, maxX = 800, maxY = 600;
+
+    for(i = 0; i < n; i++)
+    {
+        lseg l = levelSegment(lvl, i);
+        if(i == 0)
+        {
+            minX = maxX = l.x1;
+            minY = maxY = l.y1;
+        }
+        minX = fmin(minX, fmin(l.x1, l.x2));
+        maxX = fmax(maxX, fmax(l.x1, l.x2));
+        minY = fmin(minY, fmin(l.y1, l.y2));
+        maxY = fmax(maxY, fmax(l.y1, l.y2));
+    }
+    *x0 = minX - VALMARGIN;
+    *y0 = minY - VALMARGIN;
+    *cols = (int)ceil((maxX - minX + 2 * VALMARGIN) / VALCELL);
+    *rows = (int)ceil((maxY - minY + 2 * VALMARGIN) / VALCELL);
+}
+
+static int latticeIndex(const valSearch *s, double x, double y, double hSpeed, double vSpeed)
+{
+    //the lattice state a taxi state falls in, or -1 if it's off the lattice (or going too fast to bother with)
+    int c = (int)floor((x - s->x0) / VALCELL);
+    int r = (int)floor((y - s->y0) / VALCELL);
+    int h = (int)floor((hSpeed + VALMAXSPEED) / VALSPEEDSTEP);
+    int v = (int)floor((vSpeed + VALMAXSPEED) / VALSPEEDSTEP);
+
+    if(c < 0 || c >= s->cols || r < 0 || r >= s->rows || h < 0 || h >= VALSPEEDBINS || v < 0 || v >= VALSPEEDBINS)
+    {
+        return -1;
+    }
+    return ((r * s->cols + c) * VALSPEEDBINS + h) * VALSPEEDBINS + v;
+}
+
+static void heapPush(valSearch *s, float cost, int state)
+{
+    //min-heap on cost
+    if(s->heapSize == s->heapCapacity)
+    {
+        int capacity = s->heapCapacity > 0 ? s->heapCapacity * 2 : 4096;
+        valEntry *heap = realloc(s->heap, sizeof(valEntry) * capacity);
+        if(heap == NULL)
+        {
+            //out of memory, the state is dropped and the search is a little less thorough
+            return;
+        }
+        s->heap = heap;
+        s->heapCapacity = capacity;
+    }
+    int i = s->heapSize++;
+    while(i > 0 && s->heap[(i - 1) / 2].cost > cost)
+    {
+        s->heap[i] = s->heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    s->heap[i].cost = cost;
+    s->heap[i].state = state;
+}
+static valEntry heapPop(valSearch *s)
+{
+    valEntry top = s->heap[0];
+    valEntry last = s->heap[--s->heapSize];
+    int i = 0;
+    while(2 * i + 1 < s->heapSize)
+    {
+        int c = 2 * i + 1;
+        if(c + 1 < s->heapSize && s->heap[c + 1].cost < s->heap[c].cost)
+        {
+            c++;
+        }
+        if(last.cost <= s->heap[c].cost)
+        {
+            break;
+        }
+        s->heap[i] = s->heap[c];
+        i = c;
+    }
+    s->heap[i] = last;
+    return top;
+}
+
+static void landedOn(valSearch *s, const level *lvl, const taxi *t, float fuel)
+{
+    //a taxi that's just landed is sat on every pad its wheels touch, the game lets it pick up and drop off on any of them
+    //(landing puts it 10 above the pad, rounded to a whole pixel)
+    int i;
+    for(i = 0; i < lvl->numplatforms; i++)
+    {
+        lseg p = lvl->platforms[i].l;
+        if(fabs(t->y - (p.y1 + 10)) < 1.5 && t->x + t->bb.x2 >= fmin(p.x1, p.x2) && t->x + t->bb.x1 <= fmax(p.x1, p.x2))
+        {
+            s->found[i] = fmin(s->found[i], fuel);
+        }
+    }
+}
+
+static void searchMoves(valSearch *s, const float *from, float cost, char landed)
+{
+    //plays every move from a taxi state until the taxi reaches a different lattice state, lands, leaves or crashes
+    int here = landed == '1' ? -1 : latticeIndex(s, from[0], from[1], from[2], from[3]);
+    int m, k;
+
+    s->explored++;
+    for(m = 0; m < NUMMOVES; m++)
+    {
+        taxi t = s->base;
+        level lvl = *s->lvl;
+        taxiInput in = {moves[m].vThrust, moves[m].hThrust, 0};
+        float fuel = cost;
+        float fuelPerStep = (moves[m].vThrust + abs(moves[m].hThrust)) * s->stepMs / 1000.0;
+
+        t.x = from[0];
+        t.y = from[1];
+        t.hSpeed = from[2];
+        t.vSpeed = from[3];
+        if(landed == '1')
+        {
+            //sat on a pad with the wheels down, raising them takes off like it does in the game
+            t.inflight = '0';
+            t.wheelLandersEnabled = '1';
+            in.toggleWheels = moves[m].wheels == 0;
+        }
+        else
+        {
+            //in the air the wheels can be put up or down for free, so they're not part of the lattice state
+            t.wheelLandersEnabled = moves[m].wheels ? '1' : '0';
+        }
+
+        for(k = 0; k * s->stepMs < VALMAXMS; k++)
+        {
+            char flying = t.inflight;
+            stepGame(&t, &lvl, &in, s->stepMs);
+            in.toggleWheels = 0;
+            fuel += fuelPerStep;
+            if(t.bintact == '0')
+            {
+                break;
+            }
+            if(t.nextLevel == '1')
+            {
+                s->found[lvl.numplatforms] = fmin(s->found[lvl.numplatforms], fuel);
+                break;
+            }
+            if(t.inflight == '0')
+            {
+                //just landed (a taxi that stayed sat on its pad is waiting, which never saves fuel)
+                if(flying == '1')
+                {
+                    landedOn(s, &lvl, &t, fuel);
+                }
+                break;
+            }
+            int next = latticeIndex(s, t.x, t.y, t.hSpeed, t.vSpeed);
+            if(next < 0)
+            {
+                break;
+            }
+            if(next != here)
+            {
+                if(fuel < s->cost[next])
+                {
+                    s->cost[next] = fuel;
+                    s->state[next * 4] = t.x;
+                    s->state[next * 4 + 1] = t.y;
+                    s->state[next * 4 + 2] = t.hSpeed;
+                    s->state[next * 4 + 3] = t.vSpeed;
+                    heapPush(s, fuel, next);
+                }
+                break;
+            }
+        }
+    }
+}
+
+static void searchFrom(valSearch *s, const level *lvl, int from)
+{
+    //finds the least fuel from pad 'from' (or the start point, from == numplatforms) to every pad and the exit
+    int numTargets = lvl->numplatforms + 1;
+    int i;
+
+    s->lvl = lvl;
+    latticeSize(lvl, &s->x0, &s->y0, &s->cols, &s->rows);
+    s->numStates = s->cols * s->rows * VALSPEEDBINS * VALSPEEDBINS;
+    for(i = 0; i < s->numStates; i++)
+    {
+        s->cost[i] = VALNOROUTE;
+    }
+    for(i = 0; i < numTargets; i++)
+    {
+        s->found[i] = VALNOROUTE;
+    }
+    s->heapSize = 0;
+    s->explored = 0;
+
+    if(from < lvl->numplatforms)
+    {
+        //landed anywhere along the pad, a lattice square apart
+        lseg p = lvl->platforms[from].l;
+        double left = fmin(p.x1, p.x2), right = fmax(p.x1, p.x2);
+        int spots = (int)((right - left) / VALCELL) + 1;
+        for(i = 0; i < spots; i++)
+        {
+            float start[4] = {spots > 1 ? left + (right - left) * i / (spots - 1) : (left + right) / 2, p.y1 + 10, 0, 10};
+            searchMoves(s, start, 0, '1');
+        }
+    }
+    else
+    {
+        //where the taxi starts each level, and comes back after a crash
+        float start[4] = {s->base.x, s->base.y, 0, 0};
+        searchMoves(s, start, 0, '0');
+    }
+
+    while(s->heapSize > 0)
+    {
+        valEntry e = heapPop(s);
+        if(e.cost > s->cost[e.state])
+        {
+            //already searched from more cheaply
+            continue;
+        }
+        //once every pad and the exit have been found, and nothing left is cheaper than the dearest of them, it's done
+        float dearest = 0;
+        for(i = 0; i < numTargets; i++)
+        {
+            dearest = fmax(dearest, s->found[i]);
+        }
+        if(e.cost >= dearest)
+        {
+            break;
+        }
+        searchMoves(s, &s->state[e.state * 4], e.cost, '0');
+    }
+}
+
+static void *validateWorker(void *data)
+{
+    //takes searches until there are none left
+    valJobs *jobs = data;
+    valSearch s;
+    int j;
+
+    memset(&s, 0, sizeof(s));
+    s.stepMs = jobs->stepMs;
+    initialiseTaxi(&s.base, 400, 400, 3);
+    s.state = malloc(sizeof(float) * 4 * jobs->maxStates);
+    s.cost = malloc(sizeof(float) * jobs->maxStates);
+    s.found = NULL;
+    if(s.state == NULL || s.cost == NULL)
+    {
+        printf("not enough memory for the level validator\n");
+        free(s.state);
+        free(s.cost);
+        return NULL;
+    }
+
+    while((j = atomic_fetch_add(&jobs->nextJob, 1)) < jobs->numJobs)
+    {
+        const level *lvl = &jobs->levels[jobs->jobLevel[j]];
+        levelReport *r = &jobs->reports[jobs->jobLevel[j]];
+        //the search writes its results straight into its row of the report, no other search uses that row
+        s.found = &r->fuel[jobs->jobFrom[j] * (r->numPads + 1)];
+        searchFrom(&s, lvl, jobs->jobFrom[j]);
+        jobs->jobExplored[j] = s.explored;
+    }
+    free(s.state);
+    free(s.cost);
+    free(s.heap);
+    return NULL;
+}
+
+int journeyNeeded(int numPads, int from, int to)
+{
+    //if the game can ask for a journey, going by how customerMakeNext() picks customers:
+    //pick ups are from pads 1 and up (never pad 0) and drop offs to any pad, so a journey can be
+    //from the start point to a pick up pad, from any pad to any other (a drop off then the next pick up, or a pick up
+    //then its drop off), and from any pad out of the top once the last customer is dropped off
+    if(from == numPads)
+    {
+        return to >= 1 && to < numPads;
+    }
+    if(to == numPads)
+    {
+        return 1;
+    }
+    return from != to;
+}
+
+int validateLevels(const levelPack *pack, int workers, double stepMs, levelReport **reports)
+{
+    //searches every level of the pack, returns the number of levels (with a report for each) or 0 if it couldn't
+    valJobs jobs;
+    level *levels;
+    pthread_t threads[VALMAXWORKERS];
+    int numLevels = pack->numLevels;
+    int i, j, k, started = 0;
+
+    memset(&jobs, 0, sizeof(jobs));
+    levels = calloc(numLevels > 0 ? numLevels : 1, sizeof(level));
+    *reports = calloc(numLevels > 0 ? numLevels : 1, sizeof(levelReport));
+    if(levels == NULL || *reports == NULL)
+    {
+        free(levels);
+        free(*reports);
+        return 0;
+    }
+
+    //load every level, and make one search per pad (and the start point) of each
+    for(i = 0; i < numLevels; i++)
+    {
+        int cols, rows;
+        double x0, y0;
+        initialiseLevel(&levels[i]);
+        loadLevel(&levels[i], pack, i);
+        //no customers, so landing doesn't pick anyone up or print anything
+        levels[i].customerWaiting = '0';
+        levels[i].currentCustomer.fromPlatform = -1;
+        levels[i].currentCustomer.destPlatform = -1;
+
+        levelReport *r = &(*reports)[i];
+        r->numPads = levels[i].numplatforms;
+        r->fuel = malloc(sizeof(float) * (r->numPads + 1) * (r->numPads + 1));
+        if(r->fuel == NULL)
+        {
+            for(j = 0; j <= i; j++)
+            {
+                freeLevel(&levels[j]);
+            }
+            freeLevelReports(*reports, i + 1);
+            free(levels);
+            return 0;
+        }
+        jobs.numJobs += r->numPads + 1;
+
+        latticeSize(&levels[i], &x0, &y0, &cols, &rows);
+        if(cols * rows * VALSPEEDBINS * VALSPEEDBINS > jobs.maxStates)
+        {
+            jobs.maxStates = cols * rows * VALSPEEDBINS * VALSPEEDBINS;
+        }
+    }
+    jobs.levels = levels;
+    jobs.reports = *reports;
+    jobs.stepMs = stepMs;
+    jobs.jobLevel = malloc(sizeof(int) * (jobs.numJobs + 1));
+    jobs.jobFrom = malloc(sizeof(int) * (jobs.numJobs + 1));
+    jobs.jobExplored = calloc(jobs.numJobs + 1, sizeof(long long));
+    if(jobs.jobLevel == NULL || jobs.jobFrom == NULL || jobs.jobExplored == NULL)
+    {
+        free(jobs.jobLevel);
+        free(jobs.jobFrom);
+        free(jobs.jobExplored);
+        for(i = 0; i < numLevels; i++)
+        {
+            freeLevel(&levels[i]);
+        }
+        freeLevelReports(*reports, numLevels);
+        free(levels);
+        return 0;
+    }
+    for(i = 0, k = 0; i < numLevels; i++)
+    {
+        for(j = 0; j <= levels[i].numplatforms; j++, k++)
+        {
+            jobs.jobLevel[k] = i;
+            jobs.jobFrom[k] = j;
+        }
+    }
+    atomic_init(&jobs.nextJob, 0);
+
+    //the workers share the searches out, this thread does some too
+    if(workers > VALMAXWORKERS)
+    {
+        workers = VALMAXWORKERS;
+    }
+    for(i = 0; i < workers - 1; i++)
+    {
+        if(pthread_create(&threads[started], NULL, validateWorker, &jobs) == 0)
+        {
+            started++;
+        }
+    }
+    validateWorker(&jobs);
+    for(i = 0; i < started; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    //a worker short of memory leaves its searches to the others, if they all were some weren't done
+    if(atomic_load(&jobs.nextJob) < jobs.numJobs)
+    {
+        free(jobs.jobLevel);
+        free(jobs.jobFrom);
+        free(jobs.jobExplored);
+        for(i = 0; i < numLevels; i++)
+        {
+            freeLevel(&levels[i]);
+        }
+        freeLevelReports(*reports, numLevels);
+        free(levels);
+        return 0;
+    }
+
+    for(i = 0, k = 0; i < numLevels; i++)
+    {
+        levelReport *r = &(*reports)[i];
+        int n = r->numPads + 1, a, b, c;
+        for(j = 0; j < n; j++, k++)
+        {
+            r->explored += jobs.jobExplored[k];
+        }
+        //journeys that land on other pads on the way (Floyd-Warshall through the pads)
+        for(c = 0; c < r->numPads; c++)
+        {
+            for(a = 0; a < n; a++)
+            {
+                for(b = 0; b < n; b++)
+                {
+                    float via = r->fuel[a * n + c] + r->fuel[c * n + b];
+                    if(via < r->fuel[a * n + b])
+                    {
+                        r->fuel[a * n + b] = via;
+                    }
+                }
+            }
+        }
+        freeLevel(&levels[i]);
+    }
+
+    free(jobs.jobLevel);
+    free(jobs.jobFrom);
+    free(jobs.jobExplored);
+    free(levels);
+    return numLevels;
+}
+
+void freeLevelReports(levelReport *reports, int numLevels)
+{
+    int i;
+    for(i = 0; i < numLevels; i++)
+    {
+        free(reports[i].fuel);
+    }
+    free(reports);
+}
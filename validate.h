@@ -0,0 +1,37 @@
+#ifndef VALIDATE_H
+#define VALIDATE_H
+//level validator: works out which pads the taxi can actually fly between on each level of a pack,
+//so levels with pads that can't be reached, or that can't be left again, are caught without flying them by hand
+//it searches the taxi's states (position and speed, on a lattice) out from every pad with Dijkstra's algorithm,
+//cheapest fuel first, playing each move with the real stepGame() so collisions and landing work like the game
+//each level's searches (one per pad, and one from where the taxi starts) are shared out over worker threads
+#include "spacetaxi.h"
+#include "levelpack.h"
+
+//lattice the taxi's states are grouped on: a state is kept for each VALCELL x VALCELL square
+//and each VALSPEEDSTEP of horizontal and vertical speed, from -VALMAXSPEED to VALMAXSPEED
+#define VALCELL       20.0
+#define VALSPEEDSTEP  40.0
+#define VALMAXSPEED   360.0
+#define VALSPEEDBINS  18
+//longest a move is played for before it's given up, if it hasn't left its lattice state
+#define VALMAXMS      1000.0
+//fuel for a journey that can't be flown
+#define VALNOROUTE    1e30f
+
+typedef struct
+{
+    //what the validator found for one level
+    int numPads;
+    //the least fuel (seconds of thrust) to fly each journey, landing on other pads on the way if that helps
+    //(numPads + 1) x (numPads + 1): fuel[from * (numPads + 1) + to], where from is a pad or numPads for the point
+    //the taxi starts at, and to is a pad or numPads for leaving through the top of the level
+    float *fuel;
+    long long explored; //lattice states searched from, over all the searches
+}levelReport;
+
+int validateLevels(const levelPack *pack, int workers, double stepMs, levelReport **reports);
+void freeLevelReports(levelReport *reports, int numLevels);
+int journeyNeeded(int numPads, int from, int to);
+
+#endif